@@ -53,12 +53,17 @@ public:
 		inFilename_ = val.get("inFilename_", "").asString();
 		inExtention_ = val.get("inExtention_", "").asString();
 		inFormat_ = val.get("inFormat_", "").asString();
+		gzBufferSize_ = val.get("gzBufferSize_", njh::GZSTREAM::gzstreambuf::defaultBufferSize).asUInt();
+		gzReadAheadBuffers_ = val.get("gzReadAheadBuffers_", 0).asUInt();
 	}
 
 	bfs::path inFilename_;
 	std::string inExtention_;
 	std::string inFormat_;
 
+	uint32_t gzBufferSize_{njh::GZSTREAM::gzstreambuf::defaultBufferSize}; /**< size of the buffer used when reading gz files*/
+	uint32_t gzReadAheadBuffers_{0}; /**< number of buffers a background thread will decompress gz files ahead into, 0 to decompress inline with reading*/
+
 	bool inExists() const{
 		return bfs::exists(inFilename_);
 	}
@@ -71,6 +76,8 @@ public:
 		ret["inFilename_"] = njh::json::toJson(inFilename_);
 		ret["inExtention_"] = njh::json::toJson(inExtention_);
 		ret["inFormat_"] = njh::json::toJson(inFormat_);
+		ret["gzBufferSize_"] = njh::json::toJson(gzBufferSize_);
+		ret["gzReadAheadBuffers_"] = njh::json::toJson(gzReadAheadBuffers_);
 		return ret;
 	}
 
@@ -86,6 +93,8 @@ public:
 			ss << __PRETTY_FUNCTION__ << ", error attempted to open " << inFilename_ << " when it's a directory " << "\n";
 			throw std::runtime_error{ss.str()};
 		}
+		inFile.rdbuf()->setBufferSize(gzBufferSize_);
+		inFile.rdbuf()->setReadAhead(gzReadAheadBuffers_);
 		inFile.open(inFilename_);
 		if(!inFile){
 			std::stringstream ss;
@@ -27,6 +27,8 @@
 
 #include "njhcpp/utils.h"
 #include "njhcpp/files/fileObjects/gzstream.hpp" //njh::GZSTREAM
+#include "njhcpp/files/fileObjects/pgzstream.hpp" //njh::GZSTREAM::opgzstream
+#include "njhcpp/files/fileUtilities.hpp" //njh::files::reserveAppendSpace
 
 //#include "njhcpp/files.h"
 
@@ -73,6 +75,9 @@ public:
 		overWriteFile_ = val.get("overWriteFile_", false).asBool();
 		exitOnFailureToWrite_ = val.get("exitOnFailureToWrite_", false).asBool();
 		append_ = val.get("append_", false).asBool();
+		gzBufferSize_ = val.get("gzBufferSize_", njh::GZSTREAM::gzstreambuf::defaultBufferSize).asUInt();
+		numGzThreads_ = val.get("numGzThreads_", 1).asUInt();
+		expectedSize_ = val.get("expectedSize_", 0).asUInt64();
 	}
 
 	bfs::path outFilename_;
@@ -83,6 +88,9 @@ public:
 	bool overWriteFile_ = false;
 	bool exitOnFailureToWrite_ = true;
 	bool binary_ = false;
+	uint32_t gzBufferSize_{njh::GZSTREAM::gzstreambuf::defaultBufferSize}; /**< size of the buffer used when writing gz files*/
+	uint32_t numGzThreads_{1}; /**< number of threads to compress gz output with, more than 1 will use njh::GZSTREAM::opgzstream*/
+	uint64_t expectedSize_{0}; /**< if known, how many bytes will be written to an uncompressed file, disk space for them is reserved on opening where the filesystem supports it, 0 for unknown*/
 	bfs::perms permissions_{bfs::owner_read | bfs::owner_write | bfs::group_read | bfs::group_write | bfs::others_read};
 
 
@@ -102,6 +110,7 @@ public:
 	}
 
 	void openGzFile(njh::GZSTREAM::ogzstream & outFileGz) const{
+		outFileGz.rdbuf()->setBufferSize(gzBufferSize_);
 		if (bfs::exists(outName()) && !overWriteFile_) {
 			if (append_) {
 				outFileGz.open(outName(), std::ios::ate);
@@ -124,6 +133,7 @@ public:
 	}
 
 	void openBinaryGzFile(njh::GZSTREAM::ogzstream & outFileGz) const{
+		outFileGz.rdbuf()->setBufferSize(gzBufferSize_);
 		if (bfs::exists(outName()) && !overWriteFile_) {
 			std::stringstream ss;
 			ss << __PRETTY_FUNCTION__ << " error, "<< outName() << " already exists";
@@ -140,10 +150,34 @@ public:
 		}
 	}
 
+	void openGzFile(njh::GZSTREAM::opgzstream & outFileGz) const{
+		outFileGz.rdbuf()->setNumThreads(numGzThreads_);
+		if (bfs::exists(outName()) && !overWriteFile_) {
+			if (append_) {
+				outFileGz.open(outName(), std::ios::ate);
+			} else {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << " error, " << outName()
+						<< " already exists";
+				throw std::runtime_error { ss.str() };
+			}
+		} else {
+			outFileGz.open(outName());
+			if (!outFileGz) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << " error in opening " << outName();
+				throw std::runtime_error { ss.str() };
+			} else {
+				bfs::permissions(outName(), permissions_);
+			}
+		}
+	}
+
 	void openFile(std::ofstream & outFile) const {
 		if (bfs::exists(outName()) && !overWriteFile_) {
 			if (append_) {
 				outFile.open(outName().string(), std::ios::app);
+				reserveExpectedSize();
 			} else {
 				std::stringstream ss;
 				ss << __PRETTY_FUNCTION__ << " error, "<< outName() << " already exists";
@@ -157,6 +191,7 @@ public:
 				throw std::runtime_error { ss.str() };
 			} else {
 				bfs::permissions(outName(), permissions_);
+				reserveExpectedSize();
 			}
 		}
 	}
@@ -165,6 +200,7 @@ public:
 		if (bfs::exists(outName()) && !overWriteFile_) {
 			if (append_) {
 				outFile.open(outName().string(), std::ios::binary | std::ios::app);
+				reserveExpectedSize();
 			} else {
 				std::stringstream ss;
 				ss << __PRETTY_FUNCTION__ << " error, "<< outName() << " already exists";
@@ -178,6 +214,7 @@ public:
 				throw std::runtime_error { ss.str() };
 			} else {
 				bfs::permissions(outName(), permissions_);
+				reserveExpectedSize();
 			}
 		}
 	}
@@ -186,6 +223,15 @@ public:
 
 
 
+	/**@brief Reserve disk space for expectedSize_ more bytes past the end of the opened file, does nothing if expectedSize_ is 0
+	 *
+	 */
+	void reserveExpectedSize() const {
+		if (0 != expectedSize_) {
+			njh::files::reserveAppendSpace(outName(), expectedSize_);
+		}
+	}
+
 	void openExecutableFile(std::ofstream & out) const {
 		openFile(out);
 		bfs::permissions(outName(), permissions_ | bfs::owner_exe | bfs::group_exe | bfs::others_exe);
@@ -202,6 +248,9 @@ public:
 		ret["append_"] = njh::json::toJson(append_);
 		ret["overWriteFile_"] = njh::json::toJson(overWriteFile_);
 		ret["exitOnFailureToWrite_"] = njh::json::toJson(exitOnFailureToWrite_);
+		ret["gzBufferSize_"] = njh::json::toJson(gzBufferSize_);
+		ret["numGzThreads_"] = njh::json::toJson(numGzThreads_);
+		ret["expectedSize_"] = njh::json::toJson(expectedSize_);
 		ret["permissions_"] = njh::json::toJson(njh::octToDec(permissions_));
 		return ret;
 	}
@@ -269,6 +318,22 @@ public:
 		}
 	}
 
+	/**@brief Will return stream buffer for either the supplied njh::GZSTREAM::ogzstream or, if numGzThreads_ is more than 1, njh::GZSTREAM::opgzstream object if outFilename_ is not blank or std::cout
+	 *
+	 * @param outFileGz the single threaded gz outFile that might be opened
+	 * @param outFileGzPar the multi-threaded gz outFile that might be opened
+	 * @return the buffer of either one of the outfiles or std::cout
+	 */
+	std::streambuf* determineOutBuf(
+			njh::GZSTREAM::ogzstream & outFileGz,
+			njh::GZSTREAM::opgzstream & outFileGzPar) const {
+		if ("" != outFilename_&& "STDOUT" != outFilename_ && numGzThreads_ > 1) {
+			openGzFile(outFileGzPar);
+			return outFileGzPar.rdbuf();
+		}
+		return determineOutBuf(outFileGz);
+	}
+
 	/**@brief Will return the stream buffer for either the supplied std::ofstream or njh::GZSTREAM::ogzstream if outFilename_ is not blank  and based on the file extension or std::cout
 	 *
 	 * @param outFile the regular out file that might be opened
@@ -300,6 +365,26 @@ public:
 		}
 	}
 
+	/**@brief Will return the stream buffer for either the supplied std::ofstream, njh::GZSTREAM::ogzstream or njh::GZSTREAM::opgzstream if outFilename_ is not blank and based on the file extension or std::cout
+	 *
+	 * The multi-threaded njh::GZSTREAM::opgzstream is used for gz output when numGzThreads_ is more than 1
+	 *
+	 * @param outFile the regular out file that might be opened
+	 * @param outFileGz the gz out file that might be opened
+	 * @param outFileGzPar the multi-threaded gz out file that might be opened
+	 * @return the buffer or std::cout, outFile, outFileGz or outFileGzPar
+	 */
+	std::streambuf* determineOutBuf(std::ofstream & outFile,
+			njh::GZSTREAM::ogzstream & outFileGz,
+			njh::GZSTREAM::opgzstream & outFileGzPar) const {
+		if ("" != outFilename_ && "STDOUT" != outFilename_ && numGzThreads_ > 1
+				&& (("" != outExtention_ && njh::endsWith(outExtention_, ".gz")) || ("" == outExtention_ && njh::endsWith(outFilename_.string(), ".gz")))) {
+			openGzFile(outFileGzPar);
+			return outFileGzPar.rdbuf();
+		}
+		return determineOutBuf(outFile, outFileGz);
+	}
+
 };
 
 
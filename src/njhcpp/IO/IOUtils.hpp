@@ -46,8 +46,15 @@ inline void gzZipFile(const IoOptions & opts){
 	//read in chunks so that the entire file doesn't have to be read in if it's very large
 	/**@todo find an apprioprate chunkSize or */
 	uint32_t chunkSize = 4096 * 10;
-	njh::GZSTREAM::ogzstream outstream;
-	opts.out_.openGzFile(outstream);
+	njh::GZSTREAM::ogzstream outFileGz;
+	njh::GZSTREAM::opgzstream outFileGzPar;
+	if (opts.out_.numGzThreads_ > 1) {
+		opts.out_.openGzFile(outFileGzPar);
+	} else {
+		opts.out_.openGzFile(outFileGz);
+	}
+	std::ostream & outstream = opts.out_.numGzThreads_ > 1 ?
+			static_cast<std::ostream &>(outFileGzPar) : static_cast<std::ostream &>(outFileGz);
 	std::ifstream infile(opts.in_.inFilename_.string(), std::ios::binary);
 	std::vector<char> buffer(chunkSize);
 	infile.read(buffer.data(), sizeof(char) * chunkSize);
@@ -35,12 +35,14 @@ public:
 	OutputStream(const OutOptions & outOpts) : std::ostream(std::cout.rdbuf()),
 			outOpts_(outOpts),
 			outFileGz_(std::make_unique<njh::GZSTREAM::ogzstream>()),
+			outFileGzPar_(std::make_unique<njh::GZSTREAM::opgzstream>()),
 			outFile_(std::make_unique<std::ofstream>()) {
 
-		rdbuf(outOpts_.determineOutBuf(*outFile_, *outFileGz_));
+		rdbuf(outOpts_.determineOutBuf(*outFile_, *outFileGz_, *outFileGzPar_));
 	}
 	const OutOptions outOpts_;
 	std::unique_ptr<njh::GZSTREAM::ogzstream> outFileGz_;
+	std::unique_ptr<njh::GZSTREAM::opgzstream> outFileGzPar_;
 	std::unique_ptr<std::ofstream> outFile_;
 
 	std::mutex mut_;
@@ -50,6 +52,7 @@ public:
 		flush();
 		outFile_ = nullptr;
 		outFileGz_ = nullptr;
+		outFileGzPar_ = nullptr;
 	}
 };
 
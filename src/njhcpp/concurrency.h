@@ -12,6 +12,11 @@
 
 
 #include "njhcpp/concurrency/LockableQueue.hpp"
+#include "njhcpp/concurrency/BoundedQueue.hpp"
+#include "njhcpp/concurrency/RingBufferQueue.hpp"
 #include "njhcpp/concurrency/LockableVec.hpp"
+#include "njhcpp/concurrency/ThreadPool.hpp"
 #include "njhcpp/concurrency/concurrencyUtils.hpp"
+#include "njhcpp/concurrency/parallelAlgorithms.hpp"
+#include "njhcpp/concurrency/LineBatchPipeline.hpp"
 
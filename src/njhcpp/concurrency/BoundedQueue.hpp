@@ -0,0 +1,263 @@
+#pragma once
+/*
+ * BoundedQueue.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+
+namespace njh {
+namespace concurrent {
+
+/**@brief A blocking queue with a maximum size, for handing values from producer threads to consumer threads while the values are still being produced
+ *
+ * push() blocks while the queue is full and pop() blocks while it is empty, once close() is called pushes fail and pops drain what's left.
+ * Values are only ever moved in and out so move-only types like std::unique_ptr can be queued
+ */
+template<typename T>
+class BoundedQueue {
+	std::mutex mut_; /**< guards the members below*/
+	std::condition_variable notEmpty_; /**< consumers wait on this*/
+	std::condition_variable notFull_; /**< producers wait on this*/
+	std::deque<T> vals_; /**< the values waiting to be popped*/
+	size_t capacity_; /**< the maximum number of values held at one time*/
+	bool closed_ = false; /**< whether close() has been called*/
+public:
+	/**@brief construct with the maximum size
+	 *
+	 * @param capacity the maximum number of values to hold at one time, a minimum of 1
+	 */
+	explicit BoundedQueue(size_t capacity) :
+			capacity_(std::max<size_t>(1, capacity)) {
+	}
+
+	BoundedQueue(const BoundedQueue & other) = delete;
+	BoundedQueue & operator=(const BoundedQueue & other) = delete;
+
+	/**@brief Add a value, blocking while the queue is full
+	 *
+	 * @param val the value to add, moved into the queue
+	 * @return false if the queue was closed, val is left untouched
+	 */
+	bool push(T && val) {
+		{
+			std::unique_lock<std::mutex> lock(mut_);
+			notFull_.wait(lock, [this]() {return vals_.size() < capacity_ || closed_;});
+			if (closed_) {
+				return false;
+			}
+			vals_.emplace_back(std::move(val));
+		}
+		notEmpty_.notify_one();
+		return true;
+	}
+
+	/**@brief Add a copy of a value, blocking while the queue is full
+	 *
+	 * @param val the value to add
+	 * @return false if the queue was closed
+	 */
+	bool push(const T & val) {
+		T copy(val);
+		return push(std::move(copy));
+	}
+
+	/**@brief Get the next value, blocking while the queue is empty and not closed
+	 *
+	 * @param val set to the next value
+	 * @return false if the queue was closed and there were no more values
+	 */
+	bool pop(T & val) {
+		{
+			std::unique_lock<std::mutex> lock(mut_);
+			notEmpty_.wait(lock, [this]() {return !vals_.empty() || closed_;});
+			if (vals_.empty()) {
+				return false;
+			}
+			val = std::move(vals_.front());
+			vals_.pop_front();
+		}
+		notFull_.notify_one();
+		return true;
+	}
+
+	/**@brief Add a value if there is room without waiting
+	 *
+	 * @param val the value to add, only moved from if it was added
+	 * @return whether the value was added
+	 */
+	bool tryPush(T && val) {
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			if (closed_ || vals_.size() >= capacity_) {
+				return false;
+			}
+			vals_.emplace_back(std::move(val));
+		}
+		notEmpty_.notify_one();
+		return true;
+	}
+
+	/**@brief Add a value, waiting at most timeout for room
+	 *
+	 * @param val the value to add, only moved from if it was added
+	 * @param timeout the maximum time to wait
+	 * @return whether the value was added, false on timeout or if the queue was closed
+	 */
+	template<typename REP, typename PERIOD>
+	bool pushFor(T && val, const std::chrono::duration<REP, PERIOD> & timeout) {
+		{
+			std::unique_lock<std::mutex> lock(mut_);
+			if (!notFull_.wait_for(lock, timeout, [this]() {return vals_.size() < capacity_ || closed_;}) || closed_) {
+				return false;
+			}
+			vals_.emplace_back(std::move(val));
+		}
+		notEmpty_.notify_one();
+		return true;
+	}
+
+	/**@brief Add several values, blocking while the queue is full, values are added as room frees up so vals can be larger than the capacity
+	 *
+	 * @param vals the values to add, moved from
+	 * @return the number of values added, less than vals.size() only if the queue was closed
+	 */
+	size_t pushBatch(std::vector<T> & vals) {
+		size_t added = 0;
+		while (added < vals.size()) {
+			{
+				std::unique_lock<std::mutex> lock(mut_);
+				notFull_.wait(lock, [this]() {return vals_.size() < capacity_ || closed_;});
+				if (closed_) {
+					break;
+				}
+				while (added < vals.size() && vals_.size() < capacity_) {
+					vals_.emplace_back(std::move(vals[added]));
+					++added;
+				}
+			}
+			notEmpty_.notify_all();
+		}
+		return added;
+	}
+
+	/**@brief Get the next value if there is one without waiting
+	 *
+	 * @param val set to the next value
+	 * @return whether a value was gotten
+	 */
+	bool tryPop(T & val) {
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			if (vals_.empty()) {
+				return false;
+			}
+			val = std::move(vals_.front());
+			vals_.pop_front();
+		}
+		notFull_.notify_one();
+		return true;
+	}
+
+	/**@brief Get the next value, waiting at most timeout for one
+	 *
+	 * @param val set to the next value
+	 * @param timeout the maximum time to wait
+	 * @return whether a value was gotten, false on timeout or if the queue was closed and empty
+	 */
+	template<typename REP, typename PERIOD>
+	bool popFor(T & val, const std::chrono::duration<REP, PERIOD> & timeout) {
+		{
+			std::unique_lock<std::mutex> lock(mut_);
+			if (!notEmpty_.wait_for(lock, timeout, [this]() {return !vals_.empty() || closed_;}) || vals_.empty()) {
+				return false;
+			}
+			val = std::move(vals_.front());
+			vals_.pop_front();
+		}
+		notFull_.notify_one();
+		return true;
+	}
+
+	/**@brief Get up to maxNum values at once, blocking until at least one is available, less locking than popping one at a time
+	 *
+	 * @param vals cleared and then filled with the values
+	 * @param maxNum the maximum number of values to get
+	 * @return false if the queue was closed and there were no more values
+	 */
+	bool popBatch(std::vector<T> & vals, size_t maxNum) {
+		vals.clear();
+		{
+			std::unique_lock<std::mutex> lock(mut_);
+			notEmpty_.wait(lock, [this]() {return !vals_.empty() || closed_;});
+			while (!vals_.empty() && vals.size() < std::max<size_t>(1, maxNum)) {
+				vals.emplace_back(std::move(vals_.front()));
+				vals_.pop_front();
+			}
+		}
+		notFull_.notify_all();
+		return !vals.empty();
+	}
+
+	/**@brief Take everything currently in the queue without waiting, e.g. to clean up after close()
+	 *
+	 * @param vals the values are appended to this
+	 * @return the number of values taken
+	 */
+	size_t drain(std::vector<T> & vals) {
+		size_t taken = 0;
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			taken = vals_.size();
+			for (auto & val : vals_) {
+				vals.emplace_back(std::move(val));
+			}
+			vals_.clear();
+		}
+		notFull_.notify_all();
+		return taken;
+	}
+
+	/**@brief Stop accepting values and wake up all waiting threads, values already in the queue can still be popped
+	 *
+	 */
+	void close() {
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			closed_ = true;
+		}
+		notEmpty_.notify_all();
+		notFull_.notify_all();
+	}
+
+	bool closed() {
+		std::lock_guard<std::mutex> lock(mut_);
+		return closed_;
+	}
+
+	bool empty() {
+		std::lock_guard<std::mutex> lock(mut_);
+		return vals_.empty();
+	}
+
+	size_t size() {
+		std::lock_guard<std::mutex> lock(mut_);
+		return vals_.size();
+	}
+
+	size_t capacity() const {
+		return capacity_;
+	}
+};
+
+}  // namespace concurrent
+}  // namespace njh
@@ -0,0 +1,289 @@
+#pragma once
+/*
+ * LineBatchPipeline.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Process the lines of a large text file on several threads. The file is cut
+// into batches of whole lines which are handed to worker threads over a
+// BoundedQueue while the file is still being read. Plain files are memory
+// mapped and split into byte ranges at line boundaries, anything else (gz
+// files, STDIN) is read by a single reader thread. Output written by the
+// workers can optionally be kept in the same order as the input.
+
+#include <string_view>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include "njhcpp/concurrency/BoundedQueue.hpp"
+#include "njhcpp/concurrency/concurrencyUtils.hpp" //joinAllJoinableThreads()
+#include "njhcpp/files/fileStreamUtils.hpp" //canBeMapped()
+#include "njhcpp/files/fileObjects/MappedFile.hpp"
+#include "njhcpp/files/newlineScanning.hpp"
+#include "njhcpp/IO.h"
+
+namespace njh {
+namespace concurrent {
+
+/**@brief A batch of consecutive whole lines from a file
+ *
+ */
+struct LineBatch {
+	uint64_t index_ = 0; /**< the position of this batch in the file, batches are numbered from 0*/
+	std::string_view data_; /**< the raw data the lines come from, including line endings*/
+	std::vector<std::string_view> lines_; /**< the lines without their line endings, point into data_*/
+	std::vector<char> owned_; /**< the memory data_ points into if it isn't part of a memory mapped file*/
+};
+
+/**@brief Split a file into batches of lines and process them on several threads
+ *
+ */
+class LineBatchPipeline {
+public:
+	static const size_t defaultBatchBytes = 4 * 1024 * 1024;
+
+	/**@brief Construct with the file to read
+	 *
+	 * @param inOpts the input file, gz files and STDIN are read by a reader thread, plain files are memory mapped
+	 * @param numThreads the number of worker threads
+	 * @param batchBytes the approximate number of bytes per batch, a batch always holds at least one whole line
+	 */
+	LineBatchPipeline(const InOptions & inOpts, uint32_t numThreads,
+			size_t batchBytes = defaultBatchBytes) :
+			inOpts_(inOpts), numThreads_(std::max<uint32_t>(1, numThreads)), batchBytes_(
+					std::max<size_t>(1, batchBytes)) {
+	}
+
+	/**@brief Run func on every batch, batches are processed in no particular order
+	 *
+	 * @param func the function to run on each batch, is called from several threads at once
+	 */
+	void run(const std::function<void(const LineBatch &)> & func) {
+		runBatches([&func](LineBatch & batch) {
+			func(batch);
+		});
+	}
+
+	/**@brief Run func on every batch and write what it produces to out
+	 *
+	 * Each batch gets its own std::ostream to write to, which is then written to out whole, so output from different batches is never interleaved
+	 *
+	 * @param func the function to run on each batch, is called from several threads at once
+	 * @param out where to write the output
+	 * @param keepOrder whether the output of the batches should be written in the order of the input
+	 */
+	void run(const std::function<void(const LineBatch &, std::ostream &)> & func,
+			OutputStream & out, bool keepOrder) {
+		std::map<uint64_t, std::string> pending; /**< reorder buffer for output waiting on earlier batches*/
+		uint64_t nextToWrite = 0;
+		//limit how far ahead of the oldest unwritten batch the workers can get so the reorder buffer stays bounded
+		const uint64_t maxAhead = numThreads_ * 4;
+		runBatches([&](LineBatch & batch) {
+			std::ostringstream batchOut;
+			func(batch, batchOut);
+			if (!keepOrder) {
+				std::lock_guard<std::mutex> lock(out.mut_);
+				out << batchOut.str();
+				return;
+			}
+			std::unique_lock<std::mutex> lock(pendingMut_);
+			pendingCv_.wait(lock, [&]() {return batch.index_ < nextToWrite + maxAhead || aborted_;});
+			if (aborted_) {
+				//an earlier batch failed so its output will never come, nothing more gets written
+				return;
+			}
+			pending.emplace(batch.index_, batchOut.str());
+			//whoever adds the next batch to be written writes it and any that were waiting on it
+			while (!pending.empty() && pending.begin()->first == nextToWrite) {
+				std::string toWrite = std::move(pending.begin()->second);
+				pending.erase(pending.begin());
+				lock.unlock();
+				{
+					std::lock_guard<std::mutex> outLock(out.mut_);
+					out << toWrite;
+				}
+				lock.lock();
+				++nextToWrite;
+			}
+			lock.unlock();
+			pendingCv_.notify_all();
+		});
+	}
+
+private:
+	InOptions inOpts_;
+	uint32_t numThreads_;
+	size_t batchBytes_;
+	std::atomic<bool> aborted_ { false }; /**< set when a worker or the reader throws so everything winds down*/
+	std::mutex pendingMut_; /**< guards the reorder buffer of an ordered run*/
+	std::condition_variable pendingCv_; /**< workers of an ordered run wait on this for earlier batches to be written, or for an abort*/
+
+	/**@brief Split the data of a batch into lines
+	 *
+	 */
+	static void splitLines(LineBatch & batch) {
+		batch.lines_.clear();
+		const char * pos = batch.data_.data();
+		const char * end = pos + batch.data_.size();
+		std::string_view line;
+		while (njh::files::nextLineView(pos, end, line)) {
+			batch.lines_.emplace_back(line);
+		}
+	}
+
+	/**@brief Find where the batch starting at start should end, just past the first line ending at or after target
+	 *
+	 */
+	static const char * batchEnd(const char * start, const char * target, const char * end) {
+		const char * lineEnd = njh::files::findLineEnding(std::max(start, std::min(target, end)), end);
+		if (lineEnd < end) {
+			if ('\r' == *lineEnd && lineEnd + 1 < end && '\n' == lineEnd[1]) {
+				++lineEnd;
+			}
+			++lineEnd;
+		}
+		return lineEnd;
+	}
+
+	/**@brief Cut a memory mapped file into batches and push them onto the queue
+	 *
+	 */
+	void produceMapped(const njh::files::MappedFile & mapped, BoundedQueue<LineBatch> & queue) {
+		const char * pos = mapped.data();
+		const char * end = pos + mapped.size();
+		uint64_t index = 0;
+		while (pos < end && !aborted_) {
+			const char * stop = batchEnd(pos, pos + (std::min<size_t>(batchBytes_, end - pos) - 1), end);
+			LineBatch batch;
+			batch.index_ = index++;
+			batch.data_ = std::string_view(pos, stop - pos);
+			if (!queue.push(std::move(batch))) {
+				break;
+			}
+			pos = stop;
+		}
+	}
+
+	/**@brief Read a stream in chunks, cut each chunk after its last complete line and push them onto the queue, the partial line at the end is carried into the next batch
+	 *
+	 */
+	void produceStreamed(std::istream & in, BoundedQueue<LineBatch> & queue) {
+		std::vector<char> carry;
+		bool skipLeadingNewline = false; /**< the last batch ended on a \r, so a \n starting the next chunk belongs to it*/
+		uint64_t index = 0;
+		bool endOfInput = false;
+		while (!endOfInput && !aborted_) {
+			std::vector<char> buffer;
+			buffer.reserve(carry.size() + batchBytes_);
+			buffer.insert(buffer.end(), carry.begin(), carry.end());
+			carry.clear();
+			size_t start = buffer.size();
+			buffer.resize(start + batchBytes_);
+			in.read(buffer.data() + start, batchBytes_);
+			size_t got = in.gcount();
+			buffer.resize(start + got);
+			endOfInput = got < batchBytes_;
+			if (skipLeadingNewline && got > 0 && '\n' == buffer[start]) {
+				buffer.erase(buffer.begin() + start);
+			}
+			if (got > 0) {
+				skipLeadingNewline = false;
+			}
+			size_t cut = buffer.size();
+			if (!endOfInput) {
+				//cut just past the last line ending, if there isn't one the line is longer than a batch so keep reading
+				size_t lastEnding = buffer.size();
+				while (lastEnding > 0 && '\n' != buffer[lastEnding - 1] && '\r' != buffer[lastEnding - 1]) {
+					--lastEnding;
+				}
+				if (0 == lastEnding) {
+					carry = std::move(buffer);
+					continue;
+				}
+				cut = lastEnding;
+				skipLeadingNewline = cut == buffer.size() && '\r' == buffer[cut - 1];
+				carry.assign(buffer.begin() + cut, buffer.end());
+				buffer.resize(cut);
+			}
+			if (buffer.empty()) {
+				continue;
+			}
+			LineBatch batch;
+			batch.index_ = index++;
+			batch.owned_ = std::move(buffer);
+			batch.data_ = std::string_view(batch.owned_.data(), batch.owned_.size());
+			if (!queue.push(std::move(batch))) {
+				break;
+			}
+		}
+	}
+
+	void runBatches(const std::function<void(LineBatch &)> & process) {
+		aborted_ = false;
+		BoundedQueue<LineBatch> queue(numThreads_ * 2);
+		std::mutex errorMut;
+		std::exception_ptr error;
+		auto fail = [&](std::exception_ptr e) {
+			{
+				std::lock_guard<std::mutex> lock(errorMut);
+				if (!error) {
+					error = e;
+				}
+			}
+			{
+				//set under the lock so a worker about to wait on pendingCv_ can't miss it
+				std::lock_guard<std::mutex> lock(pendingMut_);
+				aborted_ = true;
+			}
+			pendingCv_.notify_all();
+			queue.close();
+		};
+		std::vector<std::thread> workers;
+		for (uint32_t t = 0; t < numThreads_; ++t) {
+			workers.emplace_back([&]() {
+				LineBatch batch;
+				while (queue.pop(batch)) {
+					if (aborted_) {
+						continue;
+					}
+					try {
+						splitLines(batch);
+						process(batch);
+					} catch (...) {
+						fail(std::current_exception());
+					}
+				}
+			});
+		}
+		try {
+			if (njh::files::canBeMapped(inOpts_.inFilename_)) {
+				njh::files::MappedFile mapped(inOpts_.inFilename_);
+				mapped.advise(MADV_SEQUENTIAL);
+				produceMapped(mapped, queue);
+				//the workers have to finish before the mapping goes away
+				queue.close();
+				joinAllJoinableThreads(workers);
+			} else {
+				InputStream in(inOpts_);
+				produceStreamed(in, queue);
+			}
+		} catch (...) {
+			fail(std::current_exception());
+		}
+		queue.close();
+		joinAllJoinableThreads(workers);
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+};
+
+}  // namespace concurrent
+}  // namespace njh
@@ -45,7 +45,7 @@ public:
 	bool getVal(T & val) {
 		std::lock_guard<std::mutex> lock(mut_);
 		if (!vals_.empty()) {
-			val = vals_.front();
+			val = std::move(vals_.front());
 			vals_.pop();
 			return true;
 		}
@@ -64,7 +64,7 @@ public:
 		if (!vals_.empty()) {
 			uint32_t count = 0;
 			while(!vals_.empty() && count < num){
-				vals.emplace_back(vals_.front());
+				vals.emplace_back(std::move(vals_.front()));
 				vals_.pop();
 				++count;
 			}
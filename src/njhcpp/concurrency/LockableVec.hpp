@@ -10,6 +10,7 @@
 #include <mutex>
 #include <atomic>
 #include <cstdint>
+#include <algorithm>
 
 namespace njh {
 namespace concurrent {
@@ -48,6 +49,35 @@ public:
 		return false;
 	}
 
+	/**@brief claim the next num values at once, one atomic operation per chunk instead of per value
+	 *
+	 * @param num the number of values to claim, a minimum of 1
+	 * @param start set to the index of the first claimed value
+	 * @param stop set to one past the index of the last claimed value, can be less than start + num at the end of the vector
+	 * @return whether any values were claimed
+	 */
+	bool getRange(size_t num, size_t & start, size_t & stop) {
+		num = std::max<size_t>(1, num);
+		auto pos = indx_.fetch_add(num, std::memory_order_relaxed);
+		if (pos < vals_.size()) {
+			start = pos;
+			stop = std::min(pos + num, vals_.size());
+			return true;
+		}
+		return false;
+	}
+
+	/**@brief access a value by index, e.g. one claimed with getRange(), without copying it
+	 *
+	 */
+	const T & operator[](size_t pos) const {
+		return vals_[pos];
+	}
+
+	size_t size() const {
+		return vals_.size();
+	}
+
 	/**@brief reset the index to zero
 	 *
 	 */
@@ -0,0 +1,308 @@
+#pragma once
+/*
+ * RingBufferQueue.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// A lock-free bounded multi-producer/multi-consumer queue, the ring buffer
+// design by Dmitry Vyukov. Every slot carries a sequence number that tells
+// producers and consumers whether it is free to write or ready to read, so
+// threads only ever contend on one compare-and-swap of a position counter.
+// It has the same interface as BoundedQueue, the blocking calls spin and then
+// yield instead of sleeping on a condition variable, so it suits short hand
+// offs between busy threads rather than threads that wait a long time.
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <cstdint>
+
+
+namespace njh {
+namespace concurrent {
+
+/**@brief A lock-free bounded queue, capacity is rounded up to a power of two
+ *
+ * T has to be default constructible since every slot holds a T, move-only types are fine.
+ * A push racing with close() can still succeed, so consumers should only stop on a false pop() once all producers are done pushing
+ */
+template<typename T>
+class RingBufferQueue {
+	static const size_t cacheLineSize_ = 64;
+
+	struct Slot {
+		std::atomic<size_t> sequence_;
+		T val_;
+	};
+
+	std::unique_ptr<Slot[]> slots_; /**< the ring buffer*/
+	size_t mask_; /**< capacity - 1, to wrap positions*/
+	alignas(cacheLineSize_) std::atomic<size_t> enqueuePos_ { 0 }; /**< on its own cache line so producers and consumers don't false share*/
+	alignas(cacheLineSize_) std::atomic<size_t> dequeuePos_ { 0 };
+	alignas(cacheLineSize_) std::atomic<bool> closed_ { false };
+
+	static size_t roundUpPowerOfTwo(size_t val) {
+		size_t ret = 2;
+		while (ret < val) {
+			ret <<= 1;
+		}
+		return ret;
+	}
+
+	/**@brief Whether the queue is closed and nothing is left, a push that claimed a slot before the close but hasn't finished writing it still counts as not empty
+	 *
+	 */
+	bool closedAndEmpty() const {
+		return closed_.load(std::memory_order_acquire)
+				&& enqueuePos_.load(std::memory_order_acquire) <= dequeuePos_.load(std::memory_order_acquire);
+	}
+
+	/**@brief Spin for a little bit then start giving up the time slice
+	 *
+	 */
+	static void backoff(uint32_t & spins) {
+		if (spins < 64) {
+			++spins;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+public:
+	/**@brief construct with the maximum size
+	 *
+	 * @param capacity the maximum number of values to hold at one time, rounded up to a power of 2 (minimum 2)
+	 */
+	explicit RingBufferQueue(size_t capacity) :
+			slots_(new Slot[roundUpPowerOfTwo(capacity)]), mask_(roundUpPowerOfTwo(capacity) - 1) {
+		for (size_t pos = 0; pos <= mask_; ++pos) {
+			slots_[pos].sequence_.store(pos, std::memory_order_relaxed);
+		}
+	}
+
+	RingBufferQueue(const RingBufferQueue & other) = delete;
+	RingBufferQueue & operator=(const RingBufferQueue & other) = delete;
+
+	/**@brief Add a value if there is room without waiting
+	 *
+	 * @param val the value to add, only moved from if it was added
+	 * @return whether the value was added
+	 */
+	bool tryPush(T && val) {
+		if (closed_.load(std::memory_order_relaxed)) {
+			return false;
+		}
+		size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+		while (true) {
+			Slot & slot = slots_[pos & mask_];
+			size_t seq = slot.sequence_.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+			if (0 == diff) {
+				if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					slot.val_ = std::move(val);
+					slot.sequence_.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				//full
+				return false;
+			} else {
+				pos = enqueuePos_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**@brief Get the next value if there is one without waiting
+	 *
+	 * @param val set to the next value
+	 * @return whether a value was gotten
+	 */
+	bool tryPop(T & val) {
+		size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+		while (true) {
+			Slot & slot = slots_[pos & mask_];
+			size_t seq = slot.sequence_.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+			if (0 == diff) {
+				if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					val = std::move(slot.val_);
+					slot.sequence_.store(pos + mask_ + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				//empty
+				return false;
+			} else {
+				pos = dequeuePos_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**@brief Add a value, waiting while the queue is full
+	 *
+	 * @param val the value to add, only moved from if it was added
+	 * @return false if the queue was closed
+	 */
+	bool push(T && val) {
+		uint32_t spins = 0;
+		while (!tryPush(std::move(val))) {
+			if (closed_.load(std::memory_order_acquire)) {
+				return false;
+			}
+			backoff(spins);
+		}
+		return true;
+	}
+
+	/**@brief Add a copy of a value, waiting while the queue is full
+	 *
+	 * @param val the value to add
+	 * @return false if the queue was closed
+	 */
+	bool push(const T & val) {
+		T copy(val);
+		return push(std::move(copy));
+	}
+
+	/**@brief Add several values, waiting while the queue is full, values are added as room frees up so vals can be larger than the capacity
+	 *
+	 * @param vals the values to add, moved from
+	 * @return the number of values added, less than vals.size() only if the queue was closed
+	 */
+	size_t pushBatch(std::vector<T> & vals) {
+		size_t added = 0;
+		for (auto & val : vals) {
+			if (!push(std::move(val))) {
+				break;
+			}
+			++added;
+		}
+		return added;
+	}
+
+	/**@brief Add a value, waiting at most timeout for room
+	 *
+	 * @param val the value to add, only moved from if it was added
+	 * @param timeout the maximum time to wait
+	 * @return whether the value was added, false on timeout or if the queue was closed
+	 */
+	template<typename REP, typename PERIOD>
+	bool pushFor(T && val, const std::chrono::duration<REP, PERIOD> & timeout) {
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		uint32_t spins = 0;
+		while (!tryPush(std::move(val))) {
+			if (closed_.load(std::memory_order_acquire) || std::chrono::steady_clock::now() >= deadline) {
+				return false;
+			}
+			backoff(spins);
+		}
+		return true;
+	}
+
+	/**@brief Get the next value, waiting while the queue is empty and not closed
+	 *
+	 * @param val set to the next value
+	 * @return false if the queue was closed and there were no more values
+	 */
+	bool pop(T & val) {
+		uint32_t spins = 0;
+		while (!tryPop(val)) {
+			if (closedAndEmpty()) {
+				return false;
+			}
+			backoff(spins);
+		}
+		return true;
+	}
+
+	/**@brief Get the next value, waiting at most timeout for one
+	 *
+	 * @param val set to the next value
+	 * @param timeout the maximum time to wait
+	 * @return whether a value was gotten
+	 */
+	template<typename REP, typename PERIOD>
+	bool popFor(T & val, const std::chrono::duration<REP, PERIOD> & timeout) {
+		auto deadline = std::chrono::steady_clock::now() + timeout;
+		uint32_t spins = 0;
+		while (!tryPop(val)) {
+			if (closedAndEmpty() || std::chrono::steady_clock::now() >= deadline) {
+				return false;
+			}
+			backoff(spins);
+		}
+		return true;
+	}
+
+	/**@brief Get up to maxNum values, waiting until at least one is available
+	 *
+	 * @param vals cleared and then filled with the values
+	 * @param maxNum the maximum number of values to get
+	 * @return false if the queue was closed and there were no more values
+	 */
+	bool popBatch(std::vector<T> & vals, size_t maxNum) {
+		vals.clear();
+		T val;
+		if (!pop(val)) {
+			return false;
+		}
+		vals.emplace_back(std::move(val));
+		while (vals.size() < maxNum && tryPop(val)) {
+			vals.emplace_back(std::move(val));
+		}
+		return true;
+	}
+
+	/**@brief Take everything currently in the queue without waiting
+	 *
+	 * @param vals the values are appended to this
+	 * @return the number of values taken
+	 */
+	size_t drain(std::vector<T> & vals) {
+		size_t taken = 0;
+		T val;
+		while (tryPop(val)) {
+			vals.emplace_back(std::move(val));
+			++taken;
+		}
+		return taken;
+	}
+
+	/**@brief Stop accepting values, values already in the queue can still be popped
+	 *
+	 */
+	void close() {
+		closed_.store(true, std::memory_order_release);
+	}
+
+	bool closed() const {
+		return closed_.load(std::memory_order_acquire);
+	}
+
+	/**@brief Whether the queue looks empty, only exact when no other thread is using the queue
+	 *
+	 */
+	bool empty() const {
+		return 0 == size();
+	}
+
+	/**@brief The approximate number of values in the queue, only exact when no other thread is using the queue
+	 *
+	 */
+	size_t size() const {
+		size_t enqueued = enqueuePos_.load(std::memory_order_acquire);
+		size_t dequeued = dequeuePos_.load(std::memory_order_acquire);
+		return enqueued > dequeued ? enqueued - dequeued : 0;
+	}
+
+	size_t capacity() const {
+		return mask_ + 1;
+	}
+};
+
+}  // namespace concurrent
+}  // namespace njh
@@ -0,0 +1,436 @@
+#pragma once
+/*
+ * ThreadPool.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// A persistent work-stealing thread pool. Every worker has its own deque of
+// tasks, a worker pushes the tasks it creates onto the front of its own deque
+// and takes from the front (most recently added first, which keeps nested
+// work hot in cache), and when its deque is empty it steals from the back of
+// the other workers' deques. Tasks submitted from outside the pool are dealt
+// out round robin. Waiting on a TaskGroup runs pending tasks instead of just
+// blocking, so tasks can themselves spawn and wait on more tasks without
+// tying up the pool. ThreadCache is for the opposite case, tasks that have to
+// run at the same time, it never queues and instead reuses idle threads.
+
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <future>
+#include <chrono>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+#include <type_traits>
+
+
+namespace njh {
+namespace concurrent {
+
+class ThreadPool {
+public:
+	typedef std::function<void()> Task;
+
+	/**@brief Start the pool
+	 *
+	 * @param numThreads the number of worker threads, a minimum of 1
+	 * @param maxThreads the most threads the pool can be grown to with ensureThreads()
+	 */
+	explicit ThreadPool(uint32_t numThreads, uint32_t maxThreads = 256) :
+			queues_(std::max<uint32_t>(std::max<uint32_t>(1, numThreads), maxThreads)) {
+		ensureThreads(std::max<uint32_t>(1, numThreads));
+	}
+
+	ThreadPool(const ThreadPool & other) = delete;
+	ThreadPool & operator=(const ThreadPool & other) = delete;
+
+	/**@brief Finish all the tasks already submitted and then stop the workers
+	 *
+	 */
+	~ThreadPool() {
+		{
+			std::lock_guard<std::mutex> lock(sleepMut_);
+			stopping_ = true;
+		}
+		sleepCv_.notify_all();
+		std::lock_guard<std::mutex> growLock(growMut_);
+		for (auto & t : threads_) {
+			t.join();
+		}
+	}
+
+	/**@brief The shared pool, started with one thread per core
+	 *
+	 */
+	static ThreadPool & global() {
+		static ThreadPool pool(std::max<uint32_t>(1, std::thread::hardware_concurrency()));
+		return pool;
+	}
+
+	/**@brief Add workers until there are at least numThreads of them, can be called while the pool is in use
+	 *
+	 * @param numThreads the minimum number of worker threads, capped at the max given on construction
+	 */
+	void ensureThreads(uint32_t numThreads) {
+		std::lock_guard<std::mutex> growLock(growMut_);
+		numThreads = std::min<uint32_t>(numThreads, queues_.size());
+		while (threads_.size() < numThreads) {
+			uint32_t index = threads_.size();
+			queues_[index] = std::make_unique<WorkerQueue>();
+			numQueues_.store(index + 1, std::memory_order_release);
+			threads_.emplace_back(&ThreadPool::workerLoop, this, index);
+		}
+	}
+
+	uint32_t size() const {
+		return numQueues_.load(std::memory_order_acquire);
+	}
+
+	/**@brief Run a task on the pool
+	 *
+	 * @param func the function to run
+	 * @param args the arguments to call func with, copied
+	 * @return a future for the result of func, it will hold any exception func throws
+	 */
+	template<typename FUNC, typename ... ARGS>
+	auto submit(FUNC && func, ARGS && ... args) -> std::future<std::invoke_result_t<std::decay_t<FUNC>, std::decay_t<ARGS>...>> {
+		typedef std::invoke_result_t<std::decay_t<FUNC>, std::decay_t<ARGS>...> RET;
+		auto task = std::make_shared<std::packaged_task<RET()>>(
+				std::bind(std::forward<FUNC>(func), std::forward<ARGS>(args)...));
+		std::future<RET> ret = task->get_future();
+		push([task]() {(*task)();});
+		return ret;
+	}
+
+	/**@brief Queue a task that doesn't need a future
+	 *
+	 */
+	void push(Task task) {
+		uint32_t numQueues = size();
+		uint32_t index = (this == currentPool_ && currentIndex_ < numQueues) ?
+				currentIndex_ : nextQueue_.fetch_add(1, std::memory_order_relaxed) % numQueues;
+		WorkerQueue & queue = *queues_[index];
+		{
+			std::lock_guard<std::mutex> lock(queue.mut_);
+			if (this == currentPool_) {
+				queue.tasks_.emplace_front(std::move(task));
+			} else {
+				queue.tasks_.emplace_back(std::move(task));
+			}
+		}
+		{
+			std::lock_guard<std::mutex> lock(sleepMut_);
+			++pending_;
+		}
+		sleepCv_.notify_one();
+	}
+
+	/**@brief Run one queued task on the calling thread if there is one, used to help out while waiting
+	 *
+	 * @return whether a task was run
+	 */
+	bool runPendingTask() {
+		Task task;
+		uint32_t start = (this == currentPool_) ? currentIndex_ : nextQueue_.load(std::memory_order_relaxed);
+		if (!takeTask(start, task)) {
+			return false;
+		}
+		task();
+		return true;
+	}
+
+	/**@brief Run func over the indexes [begin, end) in chunks on the pool, the calling thread helps and this returns once every index is done
+	 *
+	 * @param begin the first index
+	 * @param end one past the last index
+	 * @param func the function to run on each index
+	 * @param grainSize the number of indexes per task, 0 picks one that gives each thread about four tasks
+	 */
+	void parallel_for(size_t begin, size_t end, const std::function<void(size_t)> & func,
+			size_t grainSize = 0);
+
+	/**@brief Run func over the indexes [begin, end) in chunks on the pool, func gets each chunk as a [chunkBegin, chunkEnd) range
+	 *
+	 * @param begin the first index
+	 * @param end one past the last index
+	 * @param func the function to run on each chunk
+	 * @param grainSize the number of indexes per chunk, 0 picks one that gives each thread about four chunks
+	 */
+	void parallel_for_range(size_t begin, size_t end,
+			const std::function<void(size_t, size_t)> & func, size_t grainSize = 0);
+
+private:
+	struct WorkerQueue {
+		std::mutex mut_;
+		std::deque<Task> tasks_;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues_; /**< one per worker, sized to the max number of workers so it never reallocates*/
+	std::atomic<uint32_t> numQueues_ { 0 };
+	std::atomic<uint32_t> nextQueue_ { 0 }; /**< round robin for tasks submitted from outside the pool*/
+	std::vector<std::thread> threads_;
+	std::mutex growMut_; /**< guards threads_*/
+
+	std::mutex sleepMut_; /**< idle workers sleep on sleepCv_, pending_ is only raised under this so no wake up is lost*/
+	std::condition_variable sleepCv_;
+	std::atomic<int64_t> pending_ { 0 }; /**< the number of tasks queued and not yet taken, signed since a task can be taken just before its count goes up*/
+	bool stopping_ = false;
+
+	static thread_local ThreadPool * currentPool_; /**< the pool the current thread is a worker of, if any*/
+	static thread_local uint32_t currentIndex_; /**< the index of the current thread's own queue*/
+
+	/**@brief Take a task, first from the front of queue start and then from the back of the others
+	 *
+	 */
+	bool takeTask(uint32_t start, Task & task) {
+		uint32_t numQueues = size();
+		for (uint32_t offset = 0; offset < numQueues; ++offset) {
+			uint32_t index = (start + offset) % numQueues;
+			WorkerQueue & queue = *queues_[index];
+			std::lock_guard<std::mutex> lock(queue.mut_);
+			if (!queue.tasks_.empty()) {
+				if (0 == offset) {
+					task = std::move(queue.tasks_.front());
+					queue.tasks_.pop_front();
+				} else {
+					task = std::move(queue.tasks_.back());
+					queue.tasks_.pop_back();
+				}
+				pending_.fetch_sub(1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void workerLoop(uint32_t index) {
+		currentPool_ = this;
+		currentIndex_ = index;
+		while (true) {
+			Task task;
+			if (takeTask(index, task)) {
+				task();
+				continue;
+			}
+			std::unique_lock<std::mutex> lock(sleepMut_);
+			sleepCv_.wait(lock, [this]() {return pending_.load(std::memory_order_relaxed) > 0 || stopping_;});
+			if (stopping_ && 0 == pending_.load(std::memory_order_relaxed)) {
+				return;
+			}
+		}
+	}
+};
+
+inline thread_local ThreadPool * ThreadPool::currentPool_ = nullptr;
+inline thread_local uint32_t ThreadPool::currentIndex_ = 0;
+
+/**@brief A set of tasks run on a ThreadPool that can be waited on together
+ *
+ */
+class TaskGroup {
+	ThreadPool & pool_;
+	std::mutex mut_;
+	std::condition_variable doneCv_;
+	uint64_t outstanding_ = 0; /**< tasks not yet finished*/
+	std::exception_ptr error_; /**< the first exception thrown by a task*/
+public:
+	explicit TaskGroup(ThreadPool & pool = ThreadPool::global()) :
+			pool_(pool) {
+	}
+
+	TaskGroup(const TaskGroup & other) = delete;
+	TaskGroup & operator=(const TaskGroup & other) = delete;
+
+	~TaskGroup() {
+		try {
+			wait();
+		} catch (...) {
+			//exceptions only come out of an explicit call to wait()
+		}
+	}
+
+	/**@brief Run a task as part of the group
+	 *
+	 * @param task the task, exceptions it throws are rethrown by wait()
+	 */
+	void run(ThreadPool::Task task) {
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			++outstanding_;
+		}
+		pool_.push([this, task = std::move(task)]() {
+			std::exception_ptr error;
+			try {
+				task();
+			} catch (...) {
+				error = std::current_exception();
+			}
+			//notify while holding the lock, once outstanding_ hits 0 the waiting thread can destroy the group
+			std::lock_guard<std::mutex> lock(mut_);
+			if (error && !error_) {
+				error_ = error;
+			}
+			--outstanding_;
+			doneCv_.notify_all();
+		});
+	}
+
+	/**@brief Wait for every task in the group to finish, running queued tasks on this thread in the mean time
+	 *
+	 * Throws the first exception thrown by any of the tasks
+	 */
+	void wait() {
+		while (true) {
+			{
+				std::lock_guard<std::mutex> lock(mut_);
+				if (0 == outstanding_) {
+					break;
+				}
+			}
+			if (!pool_.runPendingTask()) {
+				//everything left is running on other threads, wake up now and then in case they queue more work to help with
+				std::unique_lock<std::mutex> lock(mut_);
+				doneCv_.wait_for(lock, std::chrono::milliseconds(1), [this]() {return 0 == outstanding_;});
+			}
+		}
+		std::exception_ptr error;
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			std::swap(error, error_);
+		}
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+};
+
+/**@brief Threads kept around to run tasks that must all run at the same time, e.g. copies of a function that wait on each other
+ *
+ * Unlike ThreadPool a task is never queued, it's handed to an idle thread or a new thread is started for it. Threads that finish
+ * a task wait for the next one, up to maxIdle of them, any more than that exit so a burst of tasks doesn't leave threads behind
+ */
+class ThreadCache {
+public:
+	/**@brief Set up the cache, threads are only started as tasks need them
+	 *
+	 * @param maxIdle the most finished threads to keep waiting for more tasks
+	 */
+	explicit ThreadCache(uint32_t maxIdle) :
+			maxIdle_(maxIdle) {
+	}
+
+	ThreadCache(const ThreadCache & other) = delete;
+	ThreadCache & operator=(const ThreadCache & other) = delete;
+
+	/**@brief Wait for running tasks to finish and let the idle threads exit
+	 *
+	 */
+	~ThreadCache() {
+		std::unique_lock<std::mutex> lock(mut_);
+		stopping_ = true;
+		handoffCv_.notify_all();
+		doneCv_.wait(lock, [this]() {return 0 == live_;});
+	}
+
+	/**@brief The shared cache, keeps up to one idle thread per core
+	 *
+	 */
+	static ThreadCache & global() {
+		static ThreadCache cache(std::max<uint32_t>(1, std::thread::hardware_concurrency()));
+		return cache;
+	}
+
+	/**@brief Start a task right away on its own thread
+	 *
+	 * @param task the task, shouldn't throw
+	 */
+	void run(ThreadPool::Task task) {
+		std::lock_guard<std::mutex> lock(mut_);
+		//every handed off task has its own idle thread waiting for it
+		if (idle_ > handoff_.size()) {
+			handoff_.emplace_back(std::move(task));
+			handoffCv_.notify_one();
+			return;
+		}
+		++live_;
+		std::thread(&ThreadCache::workerLoop, this, std::move(task)).detach();
+	}
+
+	/**@brief The number of threads waiting for a task
+	 *
+	 */
+	uint32_t idle() const {
+		std::lock_guard<std::mutex> lock(mut_);
+		return idle_;
+	}
+
+private:
+	uint32_t maxIdle_;
+	mutable std::mutex mut_;
+	std::condition_variable handoffCv_; /**< idle threads wait on this for handoff_*/
+	std::condition_variable doneCv_; /**< signaled when the last thread exits*/
+	std::deque<ThreadPool::Task> handoff_; /**< tasks given to idle threads not yet taken*/
+	uint32_t idle_ = 0;
+	uint32_t live_ = 0; /**< the number of threads started that haven't exited*/
+	bool stopping_ = false;
+
+	void workerLoop(ThreadPool::Task task) {
+		std::unique_lock<std::mutex> lock(mut_);
+		while (true) {
+			lock.unlock();
+			task();
+			task = nullptr;
+			lock.lock();
+			if (stopping_ || idle_ >= maxIdle_) {
+				break;
+			}
+			++idle_;
+			handoffCv_.wait(lock, [this]() {return !handoff_.empty() || stopping_;});
+			--idle_;
+			if (handoff_.empty()) {
+				break;
+			}
+			task = std::move(handoff_.front());
+			handoff_.pop_front();
+		}
+		//notify while holding the lock, once live_ hits 0 the destructor can finish
+		--live_;
+		doneCv_.notify_all();
+	}
+};
+
+inline void ThreadPool::parallel_for_range(size_t begin, size_t end,
+		const std::function<void(size_t, size_t)> & func, size_t grainSize) {
+	if (begin >= end) {
+		return;
+	}
+	if (0 == grainSize) {
+		grainSize = std::max<size_t>(1, (end - begin) / (size() * 4));
+	}
+	TaskGroup group(*this);
+	for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += grainSize) {
+		size_t chunkEnd = std::min(end, chunkBegin + grainSize);
+		group.run([&func, chunkBegin, chunkEnd]() {
+			func(chunkBegin, chunkEnd);
+		});
+	}
+	group.wait();
+}
+
+inline void ThreadPool::parallel_for(size_t begin, size_t end,
+		const std::function<void(size_t)> & func, size_t grainSize) {
+	parallel_for_range(begin, end, [&func](size_t chunkBegin, size_t chunkEnd) {
+		for (size_t index = chunkBegin; index < chunkEnd; ++index) {
+			func(index);
+		}
+	}, grainSize);
+}
+
+}  // namespace concurrent
+}  // namespace njh
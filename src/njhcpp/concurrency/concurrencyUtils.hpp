@@ -11,7 +11,10 @@
 #include "njhcpp/common.h"
 
 #include <thread>
+#include <mutex>
 #include <functional>
+#include <condition_variable>
+#include "njhcpp/concurrency/ThreadPool.hpp"
 
 namespace njh {
 namespace concurrent {
@@ -58,16 +61,82 @@ inline void detachAllJoinableThreads(std::vector<std::thread> & threads){
 
 
 /**@brief Run a function that takes no arguments and returns nothing over a number of threads
+ *
+ * All numThreads copies of func run at the same time, the calling thread runs one and the others are run on threads reused from
+ * ThreadCache::global() rather than new ones each call, the first exception thrown by a copy is rethrown once they've all finished
  *
  * @param func the fuction object to run, pass by reference in case it has object references that need to be updated
  * @param numThreads the number of threads to use
  */
 inline void runVoidFunctionThreaded(std::function<void()> & func, uint32_t numThreads){
-	std::vector<std::thread> threads;
-	for(uint32_t t = 0; t < numThreads; ++t){
-		threads.emplace_back(std::thread(func));
+	if (numThreads <= 1) {
+		func();
+		return;
+	}
+	std::vector<std::exception_ptr> errors(numThreads);
+	std::mutex mut;
+	std::condition_variable doneCv;
+	uint32_t running = numThreads - 1;
+	auto & cache = ThreadCache::global();
+	for (uint32_t t = 1; t < numThreads; ++t) {
+		cache.run([&func, &errors, &mut, &doneCv, &running, t]() {
+			try {
+				func();
+			} catch (...) {
+				errors[t] = std::current_exception();
+			}
+			//notify while holding the lock, once running hits 0 the caller's locals go away
+			std::lock_guard<std::mutex> lock(mut);
+			--running;
+			doneCv.notify_all();
+		});
+	}
+	try {
+		func();
+	} catch (...) {
+		errors[0] = std::current_exception();
+	}
+	{
+		std::unique_lock<std::mutex> lock(mut);
+		doneCv.wait(lock, [&running]() {return 0 == running;});
+	}
+	for (const auto & error : errors) {
+		if (error) {
+			std::rethrow_exception(error);
+		}
+	}
+}
+
+/**@brief Run a function that takes no arguments and returns nothing numThreads times on the shared ThreadPool instead of new threads
+ *
+ * Cheaper than runVoidFunctionThreaded() when called often, but the copies aren't guaranteed to run at the same time:
+ * they queue behind whatever else is on ThreadPool::global(), which isn't grown so at most one copy per core plus the calling thread's run at once,
+ * and while the calling thread waits it can run other queued pool tasks. So func should claim its work from shared state (e.g. an atomic counter)
+ * until there's none left and never wait on another copy, copies that start after the work is gone just return.
+ * The first exception thrown by a copy is rethrown once they've all finished
+ *
+ * @param func the fuction object to run, pass by reference in case it has object references that need to be updated
+ * @param numThreads the number of copies to run
+ */
+inline void runVoidFunctionPooled(std::function<void()> & func, uint32_t numThreads){
+	if (numThreads <= 1) {
+		func();
+		return;
+	}
+	TaskGroup group(ThreadPool::global());
+	for (uint32_t t = 1; t < numThreads; ++t) {
+		group.run(func);
+	}
+	std::exception_ptr error;
+	try {
+		func();
+	} catch (...) {
+		error = std::current_exception();
+	}
+	group.wait();
+	if (error) {
+		std::rethrow_exception(error);
 	}
-	joinAllThreads(threads);
 }
 
 
@@ -0,0 +1,111 @@
+#pragma once
+/*
+ * parallelAlgorithms.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Loops over random access containers on several threads. Threads claim
+// chunks of indexes from a shared atomic counter (the same scheme as
+// LockableVec::getRange) so there is one atomic operation per chunk rather
+// than per element, and elements are used in place instead of being copied.
+
+#include <atomic>
+#include <vector>
+#include <iterator>
+#include <functional>
+#include "njhcpp/concurrency/ThreadPool.hpp"
+#include "njhcpp/concurrency/concurrencyUtils.hpp" //runVoidFunctionPooled()
+
+namespace njh {
+namespace concurrent {
+
+/**@brief A value on its own cache line so values for different threads stored next to each other don't false share
+ *
+ */
+template<typename T>
+struct alignas(64) CacheLinePadded {
+	T val_;
+};
+
+/**@brief Pick a chunk size when none is given, enough chunks for each thread to get several so uneven work still balances
+ *
+ */
+inline size_t defaultGrainSize(size_t num, uint32_t numThreads) {
+	return std::max<size_t>(1, num / (std::max<uint32_t>(1, numThreads) * 8));
+}
+
+/**@brief Run func on every element of con on several threads
+ *
+ * @param con a random access container, elements are passed by reference so func can modify them if con isn't const
+ * @param func the function to run on each element
+ * @param numThreads the number of threads to use
+ * @param grainSize the number of elements a thread claims at once, 0 picks one
+ */
+template<typename CON, typename FUNC>
+void parallel_for_each(CON & con, FUNC func, uint32_t numThreads, size_t grainSize = 0) {
+	const size_t num = std::size(con);
+	if (0 == grainSize) {
+		grainSize = defaultGrainSize(num, numThreads);
+	}
+	auto first = std::begin(con);
+	std::atomic<size_t> next { 0 };
+	std::function<void()> work = [&]() {
+		size_t start = next.fetch_add(grainSize, std::memory_order_relaxed);
+		while (start < num) {
+			const size_t stop = std::min(start + grainSize, num);
+			for (size_t pos = start; pos < stop; ++pos) {
+				func(first[pos]);
+			}
+			start = next.fetch_add(grainSize, std::memory_order_relaxed);
+		}
+	};
+	runVoidFunctionPooled(work, numThreads);
+}
+
+/**@brief Reduce the elements of con on several threads, each thread folds its elements into its own accumulator and the accumulators are combined at the end
+ *
+ * Each thread's accumulator starts as a value initialized ACC{}, so ACC{} needs to be the identity of combine (e.g. 0 for a sum, an empty container for a merge)
+ *
+ * @param con a random access container
+ * @param init the starting value, combined with the thread accumulators exactly once
+ * @param accumulate called as accumulate(ACC & acc, const element &) to fold an element into an accumulator
+ * @param combine called as combine(ACC & total, const ACC & threadAcc) to merge the per thread accumulators
+ * @param numThreads the number of threads to use
+ * @param grainSize the number of elements a thread claims at once, 0 picks one
+ * @return the combined result
+ */
+template<typename CON, typename ACC, typename ACCUMULATE, typename COMBINE>
+ACC parallel_reduce(const CON & con, const ACC & init, ACCUMULATE accumulate,
+		COMBINE combine, uint32_t numThreads, size_t grainSize = 0) {
+	numThreads = std::max<uint32_t>(1, numThreads);
+	const size_t num = std::size(con);
+	if (0 == grainSize) {
+		grainSize = defaultGrainSize(num, numThreads);
+	}
+	auto first = std::begin(con);
+	std::vector<CacheLinePadded<ACC>> accs(numThreads, CacheLinePadded<ACC> { ACC { } });
+	std::atomic<size_t> next { 0 };
+	std::atomic<uint32_t> nextThread { 0 };
+	std::function<void()> work = [&]() {
+		ACC & acc = accs[nextThread.fetch_add(1, std::memory_order_relaxed)].val_;
+		size_t start = next.fetch_add(grainSize, std::memory_order_relaxed);
+		while (start < num) {
+			const size_t stop = std::min(start + grainSize, num);
+			for (size_t pos = start; pos < stop; ++pos) {
+				accumulate(acc, first[pos]);
+			}
+			start = next.fetch_add(grainSize, std::memory_order_relaxed);
+		}
+	};
+	runVoidFunctionPooled(work, numThreads);
+	ACC ret = init;
+	for (const auto & acc : accs) {
+		combine(ret, acc.val_);
+	}
+	return ret;
+}
+
+}  // namespace concurrent
+}  // namespace njh
@@ -5,7 +5,13 @@
 #include "njhcpp/files/fileStreamUtils.hpp"
 #include "njhcpp/files/fileSystemUtils.hpp"
 #include "njhcpp/files/fileUtilities.hpp"
+#include "njhcpp/files/podFileHeader.hpp"
+#include "njhcpp/files/podChunkedIO.hpp"
+#include "njhcpp/files/podFlatMatrix.hpp"
+#include "njhcpp/files/podWriters.hpp"
 #include "njhcpp/files/podVecIO.hpp"
+#include "njhcpp/files/podVecViews.hpp"
+#include "njhcpp/files/newlineScanning.hpp"
 #include "njhcpp/files/fileObjects.h"
 
 
@@ -12,5 +12,9 @@
 #include "njhcpp/files/fileObjects/FileCache.hpp"
 #include "njhcpp/files/fileObjects/FilesCache.hpp"
 #include "njhcpp/files/fileObjects/gzTextFileCpp.hpp"
+#include "njhcpp/files/fileObjects/MappedFile.hpp"
+#include "njhcpp/files/fileObjects/MappedLineReader.hpp"
 #include "njhcpp/files/fileObjects/gzstream.hpp"
+#include "njhcpp/files/fileObjects/pgzstream.hpp"
+#include "njhcpp/files/fileObjects/bgzfstream.hpp"
 
@@ -0,0 +1,164 @@
+#pragma once
+/*
+ * MappedFile.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <string>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <boost/filesystem.hpp>
+
+namespace njh {
+namespace files {
+namespace bfs = boost::filesystem;
+
+/**@brief A file memory mapped into the address space, unmapped when the object is destroyed
+ *
+ * Empty files can't be mapped, so for them data() is nullptr and size() is 0
+ */
+class MappedFile {
+	bfs::path fnp_; /**< the file path*/
+	char * data_ = nullptr; /**< the start of the mapping*/
+	size_t size_ = 0; /**< the size of the mapping*/
+	bool writable_ = false; /**< whether the mapping was made writable*/
+
+	void unmap() {
+		if (nullptr != data_) {
+			::munmap(data_, size_);
+			data_ = nullptr;
+			size_ = 0;
+		}
+	}
+
+public:
+	/**@brief Map a whole file
+	 *
+	 * @param fnp the file to map
+	 * @param writable whether to map the file for reading and writing, writes go to the file (MAP_SHARED)
+	 */
+	explicit MappedFile(const bfs::path & fnp, bool writable = false) :
+			fnp_(fnp), writable_(writable) {
+		int fd = ::open(fnp.c_str(), writable ? O_RDWR : O_RDONLY);
+		if (fd < 0) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in opening " << fnp << ": " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		struct stat st;
+		if (0 != ::fstat(fd, &st)) {
+			::close(fd);
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in getting size of " << fnp << ": " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		size_ = st.st_size;
+		if (size_ > 0) {
+			void * addr = ::mmap(nullptr, size_, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+			if (MAP_FAILED == addr) {
+				int mapErrno = errno;
+				::close(fd);
+				size_ = 0;
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error in mapping " << fnp << ": " << std::strerror(mapErrno) << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+			data_ = static_cast<char *>(addr);
+		}
+		//the mapping keeps its own reference to the file
+		::close(fd);
+	}
+
+	MappedFile(const MappedFile & other) = delete;
+	MappedFile & operator=(const MappedFile & other) = delete;
+
+	MappedFile(MappedFile && other) noexcept :
+			fnp_(std::move(other.fnp_)), data_(other.data_), size_(other.size_), writable_(other.writable_) {
+		other.data_ = nullptr;
+		other.size_ = 0;
+	}
+
+	MappedFile & operator=(MappedFile && other) noexcept {
+		if (this != &other) {
+			unmap();
+			fnp_ = std::move(other.fnp_);
+			data_ = other.data_;
+			size_ = other.size_;
+			writable_ = other.writable_;
+			other.data_ = nullptr;
+			other.size_ = 0;
+		}
+		return *this;
+	}
+
+	~MappedFile() {
+		unmap();
+	}
+
+	const char * data() const {
+		return data_;
+	}
+
+	/**@brief Writable access to the mapping, throws if not mapped writable
+	 *
+	 */
+	char * mutableData() {
+		if (!writable_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp_ << " was not mapped writable" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		return data_;
+	}
+
+	size_t size() const {
+		return size_;
+	}
+
+	bool empty() const {
+		return 0 == size_;
+	}
+
+	bool writable() const {
+		return writable_;
+	}
+
+	const bfs::path & path() const {
+		return fnp_;
+	}
+
+	/**@brief Give the kernel a hint on how the mapping will be accessed, e.g. MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED
+	 *
+	 * @param advice the madvise advice
+	 */
+	void advise(int advice) const {
+		if (nullptr != data_) {
+			::madvise(data_, size_, advice);
+		}
+	}
+
+	/**@brief Flush changes made through a writable mapping to the file
+	 *
+	 * @param wait whether to wait for the write to finish (MS_SYNC) or only schedule it (MS_ASYNC)
+	 */
+	void sync(bool wait = true) const {
+		if (nullptr != data_ && writable_) {
+			if (0 != ::msync(data_, size_, wait ? MS_SYNC : MS_ASYNC)) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error in syncing " << fnp_ << ": " << std::strerror(errno) << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+		}
+	}
+};
+
+}  // namespace files
+}  // namespace njh
+
@@ -0,0 +1,166 @@
+#pragma once
+/*
+ * MappedLineReader.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <string_view>
+#include <iterator>
+#include <memory>
+#include "njhcpp/files/fileObjects/MappedFile.hpp"
+#include "njhcpp/files/newlineScanning.hpp"
+
+namespace njh {
+namespace files {
+
+/**@brief Get the next line from a block of memory, treating \n, \r\n and \r as line endings the same way njh::files::crossPlatGetline does
+ *
+ * @param pos the current position, will be moved past the line and its line ending
+ * @param end the end of the block of memory
+ * @param line the line, without the line ending, will point into the block of memory
+ * @return false if there were no more lines (pos == end)
+ */
+inline bool nextLineView(const char *& pos, const char * end, std::string_view & line) {
+	if (pos >= end) {
+		return false;
+	}
+	const char * lineEnd = findLineEnding(pos, end);
+	line = std::string_view(pos, lineEnd - pos);
+	if (lineEnd < end) {
+		if ('\r' == *lineEnd && lineEnd + 1 < end && '\n' == lineEnd[1]) {
+			++lineEnd;
+		}
+		++lineEnd;
+	}
+	pos = lineEnd;
+	return true;
+}
+
+/**@brief Read lines from a memory mapped file (or any block of memory) as std::string_view without copying
+ *
+ * The lines point into the mapping so they are only valid for as long as the reader is alive
+ */
+class MappedLineReader {
+	std::shared_ptr<MappedFile> file_; /**< the mapped file if the reader owns one*/
+	const char * start_ = nullptr;
+	const char * end_ = nullptr;
+	const char * pos_ = nullptr;
+
+public:
+	/**@brief Map a file and read lines from it
+	 *
+	 * @param fnp the file to read
+	 */
+	explicit MappedLineReader(const bfs::path & fnp) :
+			file_(std::make_shared<MappedFile>(fnp)) {
+		file_->advise(MADV_SEQUENTIAL);
+		start_ = file_->data();
+		end_ = start_ + file_->size();
+		pos_ = start_;
+	}
+
+	/**@brief Read lines from an already mapped file
+	 *
+	 * @param file the mapped file, shared so the lines stay valid
+	 */
+	explicit MappedLineReader(const std::shared_ptr<MappedFile> & file) :
+			file_(file), start_(file->data()), end_(file->data() + file->size()), pos_(
+					file->data()) {
+	}
+
+	/**@brief Read lines from a block of memory, the memory has to outlive the reader
+	 *
+	 * @param data the start of the memory
+	 * @param len the length of the memory
+	 */
+	MappedLineReader(const char * data, size_t len) :
+			start_(data), end_(data + len), pos_(data) {
+	}
+
+	/**@brief Get the next line
+	 *
+	 * @param line will be set to the next line, without the line ending
+	 * @return whether there was another line
+	 */
+	bool getline(std::string_view & line) {
+		return nextLineView(pos_, end_, line);
+	}
+
+	/**@brief Go back to the beginning
+	 *
+	 */
+	void reset() {
+		pos_ = start_;
+	}
+
+	/**@brief The offset of the next line from the start
+	 *
+	 */
+	size_t position() const {
+		return pos_ - start_;
+	}
+
+	bool done() const {
+		return pos_ >= end_;
+	}
+
+	/**@brief Input iterator over the remaining lines
+	 *
+	 */
+	class iterator {
+		const char * pos_ = nullptr;
+		const char * end_ = nullptr;
+		std::string_view line_;
+		bool valid_ = false;
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const std::string_view *;
+		using reference = const std::string_view &;
+
+		iterator() = default;
+		iterator(const char * pos, const char * end) :
+				pos_(pos), end_(end) {
+			valid_ = nextLineView(pos_, end_, line_);
+		}
+		reference operator*() const {
+			return line_;
+		}
+		pointer operator->() const {
+			return &line_;
+		}
+		iterator & operator++() {
+			valid_ = nextLineView(pos_, end_, line_);
+			return *this;
+		}
+		iterator operator++(int) {
+			iterator ret = *this;
+			++(*this);
+			return ret;
+		}
+		bool operator==(const iterator & other) const {
+			if (!valid_ || !other.valid_) {
+				return valid_ == other.valid_;
+			}
+			return line_.data() == other.line_.data();
+		}
+		bool operator!=(const iterator & other) const {
+			return !(*this == other);
+		}
+	};
+
+	iterator begin() const {
+		return iterator(pos_, end_);
+	}
+
+	iterator end() const {
+		return iterator();
+	}
+};
+
+}  // namespace files
+}  // namespace njh
+
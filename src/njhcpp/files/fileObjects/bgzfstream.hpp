@@ -0,0 +1,875 @@
+#pragma once
+/*
+ * bgzfstream.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// BGZF (blocked gzip) streams. A BGZF file is a series of gzip members of at
+// most 64KiB each, with the compressed size of every member stored in a "BC"
+// extra field, followed by an empty end of file member. Because each member
+// can be inflated independently this allows random access through virtual
+// offsets ((compressed block address << 16) | offset within the uncompressed
+// block) and spreading inflating and deflating across threads. The files are
+// still valid gzip files so igzstream/gzread/zcat can read them as well.
+
+#include <iostream>
+#include <fstream>
+#include <zlib.h>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <boost/filesystem.hpp>
+#include "njhcpp/concurrency/concurrencyUtils.hpp" //runVoidFunctionPooled()
+
+namespace njh {
+namespace bfs = boost::filesystem;
+
+namespace GZSTREAM {
+
+static const uint32_t bgzfBlockHeaderLength = 18; /**< length of a BGZF gzip header including the BC extra field*/
+static const uint32_t bgzfBlockFooterLength = 8; /**< length of the gzip footer, crc32 and uncompressed size*/
+static const uint32_t bgzfMaxBlockSize = 64 * 1024; /**< maximum size of a whole compressed BGZF block*/
+static const uint32_t bgzfMaxBlockDataSize = 0xff00; /**< maximum number of uncompressed bytes put in a block, leaves room for incompressible data*/
+
+/**@brief The empty block that marks the end of a BGZF file
+ *
+ */
+static const unsigned char bgzfEofBlock[28] = { 0x1f, 0x8b, 0x08, 0x04, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0xff, 0x06, 0x00, 0x42, 0x43, 0x02, 0x00, 0x1b, 0x00,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+inline uint16_t bgzfUnpackUint16(const char * buf) {
+	const unsigned char * b = reinterpret_cast<const unsigned char *>(buf);
+	return static_cast<uint16_t>(b[0] | (b[1] << 8));
+}
+
+inline uint32_t bgzfUnpackUint32(const char * buf) {
+	const unsigned char * b = reinterpret_cast<const unsigned char *>(buf);
+	return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8)
+			| (static_cast<uint32_t>(b[2]) << 16) | (static_cast<uint32_t>(b[3]) << 24);
+}
+
+inline void bgzfPackUint16(char * buf, uint16_t val) {
+	buf[0] = static_cast<char>(val & 0xff);
+	buf[1] = static_cast<char>(val >> 8);
+}
+
+inline void bgzfPackUint32(char * buf, uint32_t val) {
+	for (uint32_t pos = 0; pos < 4; ++pos) {
+		buf[pos] = static_cast<char>((val >> (8 * pos)) & 0xff);
+	}
+}
+
+/**@brief Create a virtual offset from a compressed block address and an offset within the uncompressed block
+ *
+ * @param blockAddress the position in the compressed file of the start of the block
+ * @param withinBlock the offset within the uncompressed block data
+ * @return the virtual offset
+ */
+inline uint64_t bgzfMakeVirtualOffset(uint64_t blockAddress, uint16_t withinBlock) {
+	return (blockAddress << 16) | withinBlock;
+}
+
+inline uint64_t bgzfVirtualOffsetBlockAddress(uint64_t virtualOffset) {
+	return virtualOffset >> 16;
+}
+
+inline uint16_t bgzfVirtualOffsetWithinBlock(uint64_t virtualOffset) {
+	return static_cast<uint16_t>(virtualOffset & 0xffff);
+}
+
+/**@brief Compress up to bgzfMaxBlockDataSize bytes into a complete BGZF block
+ *
+ * @param data the data to compress
+ * @param len the number of bytes, must not be more than bgzfMaxBlockDataSize
+ * @param out the block, will be overwritten
+ * @param level the compression level, see zlib
+ */
+inline void bgzfCompressBlock(const char * data, size_t len, std::string & out,
+		int level = Z_DEFAULT_COMPRESSION) {
+	if (len > bgzfMaxBlockDataSize) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error " << len << " is larger than the max block data size of " << bgzfMaxBlockDataSize << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+	out.resize(bgzfMaxBlockSize);
+	for (const int currentLevel : { level, 0 }) {
+		z_stream strm;
+		strm.zalloc = Z_NULL;
+		strm.zfree = Z_NULL;
+		strm.opaque = Z_NULL;
+		//negative window bits for raw deflate, the gzip header and footer are written here
+		if (Z_OK != deflateInit2(&strm, currentLevel, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY)) {
+			throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error in initializing deflate" };
+		}
+		strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+		strm.avail_in = len;
+		strm.next_out = reinterpret_cast<Bytef *>(&out[bgzfBlockHeaderLength]);
+		strm.avail_out = bgzfMaxBlockSize - bgzfBlockHeaderLength - bgzfBlockFooterLength;
+		int status = deflate(&strm, Z_FINISH);
+		uint32_t compressedLen = strm.total_out;
+		deflateEnd(&strm);
+		if (Z_STREAM_END != status) {
+			//didn't fit, data must be incompressible, store it instead
+			continue;
+		}
+		uint32_t blockSize = bgzfBlockHeaderLength + compressedLen + bgzfBlockFooterLength;
+		memcpy(&out[0], bgzfEofBlock, bgzfBlockHeaderLength);
+		bgzfPackUint16(&out[16], static_cast<uint16_t>(blockSize - 1));
+		bgzfPackUint32(&out[bgzfBlockHeaderLength + compressedLen],
+				crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(data), len));
+		bgzfPackUint32(&out[bgzfBlockHeaderLength + compressedLen + 4], len);
+		out.resize(blockSize);
+		return;
+	}
+	throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error in compressing block" };
+}
+
+/**@brief Get the total size of the BGZF block from its header
+ *
+ * @param header at least bgzfBlockHeaderLength bytes of the start of the block
+ * @param headerLen the number of bytes available in header
+ * @return the size of the whole block, or 0 if this isn't a BGZF block header
+ */
+inline uint32_t bgzfBlockSizeFromHeader(const char * header, size_t headerLen) {
+	const unsigned char * h = reinterpret_cast<const unsigned char *>(header);
+	if (headerLen < 12 || h[0] != 0x1f || h[1] != 0x8b || h[2] != 0x08 || !(h[3] & 0x04)) {
+		return 0;
+	}
+	uint16_t xlen = bgzfUnpackUint16(header + 10);
+	//look through the extra subfields for BC
+	size_t pos = 12;
+	while (pos + 4 <= std::min<size_t>(12 + xlen, headerLen)) {
+		uint16_t slen = bgzfUnpackUint16(header + pos + 2);
+		if ('B' == header[pos] && 'C' == header[pos + 1] && 2 == slen && pos + 6 <= headerLen) {
+			return bgzfUnpackUint16(header + pos + 4) + 1;
+		}
+		pos += 4 + slen;
+	}
+	return 0;
+}
+
+/**@brief Inflate a whole BGZF block, checks the crc32 and the uncompressed size
+ *
+ * @param block the compressed block, including header and footer
+ * @param blockSize the size of the whole block
+ * @param out where to put the uncompressed data, will be overwritten
+ */
+inline void bgzfInflateBlock(const char * block, size_t blockSize, std::vector<char> & out) {
+	if (blockSize < bgzfBlockHeaderLength + bgzfBlockFooterLength) {
+		throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error block too small" };
+	}
+	uint16_t xlen = bgzfUnpackUint16(block + 10);
+	size_t dataStart = 12 + xlen;
+	if (dataStart + bgzfBlockFooterLength > blockSize) {
+		throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error extra field runs past the end of the block" };
+	}
+	uint32_t expectedCrc = bgzfUnpackUint32(block + blockSize - 8);
+	uint32_t expectedLen = bgzfUnpackUint32(block + blockSize - 4);
+	if (expectedLen > bgzfMaxBlockSize) {
+		throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error uncompressed size of "
+				+ std::to_string(expectedLen) + " is larger than the max block size of " + std::to_string(bgzfMaxBlockSize) };
+	}
+	out.resize(expectedLen);
+	if (0 == expectedLen) {
+		return;
+	}
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+	strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(block + dataStart));
+	strm.avail_in = blockSize - dataStart - bgzfBlockFooterLength;
+	if (Z_OK != inflateInit2(&strm, -15)) {
+		throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error in initializing inflate" };
+	}
+	strm.next_out = reinterpret_cast<Bytef *>(out.data());
+	strm.avail_out = expectedLen;
+	int status = inflate(&strm, Z_FINISH);
+	uint32_t inflatedLen = strm.total_out;
+	inflateEnd(&strm);
+	if (Z_STREAM_END != status || inflatedLen != expectedLen) {
+		throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error in inflating block" };
+	}
+	if (expectedCrc != crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(out.data()), expectedLen)) {
+		throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error crc32 mismatch for block" };
+	}
+}
+
+/**@brief Read the next whole compressed block from a BGZF file
+ *
+ * @param in the stream to read from, should be at the start of a block
+ * @param block where to store the block, will be overwritten
+ * @return false if at the end of the file, throws if what's read isn't a BGZF block
+ */
+inline bool bgzfReadRawBlock(std::istream & in, std::string & block) {
+	block.resize(bgzfBlockHeaderLength);
+	in.read(&block[0], bgzfBlockHeaderLength);
+	if (0 == in.gcount()) {
+		return false;
+	}
+	uint32_t blockSize = bgzfBlockSizeFromHeader(block.data(), in.gcount());
+	if (0 == blockSize || blockSize < bgzfBlockHeaderLength + bgzfBlockFooterLength) {
+		throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error, not a BGZF block" };
+	}
+	block.resize(blockSize);
+	in.read(&block[bgzfBlockHeaderLength], blockSize - bgzfBlockHeaderLength);
+	if (static_cast<std::streamsize>(blockSize - bgzfBlockHeaderLength) != in.gcount()) {
+		throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error, truncated BGZF block" };
+	}
+	return true;
+}
+
+/**@brief Check if a file starts with a BGZF block
+ *
+ * @param fnp the file to check
+ * @return true if the file is BGZF compressed
+ */
+inline bool isBgzfFile(const bfs::path & fnp) {
+	std::ifstream in(fnp.string(), std::ios::binary);
+	if (!in) {
+		return false;
+	}
+	char header[bgzfBlockHeaderLength];
+	in.read(header, bgzfBlockHeaderLength);
+	return 0 != bgzfBlockSizeFromHeader(header, in.gcount());
+}
+
+/**@brief The block index of a BGZF file, compatible with the .gzi index written by bgzip/htslib
+ *
+ * Each entry maps the compressed address of a block to the uncompressed position of the block's first byte
+ */
+class BgzfIndex {
+public:
+	struct Entry {
+		uint64_t compressedOffset_;
+		uint64_t uncompressedOffset_;
+	};
+
+	std::vector<Entry> entries_; /**< entries sorted by position, the first block at (0,0) is always included*/
+
+	BgzfIndex() :
+			entries_ { Entry { 0, 0 } } {
+	}
+
+	/**@brief Build the index by walking the block headers of a BGZF file, only the headers and footers are read, nothing is inflated
+	 *
+	 * @param fnp the BGZF file
+	 * @return the index
+	 */
+	static BgzfIndex build(const bfs::path & fnp) {
+		std::ifstream in(fnp.string(), std::ios::binary);
+		if (!in) {
+			throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error in opening " + fnp.string() };
+		}
+		BgzfIndex ret;
+		ret.entries_.clear();
+		uint64_t compressedOffset = 0;
+		uint64_t uncompressedOffset = 0;
+		char header[bgzfBlockHeaderLength];
+		while (in.read(header, bgzfBlockHeaderLength)) {
+			uint32_t blockSize = bgzfBlockSizeFromHeader(header, bgzfBlockHeaderLength);
+			if (0 == blockSize || blockSize < bgzfBlockHeaderLength + bgzfBlockFooterLength) {
+				throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error, not a BGZF file " + fnp.string() };
+			}
+			char isize[4];
+			in.seekg(compressedOffset + blockSize - 4);
+			in.read(isize, 4);
+			if (!in) {
+				throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error, truncated BGZF file " + fnp.string() };
+			}
+			uint32_t dataSize = bgzfUnpackUint32(isize);
+			if (dataSize > 0) {
+				ret.entries_.emplace_back(Entry { compressedOffset, uncompressedOffset });
+			}
+			compressedOffset += blockSize;
+			uncompressedOffset += dataSize;
+		}
+		if (ret.entries_.empty() || 0 != ret.entries_.front().compressedOffset_) {
+			ret.entries_.insert(ret.entries_.begin(), Entry { 0, 0 });
+		}
+		return ret;
+	}
+
+	/**@brief Read a .gzi index, little endian uint64 number of entries followed by pairs of compressed and uncompressed offsets
+	 *
+	 * @param fnp the index file
+	 * @return the index
+	 */
+	static BgzfIndex readGzi(const bfs::path & fnp) {
+		std::ifstream in(fnp.string(), std::ios::binary);
+		if (!in) {
+			throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error in opening " + fnp.string() };
+		}
+		BgzfIndex ret;
+		uint64_t numEntries = readUint64(in);
+		for (uint64_t pos = 0; pos < numEntries; ++pos) {
+			uint64_t compressedOffset = readUint64(in);
+			uint64_t uncompressedOffset = readUint64(in);
+			if (!in) {
+				throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error, truncated index " + fnp.string() };
+			}
+			ret.entries_.emplace_back(Entry { compressedOffset, uncompressedOffset });
+		}
+		return ret;
+	}
+
+	/**@brief Write out in the .gzi format, the implicit first block at (0,0) is not written
+	 *
+	 * @param fnp the file to write to, will be overwritten
+	 */
+	void writeGzi(const bfs::path & fnp) const {
+		std::ofstream out(fnp.string(), std::ios::binary);
+		if (!out) {
+			throw std::runtime_error { std::string(__PRETTY_FUNCTION__) + ", error in opening " + fnp.string() };
+		}
+		writeUint64(out, entries_.size() - 1);
+		for (const auto & entry : entries_) {
+			if (0 == entry.compressedOffset_ && 0 == entry.uncompressedOffset_) {
+				continue;
+			}
+			writeUint64(out, entry.compressedOffset_);
+			writeUint64(out, entry.uncompressedOffset_);
+		}
+	}
+
+	/**@brief Get the virtual offset for a position in the uncompressed data
+	 *
+	 * @param uncompressedPos the position in the uncompressed data
+	 * @return the virtual offset to seek to
+	 */
+	uint64_t virtualOffset(uint64_t uncompressedPos) const {
+		auto after = std::upper_bound(entries_.begin(), entries_.end(), uncompressedPos,
+				[](uint64_t pos, const Entry & entry) {
+					return pos < entry.uncompressedOffset_;
+				});
+		const Entry & containing = *(after - 1);
+		const uint64_t withinBlock = uncompressedPos - containing.uncompressedOffset_;
+		if (withinBlock > std::numeric_limits<uint16_t>::max()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error position " << uncompressedPos << " is " << withinBlock
+					<< " bytes into the block at " << containing.compressedOffset_
+					<< ", more than a virtual offset can hold, the index doesn't cover this position" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		return bgzfMakeVirtualOffset(containing.compressedOffset_, static_cast<uint16_t>(withinBlock));
+	}
+
+private:
+	static uint64_t readUint64(std::istream & in) {
+		char buf[8] = { 0 };
+		in.read(buf, 8);
+		return static_cast<uint64_t>(bgzfUnpackUint32(buf))
+				| (static_cast<uint64_t>(bgzfUnpackUint32(buf + 4)) << 32);
+	}
+
+	static void writeUint64(std::ostream & out, uint64_t val) {
+		char buf[8];
+		bgzfPackUint32(buf, static_cast<uint32_t>(val & 0xffffffff));
+		bgzfPackUint32(buf + 4, static_cast<uint32_t>(val >> 32));
+		out.write(buf, 8);
+	}
+};
+
+// ----------------------------------------------------------------------------
+// Internal classes to implement bgzfstream. See below for user classes.
+// ----------------------------------------------------------------------------
+
+/**@brief Reading streambuf for BGZF files, seekpos/seekoff take and tellg gives virtual offsets
+ *
+ */
+class ibgzfstreambuf: public std::streambuf {
+	struct Block {
+		uint64_t address_; /**< compressed position of the block*/
+		std::string raw_;
+		std::vector<char> data_;
+	};
+	uint32_t numThreads_ = 1; /**< number of threads to inflate blocks with*/
+	uint32_t blocksPerThread_ = 8; /**< number of blocks to inflate per thread in each batch*/
+	std::ifstream file_;
+	uint64_t nextAddress_ = 0; /**< compressed position of the next block to be read*/
+	std::deque<Block> inflated_; /**< inflated blocks waiting to be read*/
+	Block current_;
+	bool opened_ = false;
+
+	/**@brief Read and inflate the next batch of blocks, in parallel when numThreads_ > 1
+	 *
+	 * @return whether any blocks were read
+	 */
+	bool fillBatch() {
+		std::vector<Block> batch(std::max<uint32_t>(1, numThreads_ * blocksPerThread_));
+		size_t numRead = 0;
+		for (auto & block : batch) {
+			block.address_ = nextAddress_;
+			if (!bgzfReadRawBlock(file_, block.raw_)) {
+				break;
+			}
+			nextAddress_ += block.raw_.size();
+			++numRead;
+		}
+		file_.clear();
+		batch.resize(numRead);
+		std::atomic<size_t> next { 0 };
+		std::function<void()> inflateBlocks = [&batch, &next]() {
+			for (size_t pos = next.fetch_add(1); pos < batch.size(); pos = next.fetch_add(1)) {
+				bgzfInflateBlock(batch[pos].raw_.data(), batch[pos].raw_.size(), batch[pos].data_);
+				batch[pos].raw_.clear();
+			}
+		};
+		concurrent::runVoidFunctionPooled(inflateBlocks, std::min<size_t>(numThreads_, batch.size()));
+		for (auto & block : batch) {
+			inflated_.emplace_back(std::move(block));
+		}
+		return numRead > 0;
+	}
+
+	/**@brief Move to the next non-empty block
+	 *
+	 * @return false if at the end of the file
+	 */
+	bool nextBlock() {
+		while (true) {
+			if (inflated_.empty() && !fillBatch()) {
+				return false;
+			}
+			current_ = std::move(inflated_.front());
+			inflated_.pop_front();
+			if (!current_.data_.empty()) {
+				setg(current_.data_.data(), current_.data_.data(), current_.data_.data() + current_.data_.size());
+				return true;
+			}
+		}
+	}
+
+public:
+	ibgzfstreambuf() {
+		setg(nullptr, nullptr, nullptr);
+	}
+
+	/**@brief Set the number of threads used to inflate blocks, must be called before open()
+	 *
+	 * @param numThreads the number of threads, a minimum of 1
+	 * @return whether the number was set, false if the stream is already open
+	 */
+	bool setNumThreads(uint32_t numThreads) {
+		if (is_open()) {
+			return false;
+		}
+		numThreads_ = std::max<uint32_t>(1, numThreads);
+		return true;
+	}
+
+	int is_open() const {
+		return opened_;
+	}
+
+	ibgzfstreambuf* open(const char* name, int open_mode) {
+		if (is_open() || !(open_mode & std::ios::in) || (open_mode & std::ios::out)) {
+			return (ibgzfstreambuf*) 0;
+		}
+		file_.open(name, std::ios::in | std::ios::binary);
+		if (!file_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << " in opening " << name << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		if (!isBgzfFile(name)) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << name << " is not BGZF compressed" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		nextAddress_ = 0;
+		inflated_.clear();
+		current_ = Block { 0, "", { } };
+		setg(nullptr, nullptr, nullptr);
+		opened_ = true;
+		return this;
+	}
+
+	ibgzfstreambuf * close() {
+		if (!is_open()) {
+			return (ibgzfstreambuf*) 0;
+		}
+		file_.close();
+		inflated_.clear();
+		current_ = Block { 0, "", { } };
+		setg(nullptr, nullptr, nullptr);
+		opened_ = false;
+		return this;
+	}
+
+	/**@brief The virtual offset of the next character to be read
+	 *
+	 */
+	uint64_t tellVirtual() const {
+		if (nullptr == gptr()) {
+			return bgzfMakeVirtualOffset(nextAddress_, 0);
+		}
+		return bgzfMakeVirtualOffset(current_.address_, static_cast<uint16_t>(gptr() - eback()));
+	}
+
+	/**@brief Seek to a virtual offset
+	 *
+	 * @param virtualOffset the virtual offset, likely from tellVirtual() or BgzfIndex::virtualOffset()
+	 * @return whether the seek was successful
+	 */
+	bool seekVirtual(uint64_t virtualOffset) {
+		if (!is_open()) {
+			return false;
+		}
+		uint64_t address = bgzfVirtualOffsetBlockAddress(virtualOffset);
+		uint16_t withinBlock = bgzfVirtualOffsetWithinBlock(virtualOffset);
+		inflated_.clear();
+		setg(nullptr, nullptr, nullptr);
+		file_.clear();
+		file_.seekg(address);
+		if (!file_) {
+			return false;
+		}
+		current_ = Block { address, "", { } };
+		if (!bgzfReadRawBlock(file_, current_.raw_)) {
+			file_.clear();
+			nextAddress_ = address;
+			return 0 == withinBlock;
+		}
+		nextAddress_ = address + current_.raw_.size();
+		bgzfInflateBlock(current_.raw_.data(), current_.raw_.size(), current_.data_);
+		current_.raw_.clear();
+		if (withinBlock > current_.data_.size()) {
+			return false;
+		}
+		setg(current_.data_.data(), current_.data_.data() + withinBlock, current_.data_.data() + current_.data_.size());
+		return true;
+	}
+
+	/**@brief Seek to a position in the uncompressed data using a block index
+	 *
+	 * @param uncompressedPos the position in the uncompressed data
+	 * @param index the index for this file
+	 * @return whether the seek was successful
+	 */
+	bool seekUncompressed(uint64_t uncompressedPos, const BgzfIndex & index) {
+		return seekVirtual(index.virtualOffset(uncompressedPos));
+	}
+
+	virtual int underflow() {
+		if (gptr() && (gptr() < egptr())) {
+			return *reinterpret_cast<unsigned char *>(gptr());
+		}
+		if (!opened_ || !nextBlock()) {
+			return EOF;
+		}
+		return *reinterpret_cast<unsigned char *>(gptr());
+	}
+
+	virtual std::streampos seekpos(std::streampos pos,
+			std::ios_base::openmode which = std::ios_base::in) {
+		if (!(which & std::ios_base::in) || !seekVirtual(static_cast<uint64_t>(pos))) {
+			return std::streampos(std::streamoff(-1));
+		}
+		return pos;
+	}
+
+	virtual std::streampos seekoff(std::streamoff off, std::ios_base::seekdir dir,
+			std::ios_base::openmode which = std::ios_base::in) {
+		// only reporting the current position is supported, virtual offsets can't be added to
+		if (!(which & std::ios_base::in) || std::ios_base::cur != dir || 0 != off || !is_open()) {
+			return std::streampos(std::streamoff(-1));
+		}
+		return std::streampos(static_cast<std::streamoff>(tellVirtual()));
+	}
+};
+
+/**@brief Writing streambuf for BGZF files, blocks are deflated in batches across numThreads_
+ *
+ */
+class obgzfstreambuf: public std::streambuf {
+	uint32_t numThreads_ = 1;
+	uint32_t blocksPerThread_ = 8;
+	int level_ = Z_DEFAULT_COMPRESSION;
+	bool writeIndex_ = false; /**< whether to write a .gzi index next to the file on close*/
+	std::string name_;
+	std::ofstream file_;
+	std::vector<char> buffer_;
+	BgzfIndex index_;
+	uint64_t compressedOffset_ = 0;
+	uint64_t uncompressedOffset_ = 0;
+	bool opened_ = false;
+	bool failed_ = false;
+
+	bool flushBlocks() {
+		size_t len = pptr() - pbase();
+		if (0 == len) {
+			return !failed_;
+		}
+		size_t numBlocks = (len + bgzfMaxBlockDataSize - 1) / bgzfMaxBlockDataSize;
+		std::vector<std::string> blocks(numBlocks);
+		const char * data = pbase();
+		try {
+			std::atomic<size_t> next { 0 };
+			std::function<void()> compressBlocks = [&]() {
+				for (size_t pos = next.fetch_add(1); pos < numBlocks; pos = next.fetch_add(1)) {
+					size_t start = pos * bgzfMaxBlockDataSize;
+					bgzfCompressBlock(data + start, std::min<size_t>(bgzfMaxBlockDataSize, len - start), blocks[pos], level_);
+				}
+			};
+			concurrent::runVoidFunctionPooled(compressBlocks, std::min<size_t>(numThreads_, numBlocks));
+		} catch (std::exception & e) {
+			failed_ = true;
+			return false;
+		}
+		for (size_t pos = 0; pos < numBlocks; ++pos) {
+			if (0 != compressedOffset_) {
+				index_.entries_.emplace_back(BgzfIndex::Entry { compressedOffset_, uncompressedOffset_ });
+			}
+			file_.write(blocks[pos].data(), blocks[pos].size());
+			compressedOffset_ += blocks[pos].size();
+			uncompressedOffset_ += std::min<size_t>(bgzfMaxBlockDataSize, len - pos * bgzfMaxBlockDataSize);
+		}
+		if (!file_) {
+			failed_ = true;
+		}
+		setp(buffer_.data(), buffer_.data() + (buffer_.size() - 1));
+		return !failed_;
+	}
+
+public:
+	obgzfstreambuf() {
+		setp(nullptr, nullptr);
+	}
+
+	~obgzfstreambuf() {
+		close();
+	}
+
+	/**@brief Set the number of threads used to deflate blocks, must be called before open()
+	 *
+	 * @param numThreads the number of threads, a minimum of 1
+	 * @return whether the number was set, false if the stream is already open
+	 */
+	bool setNumThreads(uint32_t numThreads) {
+		if (is_open()) {
+			return false;
+		}
+		numThreads_ = std::max<uint32_t>(1, numThreads);
+		return true;
+	}
+
+	/**@brief Set the zlib compression level, must be called before open()
+	 *
+	 * @param level the compression level, -1 (default) or 0-9
+	 * @return whether the level was set, false if the stream is already open
+	 */
+	bool setLevel(int level) {
+		if (is_open()) {
+			return false;
+		}
+		level_ = level;
+		return true;
+	}
+
+	/**@brief Set whether to write a .gzi index (named the file name + .gzi) when closing, must be called before open()
+	 *
+	 * @param writeIndex whether to write the index
+	 * @return whether this was set, false if the stream is already open
+	 */
+	bool setWriteIndex(bool writeIndex) {
+		if (is_open()) {
+			return false;
+		}
+		writeIndex_ = writeIndex;
+		return true;
+	}
+
+	/**@brief The index of the blocks written so far
+	 *
+	 */
+	const BgzfIndex & index() const {
+		return index_;
+	}
+
+	int is_open() const {
+		return opened_;
+	}
+
+	obgzfstreambuf* open(const char* name, int open_mode) {
+		if (is_open() || (open_mode & std::ios::in)) {
+			return (obgzfstreambuf*) 0;
+		}
+		//appending would require removing the previous end of file block and re-indexing, not supported
+		if ((open_mode & std::ios::ate) || (open_mode & std::ios::app)) {
+			return (obgzfstreambuf*) 0;
+		}
+		name_ = name;
+		file_.open(name, std::ios::out | std::ios::binary);
+		if (!file_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << " in opening " << name << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		buffer_.resize(static_cast<size_t>(bgzfMaxBlockDataSize) * numThreads_ * blocksPerThread_ + 1);
+		setp(buffer_.data(), buffer_.data() + (buffer_.size() - 1));
+		index_ = BgzfIndex();
+		compressedOffset_ = 0;
+		uncompressedOffset_ = 0;
+		failed_ = false;
+		opened_ = true;
+		return this;
+	}
+
+	obgzfstreambuf * close() {
+		if (!is_open()) {
+			return (obgzfstreambuf*) 0;
+		}
+		flushBlocks();
+		file_.write(reinterpret_cast<const char *>(bgzfEofBlock), sizeof(bgzfEofBlock));
+		file_.close();
+		if (file_.fail()) {
+			failed_ = true;
+		}
+		opened_ = false;
+		setp(nullptr, nullptr);
+		if (writeIndex_ && !failed_) {
+			try {
+				index_.writeGzi(name_ + ".gzi");
+			} catch (std::exception & e) {
+				failed_ = true;
+			}
+		}
+		return failed_ ? (obgzfstreambuf*) 0 : this;
+	}
+
+	virtual int overflow(int c = EOF) {
+		if (!opened_) {
+			return EOF;
+		}
+		if (c != EOF) {
+			*pptr() = c;
+			pbump(1);
+		}
+		if (!flushBlocks()) {
+			return EOF;
+		}
+		return traits_type::not_eof(c);
+	}
+
+	virtual int sync() {
+		// only whole batches are compressed until close(), flushing (e.g. std::endl)
+		// would otherwise create many tiny blocks
+		return failed_ ? -1 : 0;
+	}
+};
+
+// ----------------------------------------------------------------------------
+// User classes. Use ibgzfstream and obgzfstream analogously to igzstream and
+// ogzstream. ibgzfstream::seekg()/tellg() work with virtual offsets.
+// ----------------------------------------------------------------------------
+
+// The buffers are held by a virtual base of std::ios, as gzstreambase does, so
+// they're constructed before std::istream/std::ostream are handed a pointer to them.
+
+class ibgzfstreambase: virtual public std::ios {
+protected:
+	ibgzfstreambuf buf;
+public:
+	ibgzfstreambase() {
+		init(&buf);
+	}
+	~ibgzfstreambase() {
+		buf.close();
+	}
+};
+
+class obgzfstreambase: virtual public std::ios {
+protected:
+	obgzfstreambuf buf;
+public:
+	obgzfstreambase() {
+		init(&buf);
+	}
+	~obgzfstreambase() {
+		buf.close();
+	}
+};
+
+class ibgzfstream: public ibgzfstreambase, public std::istream {
+public:
+	ibgzfstream() :
+			std::istream(&buf) {
+	}
+	explicit ibgzfstream(const bfs::path & name, uint32_t numThreads = 1) :
+			std::istream(&buf) {
+		buf.setNumThreads(numThreads);
+		open(name);
+	}
+	ibgzfstreambuf* rdbuf() {
+		return &buf;
+	}
+	void open(const bfs::path & name, int open_mode = std::ios::in) {
+		if (!buf.open(name.string().c_str(), open_mode)) {
+			clear(rdstate() | std::ios::badbit);
+		}
+	}
+	void close() {
+		if (buf.is_open()) {
+			if (!buf.close()) {
+				clear(rdstate() | std::ios::badbit);
+			}
+		}
+	}
+	/**@brief Seek to a position in the uncompressed data using a block index, clears eof
+	 *
+	 * @param uncompressedPos the position in the uncompressed data
+	 * @param index the index for this file
+	 * @return the stream
+	 */
+	ibgzfstream & seekUncompressed(uint64_t uncompressedPos, const BgzfIndex & index) {
+		clear(rdstate() & ~std::ios::eofbit);
+		if (!buf.seekUncompressed(uncompressedPos, index)) {
+			clear(rdstate() | std::ios::failbit);
+		}
+		return *this;
+	}
+};
+
+class obgzfstream: public obgzfstreambase, public std::ostream {
+public:
+	obgzfstream() :
+			std::ostream(&buf) {
+	}
+	explicit obgzfstream(const bfs::path & name, uint32_t numThreads = 1,
+			bool writeIndex = false) :
+			std::ostream(&buf) {
+		buf.setNumThreads(numThreads);
+		buf.setWriteIndex(writeIndex);
+		open(name);
+	}
+	obgzfstreambuf* rdbuf() {
+		return &buf;
+	}
+	void open(const bfs::path & name, int open_mode = std::ios::out) {
+		if (!buf.open(name.string().c_str(), open_mode)) {
+			clear(rdstate() | std::ios::badbit);
+		}
+	}
+	void close() {
+		if (buf.is_open()) {
+			if (!buf.close()) {
+				clear(rdstate() | std::ios::badbit);
+			}
+		}
+	}
+};
+
+}  // namespace GZSTREAM
+}  // namespace njh
+
@@ -8,7 +8,9 @@
 
 #include <zlib.h>
 #include <string>
-#include <array>
+#include <string_view>
+#include <algorithm>
+#include <fstream>
 #include <cstdint>
 
 
@@ -25,10 +27,36 @@ class gzTextFileCpp {
 	gzFile file_; /**< a gzFile object*/
 	const static uint32_t bufferSize_ = BUFFER; /**< buffer size of the reading in from gz ziped file in chars*/
 	const uint32_t byteBufferSize_ = bufferSize_ * sizeof(char); /**< the calculated buffer size in bytes*/
-	std::array<char, bufferSize_> charData_; /**< the data array to hold current data*/
-	std::string buf_; /**< the string buffer*/
+	std::string buf_; /**< the string buffer, reused for the whole file, data before pos_ has already been handed out*/
+	size_t pos_ = 0; /**< the position of the first char in buf_ that hasn't been consumed yet*/
+	size_t searchFrom_ = 0; /**< where to resume looking for the terminator so data already searched isn't searched again*/
 	std::string filename_; /**< the filename to be read*/
 	std::string terminator_; /**< the line terminator*/
+
+	/**@brief Drop the consumed data from the front of the buffer and read the next chunk onto the end of it
+	 *
+	 * @return Whether any data was read
+	 */
+	bool fillBuffer() {
+		if (gzeof(file_)) {
+			return false;
+		}
+		if (pos_ > 0) {
+			buf_.erase(0, pos_);
+			searchFrom_ -= std::min(searchFrom_, pos_);
+			pos_ = 0;
+		}
+		const size_t oldSize = buf_.size();
+		buf_.resize(oldSize + byteBufferSize_);
+		int bytes_read = gzread(file_, &buf_[oldSize], byteBufferSize_);
+		buf_.resize(oldSize + std::max(bytes_read, 0));
+		return bytes_read > 0;
+	}
+
+	bool bufferEmpty() const {
+		return pos_ >= buf_.size();
+	}
+
 public:
 	/**@brief Construct with the filename and the terminator for the file
 	 *
@@ -52,12 +80,15 @@ public:
 					+ ":couldn't set gz buffer" };
 		}
 #endif
+		buf_.reserve(2 * byteBufferSize_);
 	}
 
 
 	/**@brief Read in the next chunk of data and decompress from the file
 	 *
-	 * @param chunk store the next block of data in this string
+	 * This reads straight from the file, data already buffered by getline() or peek() is not returned
+	 *
+	 * @param chunk store the next block of data in this string, its capacity is reused
 	 * @return Whether data larger than at least one char was read from the file
 	 * @todo might want to throw or report if bytes were read but were less than a char
 	 */
@@ -67,46 +98,58 @@ public:
 		if (gzeof(file_)) {
 			return false;
 		}
-		int bytes_read = gzread(file_, charData_.data(), byteBufferSize_);
-		if (bytes_read >= sizeof(char)) {
-			chunk = std::string(std::begin(charData_),
-					std::begin(charData_) + bytes_read / sizeof(char));
+		chunk.resize(byteBufferSize_);
+		int bytes_read = gzread(file_, &chunk[0], byteBufferSize_);
+		if (bytes_read >= static_cast<int>(sizeof(char))) {
+			chunk.resize(bytes_read / sizeof(char));
 			return true;
 		}
+		chunk.clear();
 		return false;
 	}
-	/**@brief getline on newline
+
+	/**@brief getline on the terminator without copying, the line points into the internal buffer
 	 *
-	 * @param line store next line info in this string
+	 * @param line set to the next line, only valid until the next call to getline(), peek() or done()
 	 * @return if a next line was read
 	 */
-	bool getline(std::string & line) {
-		//first clear the contents of std::string & line in case nothing is read
-		line.clear();
-		if (buf_.empty() && gzeof(file_)) {
-			return false;
-		}
+	bool getline(std::string_view & line) {
+		line = std::string_view();
 		//add to buffer until the end of the file or until the terminator is found
-		std::string temp = "";
-		while (buf_.find(terminator_) == std::string::npos && getNextChunk(temp)) {
-			buf_.append(temp);
-		}
-		//if the buffer is not empty, trim from it the data up to the terminator
-		if (!buf_.empty()) {
-			//find terminator position and set line equal to the buffer from the beginning to the terminator
-			//works for empty lines since .substr(0,0) returns an empty string
-			//works for when the end of the file is reached and there is no terminator at the end
-			//since .substr(0,std::string::npos) return the whole string
-			auto termPos = buf_.find(terminator_);
-			line = buf_.substr(0, termPos);
-			if (termPos != std::string::npos && termPos + terminator_.size() < buf_.size()) {
-				buf_ = buf_.substr(termPos + terminator_.size());
-			} else {
-				buf_ = "";
+		size_t termPos = buf_.find(terminator_, searchFrom_);
+		while (std::string::npos == termPos) {
+			//the terminator could be split across the end of the current data and the next chunk
+			searchFrom_ = std::max(pos_, buf_.size() - std::min(buf_.size(), terminator_.size() - 1));
+			if (!fillBuffer()) {
+				break;
 			}
-			return true;
+			termPos = buf_.find(terminator_, searchFrom_);
 		}
-		return false;
+		if (bufferEmpty()) {
+			return false;
+		}
+		//works for empty lines and for when the end of the file is reached and there is no terminator at the end
+		if (std::string::npos == termPos) {
+			line = std::string_view(buf_.data() + pos_, buf_.size() - pos_);
+			pos_ = buf_.size();
+		} else {
+			line = std::string_view(buf_.data() + pos_, termPos - pos_);
+			pos_ = termPos + terminator_.size();
+		}
+		searchFrom_ = pos_;
+		return true;
+	}
+
+	/**@brief getline on newline
+	 *
+	 * @param line store next line info in this string
+	 * @return if a next line was read
+	 */
+	bool getline(std::string & line) {
+		std::string_view view;
+		bool ret = getline(view);
+		line.assign(view.data(), view.size());
+		return ret;
 	}
 	/**@brief A bool check on the underlying gzfile, should be used to see if file was opened
 	 *
@@ -120,13 +163,10 @@ public:
 	 * @return Whether there is anything else to be read
 	 */
 	bool done() {
-		if("" == buf_ && !gzeof(file_)){
-			std::string temp = "";
-			if (getNextChunk(temp)) {
-				buf_.append(temp);
-			}
+		if (bufferEmpty() && !gzeof(file_)) {
+			fillBuffer();
 		}
-		return "" == buf_ && gzeof(file_);
+		return bufferEmpty() && gzeof(file_);
 	}
 
 	/**@brief when the file is de-constructed, close the underlying gzfile
@@ -142,16 +182,13 @@ public:
 	 * @return
 	 */
 	int peek() {
-		if (buf_.empty()) {
-			std::string temp = "";
-			if (getNextChunk(temp)) {
-				buf_.append(temp);
-			}
+		if (bufferEmpty()) {
+			fillBuffer();
 		}
-		if ("" == buf_ && gzeof(file_)) {
+		if (bufferEmpty() && gzeof(file_)) {
 			return std::ifstream::eofbit;
 		}
-		return buf_.front();
+		return buf_[pos_];
 	}
 };
 
@@ -30,8 +30,16 @@
 // standard C++ with new header file names and std:: namespace
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <zlib.h>
 #include <string>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <boost/filesystem.hpp>
 
 namespace njh {
@@ -44,15 +52,120 @@ namespace GZSTREAM {
 // ----------------------------------------------------------------------------
 
 class gzstreambuf: public std::streambuf {
+public:
+	static const uint32_t defaultBufferSize = 128 * 1024; /**< default size of the data buffer, large enough to keep gzread/gzwrite calls infrequent*/
+	static const uint32_t putbackSize = 4; /**< number of characters kept for putback when refilling the input buffer*/
 private:
-	static const int bufferSize = 47 + 256;    // size of data buff
-	// totals 512 bytes under g++ for igzstream at the end.
+	uint32_t bufferSize_ = defaultBufferSize; // size of data buff
+	std::vector<char> buffer_; // data buffer, allocated on open() so unopened streams stay cheap
 
 	gzFile file_ = nullptr;               // file handle for compressed file
-	char buffer_[bufferSize]; // data buffer
 	char opened_;             // open/close state of stream
 	int mode_ = -1;               // I/O mode
 
+	// read-ahead mode, a background thread inflates into a ring of buffers and
+	// underflow() just swaps in the next filled one, each buffer keeps room for
+	// the putback area at its front
+	uint32_t readAheadBuffers_ = 0;  // number of buffers in the ring, 0 to inflate inline
+	std::thread readAheadThread_;
+	std::mutex readAheadMut_;
+	std::condition_variable readAheadCv_;
+	std::deque<std::vector<char>> filledBuffers_;
+	std::vector<std::vector<char>> emptyBuffers_;
+	std::vector<char> currentBuffer_;
+	bool readAheadDone_ = false;  // the inflating thread hit EOF or an error
+	bool readAheadStop_ = false;  // the stream is being closed
+
+	bool readingAhead() const {
+		return readAheadThread_.joinable();
+	}
+
+	void readAheadWorker() {
+		while (true) {
+			std::vector<char> buf;
+			{
+				std::unique_lock<std::mutex> lock(readAheadMut_);
+				readAheadCv_.wait(lock, [this]() {return !emptyBuffers_.empty() || readAheadStop_;});
+				if (readAheadStop_) {
+					return;
+				}
+				buf = std::move(emptyBuffers_.back());
+				emptyBuffers_.pop_back();
+			}
+			buf.resize(bufferSize_);
+			int num = gzread(file_, buf.data() + putbackSize, bufferSize_ - putbackSize);
+			{
+				std::lock_guard<std::mutex> lock(readAheadMut_);
+				if (num <= 0) { // ERROR or EOF
+					readAheadDone_ = true;
+				} else {
+					buf.resize(putbackSize + num);
+					filledBuffers_.emplace_back(std::move(buf));
+				}
+			}
+			readAheadCv_.notify_all();
+			if (num <= 0) {
+				return;
+			}
+		}
+	}
+
+	void startReadAhead() {
+		readAheadDone_ = false;
+		readAheadStop_ = false;
+		filledBuffers_.clear();
+		emptyBuffers_.assign(readAheadBuffers_, std::vector<char>());
+		currentBuffer_.clear();
+		readAheadThread_ = std::thread(&gzstreambuf::readAheadWorker, this);
+	}
+
+	void stopReadAhead() {
+		if (readingAhead()) {
+			{
+				std::lock_guard<std::mutex> lock(readAheadMut_);
+				readAheadStop_ = true;
+			}
+			readAheadCv_.notify_all();
+			readAheadThread_.join();
+		}
+		filledBuffers_.clear();
+		emptyBuffers_.clear();
+		currentBuffer_.clear();
+	}
+
+	int underflowReadAhead() {
+		char putback[putbackSize];
+		int n_putback = gptr() - eback();
+		if (n_putback > static_cast<int>(putbackSize)) {
+			n_putback = putbackSize;
+		}
+		if (n_putback > 0) {
+			memcpy(putback, gptr() - n_putback, n_putback);
+		}
+		{
+			std::unique_lock<std::mutex> lock(readAheadMut_);
+			if (!currentBuffer_.empty()) {
+				emptyBuffers_.emplace_back(std::move(currentBuffer_));
+				currentBuffer_.clear();
+			}
+			readAheadCv_.notify_all();
+			readAheadCv_.wait(lock, [this]() {return !filledBuffers_.empty() || readAheadDone_;});
+			if (filledBuffers_.empty()) {
+				return EOF;
+			}
+			currentBuffer_ = std::move(filledBuffers_.front());
+			filledBuffers_.pop_front();
+		}
+		char * buf = currentBuffer_.data();
+		if (n_putback > 0) {
+			memcpy(buf + (putbackSize - n_putback), putback, n_putback);
+		}
+		setg(buf + (putbackSize - n_putback),   // beginning of putback area
+		buf + putbackSize,                 // read position
+		buf + currentBuffer_.size());      // end of buffer
+		return *reinterpret_cast<unsigned char *>(gptr());
+	}
+
 	int flush_buffer() {
 		// Separate the writing of the buffer from overflow() and
 		// sync() operation.
@@ -66,12 +179,45 @@ private:
 public:
 	gzstreambuf() :
 			opened_(0) {
-		setp(buffer_, buffer_ + (bufferSize - 1));
-		setg(buffer_ + 4,     // beginning of putback area
-		buffer_ + 4,     // read position
-		buffer_ + 4);    // end position
+		setp(nullptr, nullptr);
+		setg(nullptr, nullptr, nullptr);
 		// ASSERT: both input & output capabilities will not be used together
 	}
+
+	/**@brief Set the size of the data buffer, must be called before open()
+	 *
+	 * @param bufferSize the size in bytes, will be raised to a minimum that still leaves room for the putback area
+	 * @return whether the size was set, false if the stream is already open
+	 */
+	bool setBufferSize(uint32_t bufferSize) {
+		if (is_open()) {
+			return false;
+		}
+		bufferSize_ = std::max<uint32_t>(bufferSize, putbackSize + 256);
+		return true;
+	}
+
+	uint32_t getBufferSize() const {
+		return bufferSize_;
+	}
+
+	/**@brief Turn on reading ahead for input streams, a background thread will inflate into a ring of numBuffers buffers, must be called before open()
+	 *
+	 * @param numBuffers the number of buffers of getBufferSize() bytes each to inflate ahead into, 0 (the default) turns off reading ahead
+	 * @return whether this was set, false if the stream is already open
+	 */
+	bool setReadAhead(uint32_t numBuffers) {
+		if (is_open()) {
+			return false;
+		}
+		readAheadBuffers_ = numBuffers;
+		return true;
+	}
+
+	uint32_t getReadAhead() const {
+		return readAheadBuffers_;
+	}
+
 	int is_open() {
 		return opened_;
 	}
@@ -116,7 +262,7 @@ public:
 		}
 #if ZLIB_VERNUM >= 0x1280
 		//if you couldn't set the buffer, throw
-		if (gzbuffer(file_, 128 * 1024)) {
+		if (gzbuffer(file_, std::max<uint32_t>(bufferSize_, 128 * 1024))) {
 			throw std::runtime_error { std::string(__PRETTY_FUNCTION__)
 					+ ":couldn't set gz buffer, for " + std::string(name) + " in mode " + std::string(fmode) };
 		}
@@ -125,12 +271,25 @@ public:
 			return (gzstreambuf*) 0;
 		}
 		opened_ = 1;
+		if ((mode_ & std::ios::in) && readAheadBuffers_ > 0) {
+			setp(nullptr, nullptr);
+			setg(nullptr, nullptr, nullptr);
+			startReadAhead();
+			return this;
+		}
+		buffer_.resize(bufferSize_);
+		setp(buffer_.data(), buffer_.data() + (bufferSize_ - 1));
+		setg(buffer_.data() + putbackSize,     // beginning of putback area
+		buffer_.data() + putbackSize,     // read position
+		buffer_.data() + putbackSize);    // end position
 		return this;
 	}
 
 	gzstreambuf * close() {
 		if (is_open()) {
 			sync();
+			stopReadAhead();
+			setg(nullptr, nullptr, nullptr);
 			opened_ = 0;
 			if (gzclose(file_) == Z_OK) {
 				return this;
@@ -146,21 +305,25 @@ public:
 		if (!(mode_ & std::ios::in) || !opened_) {
 			return EOF;
 		}
+		if (readingAhead()) {
+			return underflowReadAhead();
+		}
 		// Josuttis' implementation of inbuf
 		int n_putback = gptr() - eback();
-		if (n_putback > 4) {
-			n_putback = 4;
+		if (n_putback > static_cast<int>(putbackSize)) {
+			n_putback = putbackSize;
 		}
-		memcpy(buffer_ + (4 - n_putback), gptr() - n_putback, n_putback);
+		char * buf = buffer_.data();
+		memmove(buf + (putbackSize - n_putback), gptr() - n_putback, n_putback);
 
-		int num = gzread(file_, buffer_ + 4, bufferSize - 4);
+		int num = gzread(file_, buf + putbackSize, bufferSize_ - putbackSize);
 		if (num <= 0) { // ERROR or EOF
 			return EOF;
 		}
 		// reset buffer pointers
-		setg(buffer_ + (4 - n_putback),   // beginning of putback area
-		buffer_ + 4,                 // read position
-		buffer_ + 4 + num);          // end of buffer
+		setg(buf + (putbackSize - n_putback),   // beginning of putback area
+		buf + putbackSize,                 // read position
+		buf + putbackSize + num);          // end of buffer
 
 		// return next character
 		return *reinterpret_cast<unsigned char *>(gptr());
@@ -201,8 +364,10 @@ public:
 	gzstreambase() {
 		init(&buf);
 	}
-	gzstreambase(const char* name, int mode) {
+	gzstreambase(const char* name, int mode,
+			uint32_t bufferSize = gzstreambuf::defaultBufferSize) {
 		init(&buf);
+		buf.setBufferSize(bufferSize);
 		open(name, mode);
 	}
 	~gzstreambase() {
@@ -237,8 +402,9 @@ public:
 	igzstream() :
 			std::istream(&buf) {
 	}
-	igzstream(const bfs::path & name, int open_mode = std::ios::in) :
-			gzstreambase(name.string().c_str(), open_mode), std::istream(&buf) {
+	igzstream(const bfs::path & name, int open_mode = std::ios::in,
+			uint32_t bufferSize = gzstreambuf::defaultBufferSize) :
+			gzstreambase(name.string().c_str(), open_mode, bufferSize), std::istream(&buf) {
 	}
 	gzstreambuf* rdbuf() {
 		return gzstreambase::rdbuf();
@@ -253,8 +419,9 @@ public:
 	ogzstream() :
 			std::ostream(&buf) {
 	}
-	explicit ogzstream(const bfs::path & name, int mode = std::ios::out) :
-			gzstreambase(name.string().c_str(), mode), std::ostream(&buf) {
+	explicit ogzstream(const bfs::path & name, int mode = std::ios::out,
+			uint32_t bufferSize = gzstreambuf::defaultBufferSize) :
+			gzstreambase(name.string().c_str(), mode, bufferSize), std::ostream(&buf) {
 	}
 	gzstreambuf* rdbuf() {
 		return gzstreambase::rdbuf();
@@ -0,0 +1,366 @@
+#pragma once
+/*
+ * pgzstream.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Parallel gzip output stream, in the spirit of pigz. The output is cut into
+// independent blocks that are deflated on a set of worker threads and written
+// out in order as concatenated gzip members, which any gzip reader (including
+// igzstream and gzopen/gzread) will read back as a single stream.
+
+#include <iostream>
+#include <fstream>
+#include <zlib.h>
+#include <string>
+#include <sstream>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <boost/filesystem.hpp>
+
+namespace njh {
+namespace bfs = boost::filesystem;
+
+namespace GZSTREAM {
+
+/**@brief Compress a block of data into a complete gzip member
+ *
+ * @param data the start of the data to compress
+ * @param len the number of bytes to compress
+ * @param out the string to store the gzip member in, will be overwritten
+ * @param level the compression level, see zlib
+ * @return whether the compression was successful
+ */
+inline bool deflateGzMember(const char * data, size_t len, std::string & out,
+		int level = Z_DEFAULT_COMPRESSION) {
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree = Z_NULL;
+	strm.opaque = Z_NULL;
+	//window bits of 15 + 16 to write a gzip header and trailer
+	if (Z_OK != deflateInit2(&strm, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY)) {
+		return false;
+	}
+	out.resize(deflateBound(&strm, len));
+	strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data));
+	strm.avail_in = len;
+	strm.next_out = reinterpret_cast<Bytef *>(&out[0]);
+	strm.avail_out = out.size();
+	int status = deflate(&strm, Z_FINISH);
+	out.resize(strm.total_out);
+	deflateEnd(&strm);
+	return Z_STREAM_END == status;
+}
+
+// ----------------------------------------------------------------------------
+// Internal classes to implement pgzstream. See below for user classes.
+// ----------------------------------------------------------------------------
+
+class pgzstreambuf: public std::streambuf {
+public:
+	static const uint32_t defaultBlockSize = 1024 * 1024; /**< default number of uncompressed bytes per gzip member*/
+private:
+	struct Block {
+		uint64_t index_;
+		std::vector<char> data_;
+	};
+
+	uint32_t numThreads_ = 2; /**< number of compression threads*/
+	uint32_t blockSize_ = defaultBlockSize; /**< number of uncompressed bytes per block*/
+	int level_ = Z_DEFAULT_COMPRESSION; /**< compression level*/
+
+	std::ofstream file_; /**< the underlying file*/
+	std::vector<char> buffer_; /**< the block currently being filled*/
+	bool opened_ = false;
+
+	std::vector<std::thread> workers_;
+	std::mutex mut_; /**< guards the members below*/
+	std::condition_variable workCv_; /**< workers wait on this for blocks to compress*/
+	std::condition_variable spaceCv_; /**< the writing thread waits on this for room to submit another block*/
+	std::deque<Block> toCompress_;
+	std::map<uint64_t, std::string> compressed_; /**< compressed blocks waiting for their turn to be written*/
+	uint64_t nextBlock_ = 0;
+	uint64_t nextToWrite_ = 0;
+	uint32_t inFlight_ = 0; /**< blocks submitted but not yet written, bounds memory use*/
+	bool finishing_ = false;
+	bool failed_ = false;
+
+	std::mutex writeMut_; /**< only one thread writes to file_ at a time*/
+
+	uint32_t maxInFlight() const {
+		return numThreads_ * 2 + 1;
+	}
+
+	void writeReady() {
+		std::lock_guard<std::mutex> writeLock(writeMut_);
+		while (true) {
+			std::string member;
+			{
+				std::lock_guard<std::mutex> lock(mut_);
+				auto search = compressed_.find(nextToWrite_);
+				if (compressed_.end() == search) {
+					break;
+				}
+				member = std::move(search->second);
+				compressed_.erase(search);
+			}
+			file_.write(member.data(), member.size());
+			{
+				std::lock_guard<std::mutex> lock(mut_);
+				if (!file_) {
+					failed_ = true;
+				}
+				++nextToWrite_;
+				--inFlight_;
+			}
+			spaceCv_.notify_all();
+		}
+	}
+
+	void compressWorker() {
+		while (true) {
+			Block block;
+			{
+				std::unique_lock<std::mutex> lock(mut_);
+				workCv_.wait(lock, [this]() {return !toCompress_.empty() || finishing_;});
+				if (toCompress_.empty()) {
+					return;
+				}
+				block = std::move(toCompress_.front());
+				toCompress_.pop_front();
+			}
+			std::string member;
+			bool succeeded = deflateGzMember(block.data_.data(), block.data_.size(), member, level_);
+			{
+				std::lock_guard<std::mutex> lock(mut_);
+				if (!succeeded) {
+					failed_ = true;
+				}
+				compressed_.emplace(block.index_, std::move(member));
+			}
+			writeReady();
+		}
+	}
+
+	/**@brief Hand the current buffer off to the compression threads, blocking if too many blocks are already in flight
+	 *
+	 * @return whether the block was submitted
+	 */
+	bool submitBlock() {
+		std::vector<char> data(pbase(), pptr());
+		{
+			std::unique_lock<std::mutex> lock(mut_);
+			spaceCv_.wait(lock, [this]() {return inFlight_ < maxInFlight() || failed_;});
+			if (failed_) {
+				return false;
+			}
+			toCompress_.emplace_back(Block { nextBlock_, std::move(data) });
+			++nextBlock_;
+			++inFlight_;
+		}
+		workCv_.notify_one();
+		setp(buffer_.data(), buffer_.data() + (buffer_.size() - 1));
+		return true;
+	}
+
+public:
+	pgzstreambuf() {
+		setp(nullptr, nullptr);
+	}
+
+	~pgzstreambuf() {
+		close();
+	}
+
+	/**@brief Set the number of compression threads, must be called before open()
+	 *
+	 * @param numThreads the number of threads, a minimum of 1
+	 * @return whether the number was set, false if the stream is already open
+	 */
+	bool setNumThreads(uint32_t numThreads) {
+		if (is_open()) {
+			return false;
+		}
+		numThreads_ = std::max<uint32_t>(1, numThreads);
+		return true;
+	}
+
+	/**@brief Set the number of uncompressed bytes per gzip member, must be called before open()
+	 *
+	 * @param blockSize the size in bytes
+	 * @return whether the size was set, false if the stream is already open
+	 */
+	bool setBlockSize(uint32_t blockSize) {
+		if (is_open()) {
+			return false;
+		}
+		blockSize_ = std::max<uint32_t>(1024, blockSize);
+		return true;
+	}
+
+	/**@brief Set the zlib compression level, must be called before open()
+	 *
+	 * @param level the compression level, -1 (default) or 0-9
+	 * @return whether the level was set, false if the stream is already open
+	 */
+	bool setLevel(int level) {
+		if (is_open()) {
+			return false;
+		}
+		level_ = level;
+		return true;
+	}
+
+	uint32_t getNumThreads() const {
+		return numThreads_;
+	}
+
+	int is_open() const {
+		return opened_;
+	}
+
+	pgzstreambuf* open(const char* name, int open_mode) {
+		if (is_open()) {
+			return (pgzstreambuf*) 0;
+		}
+		if (open_mode & std::ios::in) {
+			return (pgzstreambuf*) 0;
+		}
+		// concatenated gzip members are still a valid gzip file so appending is simply appending to the file
+		std::ios::openmode fmode = std::ios::out | std::ios::binary;
+		if ((open_mode & std::ios::ate) || (open_mode & std::ios::app)) {
+			fmode |= std::ios::app;
+		}
+		file_.open(name, fmode);
+		if (!file_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << " in opening " << name << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		buffer_.resize(blockSize_ + 1);
+		setp(buffer_.data(), buffer_.data() + (buffer_.size() - 1));
+		nextBlock_ = 0;
+		nextToWrite_ = 0;
+		inFlight_ = 0;
+		finishing_ = false;
+		failed_ = false;
+		for (uint32_t t = 0; t < numThreads_; ++t) {
+			workers_.emplace_back(&pgzstreambuf::compressWorker, this);
+		}
+		opened_ = true;
+		return this;
+	}
+
+	pgzstreambuf * close() {
+		if (!is_open()) {
+			return (pgzstreambuf*) 0;
+		}
+		// always write at least one member so that an empty stream is still a valid gzip file
+		if (pptr() > pbase() || 0 == nextBlock_) {
+			submitBlock();
+		}
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			finishing_ = true;
+		}
+		workCv_.notify_all();
+		for (auto & t : workers_) {
+			t.join();
+		}
+		workers_.clear();
+		writeReady();
+		file_.close();
+		opened_ = false;
+		setp(nullptr, nullptr);
+		bool succeeded = !failed_ && compressed_.empty() && nextToWrite_ == nextBlock_ && !file_.fail();
+		compressed_.clear();
+		return succeeded ? this : (pgzstreambuf*) 0;
+	}
+
+	virtual int overflow(int c = EOF) {
+		if (!opened_) {
+			return EOF;
+		}
+		if (c != EOF) {
+			*pptr() = c;
+			pbump(1);
+		}
+		if (!submitBlock()) {
+			return EOF;
+		}
+		return traits_type::not_eof(c);
+	}
+
+	virtual int sync() {
+		// blocks are only submitted when full or on close(), submitting on every flush
+		// (e.g. std::endl) would create tiny gzip members and destroy the compression ratio
+		std::lock_guard<std::mutex> lock(mut_);
+		return failed_ ? -1 : 0;
+	}
+};
+
+class pgzstreambase: virtual public std::ios {
+protected:
+	pgzstreambuf buf;
+public:
+
+	pgzstreambase() {
+		init(&buf);
+	}
+	pgzstreambase(const char* name, int mode, uint32_t numThreads) {
+		init(&buf);
+		buf.setNumThreads(numThreads);
+		open(name, mode);
+	}
+	~pgzstreambase() {
+		buf.close();
+	}
+	void open(const char* name, int open_mode) {
+		if (!buf.open(name, open_mode)) {
+			clear(rdstate() | std::ios::badbit);
+		}
+	}
+
+	void close() {
+		if (buf.is_open()) {
+			if (!buf.close()) {
+				clear(rdstate() | std::ios::badbit);
+			}
+		}
+	}
+	pgzstreambuf* rdbuf() {
+		return &buf;
+	}
+};
+
+// ----------------------------------------------------------------------------
+// User class. Use opgzstream analogously to ogzstream, output is compressed on
+// several threads and is compatible with gzip compression.
+// ----------------------------------------------------------------------------
+
+class opgzstream: public pgzstreambase, public std::ostream {
+public:
+	opgzstream() :
+			std::ostream(&buf) {
+	}
+	explicit opgzstream(const bfs::path & name, uint32_t numThreads = 2,
+			int mode = std::ios::out) :
+			pgzstreambase(name.string().c_str(), mode, numThreads), std::ostream(&buf) {
+	}
+	pgzstreambuf* rdbuf() {
+		return pgzstreambase::rdbuf();
+	}
+	void open(const bfs::path & name, int open_mode = std::ios::out) {
+		pgzstreambase::open(name.string().c_str(), open_mode);
+	}
+};
+
+}  // namespace GZSTREAM
+}  // namespace njh
+
@@ -12,6 +12,8 @@
 #include <boost/filesystem.hpp>
 #include "njhcpp/utils/stringUtils.hpp" //appendAsNeededRet()
 #include "njhcpp/files/fileSystemUtils.hpp"
+#include "njhcpp/files/fileObjects/MappedLineReader.hpp"
+#include "njhcpp/files/newlineScanning.hpp"
 #include "njhcpp/IO.h"
 
 
@@ -69,6 +71,16 @@ inline std::streambuf* determineOutBuf(std::ofstream & outFile,
 	}
 }
 
+/**@brief Whether a file can be read through a memory map rather than through a stream, i.e. a regular, non-gzipped file
+ *
+ * @param fnp the file
+ * @return true if the file can be mapped
+ */
+inline bool canBeMapped(const bfs::path & fnp) {
+	return "" != fnp && "STDIN" != fnp && !njh::endsWith(fnp.string(), ".gz")
+			&& bfs::is_regular_file(fnp);
+}
+
 /**@brief Cross platform get line to line CR and CRLF line endings
  *
  * @param __is The stream to read from
@@ -156,23 +168,25 @@ inline std::string getLastLine(const bfs::path & filename) {
 	  	ret = currentLine;
 	  }
 	}else{
-		std::ifstream inputFile(filename.string(), std::ios_base::ate); //open file
-		if(!inputFile){
+		if(!bfs::is_regular_file(filename)){
 			throw std::runtime_error{njh::bashCT::boldRed("Error in opening " + filename.string())};
 		}
-		char c = '\0';
-		if (inputFile) {
-			int length = inputFile.tellg(); //Get file size
-			// loop backward over the file
-			for (int i = length - 2; i > 0; --i) {
-				inputFile.seekg(i);
-				c = inputFile.get();
-				if (c == '\r' || c == '\n'){ //new line?
-					break;
-				}
-			}
-			crossPlatGetline(inputFile, ret); //read last line
+		MappedFile mapped(filename);
+		const char * start = mapped.data();
+		const char * end = start + mapped.size();
+		//skip the line ending of the last line
+		if (end > start && '\n' == *(end - 1)) {
+			--end;
+		}
+		if (end > start && '\r' == *(end - 1)) {
+			--end;
+		}
+		//then loop backwards to the line ending of the line before
+		const char * lineStart = end;
+		while (lineStart > start && '\n' != *(lineStart - 1) && '\r' != *(lineStart - 1)) {
+			--lineStart;
 		}
+		ret.assign(lineStart, end);
 	}
 	return ret;
 }
@@ -184,6 +198,14 @@ inline std::string getLastLine(const bfs::path & filename) {
  */
 inline std::vector<std::string> getAllLines(const bfs::path & fnp){
 	std::vector<std::string> ret;
+	if (canBeMapped(fnp)) {
+		MappedLineReader reader(fnp);
+		std::string_view line;
+		while (reader.getline(line)) {
+			ret.emplace_back(line);
+		}
+		return ret;
+	}
   std::string currentLine;
   InputStream textFile(fnp);
   while(crossPlatGetline(textFile, currentLine)){
@@ -278,24 +300,38 @@ inline bool nextLineBeginsWith(std::istream & is, char c){
 	return is.peek() == c;
 }
 
-/**@brief Count the number of lines in a file
+/**@brief Count the number of lines in a file, gz files (ending in .gz) are counted after decompressing
  *
  * @param filename The filename to count
  * @return The number of lines in filename
  */
 inline uint32_t countLines(const bfs::path & filename) {
-	std::ifstream inFile(filename.string());
+	LineCounter counter;
+	if (njh::endsWith(filename.string(), ".gz")) {
+		InputStream inFile(filename);
+		std::vector<char> buffer(njh::GZSTREAM::gzstreambuf::defaultBufferSize * 8);
+		while (inFile.read(buffer.data(), buffer.size()) || inFile.gcount() > 0) {
+			counter.add(buffer.data(), inFile.gcount());
+		}
+		return counter.count();
+	}
+	if (bfs::is_regular_file(filename)) {
+		MappedFile mapped(filename);
+		mapped.advise(MADV_SEQUENTIAL);
+		counter.add(mapped.data(), mapped.size());
+		return counter.count();
+	}
+	std::ifstream inFile(filename.string(), std::ios::binary);
 	if (!inFile) {
 		std::stringstream ss;
 		ss << "Error in opening " << filename << std::endl;
 		throw std::runtime_error { ss.str() };
 	}
-	uint32_t ret = 0;
-	std::string line;
-	while (njh::files::crossPlatGetline(inFile, line)) {
-		++ret;
+	std::vector<char> buffer(1024 * 1024);
+	while (inFile.read(buffer.data(), buffer.size()) || inFile.gcount() > 0) {
+		counter.add(buffer.data(), inFile.gcount());
 	}
-	return ret;
+	return counter.count();
 }
 
 /**@brief Check to see if a mtraix file has rowname
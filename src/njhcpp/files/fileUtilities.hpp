@@ -2,6 +2,11 @@
 
 #include <boost/filesystem.hpp>
 #include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include "njhcpp/debug/exception.hpp"
 #include <cppitertools/range.hpp>
 
@@ -92,33 +97,178 @@ inline void touch(bfs::path fnp) {
 	bfs::last_write_time(fnp, std::time(nullptr));
 }
 
-/**@brief Preallocate an empty file to be a certain size
+/**@brief Reserve disk space for a byte range of an open file so later writes to it don't have to allocate
  *
- * @param fnp The file to preallocate, will overwrite if it exists
- * @param numBytes the number of bytes to size the file to
+ * Uses fallocate where the filesystem supports it, which is constant time and leaves the range contiguous where it can.
+ * Otherwise the file is extended and one zero byte is written per 4KiB page past its old end, data already in the file is never touched.
+ *
+ * @param fd the open file, needs to be writable
+ * @param offset the start of the range
+ * @param len the length of the range
+ * @param keepSize reserve the space without changing the file's size, for files that will be appended to, there is no fallback for this so it only happens where fallocate works
+ * @return true if fallocate reserved the space, false if the fallback was used or, with keepSize, nothing could be done
  */
-inline void preallocate(bfs::path fnp, const uint64_t numBytes) {
+inline bool preallocateFd(int fd, uint64_t offset, uint64_t len, bool keepSize = false) {
+	if (0 == len) {
+		return true;
+	}
+#if defined(__linux__)
+	int status = 0;
+	do {
+		status = ::fallocate(fd, keepSize ? FALLOC_FL_KEEP_SIZE : 0, offset, len);
+	} while (0 != status && EINTR == errno);
+	if (0 == status) {
+		return true;
+	}
+	if (EOPNOTSUPP != errno && ENOSYS != errno) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error in reserving " << len << " bytes at " << offset << ": " << std::strerror(errno) << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+#endif
+	if (keepSize) {
+		return false;
+	}
 	static const uint64_t pageSize = 4096;
+	struct stat info;
+	if (0 != ::fstat(fd, &info)) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error in getting file size: " << std::strerror(errno) << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+	const uint64_t oldSize = info.st_size;
+	const uint64_t end = offset + len;
+	if (end <= oldSize) {
+		return false;
+	}
+	if (0 != ::ftruncate(fd, end)) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error in extending file to " << end << " bytes: " << std::strerror(errno) << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+	//touch each page past the old end so it's backed by a real block rather than a hole
+	const char zero = 0;
+	for (uint64_t pos = std::max(offset, oldSize); pos < end; pos += pageSize - (pos % pageSize)) {
+		if (1 != ::pwrite(fd, &zero, 1, pos)) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in writing at " << pos << ": " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+	return false;
+}
 
-	if (bfs::exists(fnp)) {
-		bfs::remove(fnp);
+/**@brief Zero out a byte range of an open file and give its disk space back where the filesystem supports it, the file's size doesn't change
+ *
+ * @param fd the open file, needs to be writable
+ * @param offset the start of the range
+ * @param len the length of the range
+ * @return true if the space was released, false if the range was just overwritten with zeros
+ */
+inline bool punchHoleFd(int fd, uint64_t offset, uint64_t len) {
+	if (0 == len) {
+		return true;
+	}
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+	if (0 == ::fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, offset, len)) {
+		return true;
 	}
-	touch(fnp);
-	bfs::resize_file(fnp, numBytes);
+	if (EOPNOTSUPP != errno && ENOSYS != errno) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error in punching hole of " << len << " bytes at " << offset << ": " << std::strerror(errno) << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+#endif
+	struct stat info;
+	if (0 != ::fstat(fd, &info)) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error in getting file size: " << std::strerror(errno) << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+	//don't grow the file
+	const uint64_t end = std::min<uint64_t>(offset + len, info.st_size);
+	std::vector<char> zeros(std::min<uint64_t>(1024 * 1024, len), 0);
+	for (uint64_t pos = offset; pos < end;) {
+		ssize_t wrote = ::pwrite(fd, zeros.data(), std::min<uint64_t>(zeros.size(), end - pos), pos);
+		if (wrote < 0) {
+			if (EINTR == errno) {
+				continue;
+			}
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in writing at " << pos << ": " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		pos += wrote;
+	}
+	return false;
+}
 
-	std::ofstream out(fnp.string(), std::ios::binary | std::ios::out);
-	if (!out.is_open()) {
-		throw njh::err::Exception(njh::err::F() << "could not open file " << fnp);
+/**@brief Preallocate an empty file to be a certain size
+ *
+ * @param fnp The file to preallocate, will overwrite if it exists
+ * @param numBytes the number of bytes to size the file to
+ * @return true if the filesystem reserved the space with fallocate, false if it had to be written out
+ */
+inline bool preallocate(const bfs::path & fnp, const uint64_t numBytes) {
+	int fd = ::open(fnp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) {
+		throw njh::err::Exception(njh::err::F() << "could not open file " << fnp << ": " << std::strerror(errno));
+	}
+	bool ret = false;
+	try {
+		ret = preallocateFd(fd, 0, numBytes);
+	} catch (const std::exception & e) {
+		::close(fd);
+		throw njh::err::Exception(njh::err::F() << "error in preallocating " << fnp << ": " << e.what());
 	}
+	::close(fd);
+	return ret;
+}
 
-	// round down to avoid preallocating a file larger than desired
-	auto rounded = numBytes - (numBytes % pageSize);
+/**@brief Reserve disk space past the current end of an existing file without changing its size, so appending up to numBytes more won't have to allocate
+ *
+ * Only possible where the filesystem supports fallocate, elsewhere this does nothing
+ *
+ * @param fnp the file, needs to exist
+ * @param numBytes how much will be appended
+ * @return true if the space was reserved
+ */
+inline bool reserveAppendSpace(const bfs::path & fnp, const uint64_t numBytes) {
+	int fd = ::open(fnp.c_str(), O_WRONLY);
+	if (fd < 0) {
+		throw njh::err::Exception(njh::err::F() << "could not open file " << fnp << ": " << std::strerror(errno));
+	}
+	bool ret = false;
+	try {
+		struct stat info;
+		if (0 == ::fstat(fd, &info)) {
+			ret = preallocateFd(fd, info.st_size, numBytes, true);
+		}
+	} catch (const std::exception & e) {
+		::close(fd);
+		throw njh::err::Exception(njh::err::F() << "error in reserving space for " << fnp << ": " << e.what());
+	}
+	::close(fd);
+	return ret;
+}
 
-	for (auto i : iter::range(uint64_t(0), rounded, pageSize)) {
-		out.seekp(i, std::ios_base::beg);
-		out.put(0);
+/**@brief Zero out a byte range of a file and give its disk space back where the filesystem supports it, see punchHoleFd
+ *
+ */
+inline bool punchHole(const bfs::path & fnp, uint64_t offset, uint64_t len) {
+	int fd = ::open(fnp.c_str(), O_WRONLY);
+	if (fd < 0) {
+		throw njh::err::Exception(njh::err::F() << "could not open file " << fnp << ": " << std::strerror(errno));
+	}
+	bool ret = false;
+	try {
+		ret = punchHoleFd(fd, offset, len);
+	} catch (const std::exception & e) {
+		::close(fd);
+		throw njh::err::Exception(njh::err::F() << "error in punching hole in " << fnp << ": " << e.what());
 	}
-	out.close();
+	::close(fd);
+	return ret;
 }
 
 /**@brief is to see if a file is empty, will throw if file is empty
@@ -0,0 +1,209 @@
+#pragma once
+/*
+ * newlineScanning.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Vectorized scanning of blocks of memory for line endings. \n, \r\n and \r
+// are all treated as one line ending the same way njh::files::crossPlatGetline
+// does. The vector width is picked at compile time, AVX2 when compiled with
+// -mavx2 (or -march=native on a machine that has it), SSE2 on any x86-64
+// build and a scalar loop everywhere else.
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace njh {
+namespace files {
+
+namespace scanning {
+#if defined(__AVX2__)
+static const size_t vectorWidth = 32;
+typedef uint32_t Mask;
+/**@brief Get bit masks for where the \n and \r characters are in the next vectorWidth bytes
+ *
+ */
+inline void lineEndingMasks(const char * pos, Mask & newLines, Mask & carriageReturns) {
+	__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(pos));
+	newLines = static_cast<Mask>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'))));
+	carriageReturns = static_cast<Mask>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\r'))));
+}
+#elif defined(__SSE2__)
+static const size_t vectorWidth = 16;
+typedef uint32_t Mask;
+inline void lineEndingMasks(const char * pos, Mask & newLines, Mask & carriageReturns) {
+	__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+	newLines = static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'))));
+	carriageReturns = static_cast<Mask>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('\r'))));
+}
+#else
+static const size_t vectorWidth = 8;
+typedef uint32_t Mask;
+inline void lineEndingMasks(const char * pos, Mask & newLines, Mask & carriageReturns) {
+	newLines = 0;
+	carriageReturns = 0;
+	for (size_t bit = 0; bit < vectorWidth; ++bit) {
+		newLines |= static_cast<Mask>('\n' == pos[bit]) << bit;
+		carriageReturns |= static_cast<Mask>('\r' == pos[bit]) << bit;
+	}
+}
+#endif
+
+inline uint32_t popcount(Mask mask) {
+	return static_cast<uint32_t>(__builtin_popcount(mask));
+}
+
+inline uint32_t lowestBit(Mask mask) {
+	return static_cast<uint32_t>(__builtin_ctz(mask));
+}
+
+}  // namespace scanning
+
+/**@brief Find the first \n or \r
+ *
+ * @param pos the start of the memory to search
+ * @param end the end of the memory to search
+ * @return a pointer to the first \n or \r or end if there wasn't one
+ */
+inline const char * findLineEnding(const char * pos, const char * end) {
+	while (pos + scanning::vectorWidth <= end) {
+		scanning::Mask newLines;
+		scanning::Mask carriageReturns;
+		scanning::lineEndingMasks(pos, newLines, carriageReturns);
+		scanning::Mask either = newLines | carriageReturns;
+		if (0 != either) {
+			return pos + scanning::lowestBit(either);
+		}
+		pos += scanning::vectorWidth;
+	}
+	while (pos < end && '\n' != *pos && '\r' != *pos) {
+		++pos;
+	}
+	return pos;
+}
+
+/**@brief Count line endings in a block of memory that might be one of several consecutive blocks (e.g. decompressed gz chunks)
+ *
+ * A \r\n pair counts as one line ending even when split across two blocks
+ *
+ * @param data the start of the block
+ * @param len the length of the block
+ * @param previousEndedWithCR whether the block before this ended in a \r, will be set for this block
+ * @return the number of line endings
+ */
+inline uint64_t countLineEndings(const char * data, size_t len, bool & previousEndedWithCR) {
+	uint64_t ret = 0;
+	const char * pos = data;
+	const char * end = data + len;
+	bool carry = previousEndedWithCR;
+	while (pos + scanning::vectorWidth <= end) {
+		scanning::Mask newLines;
+		scanning::Mask carriageReturns;
+		scanning::lineEndingMasks(pos, newLines, carriageReturns);
+		if (0 != (newLines | carriageReturns)) {
+			//a \n right after a \r is part of the same line ending
+			scanning::Mask pairs = newLines & ((carriageReturns << 1) | static_cast<scanning::Mask>(carry));
+			ret += scanning::popcount(newLines) + scanning::popcount(carriageReturns) - scanning::popcount(pairs);
+		}
+		carry = 0 != (carriageReturns & (static_cast<scanning::Mask>(1) << (scanning::vectorWidth - 1)));
+		pos += scanning::vectorWidth;
+	}
+	for (; pos < end; ++pos) {
+		if ('\r' == *pos) {
+			++ret;
+			carry = true;
+		} else {
+			if ('\n' == *pos && !carry) {
+				++ret;
+			}
+			carry = false;
+		}
+	}
+	previousEndedWithCR = carry;
+	return ret;
+}
+
+/**@brief Get the offsets of the start of every line ending, the \n of a \r\n pair is skipped
+ *
+ * @param data the start of the memory
+ * @param len the length of the memory
+ * @param positions the offsets will be appended to this
+ */
+inline void lineEndingPositions(const char * data, size_t len, std::vector<size_t> & positions) {
+	const char * pos = data;
+	const char * end = data + len;
+	bool carry = false;
+	while (pos + scanning::vectorWidth <= end) {
+		scanning::Mask newLines;
+		scanning::Mask carriageReturns;
+		scanning::lineEndingMasks(pos, newLines, carriageReturns);
+		scanning::Mask pairs = newLines & ((carriageReturns << 1) | static_cast<scanning::Mask>(carry));
+		scanning::Mask starts = (newLines & ~pairs) | carriageReturns;
+		while (0 != starts) {
+			positions.emplace_back((pos - data) + scanning::lowestBit(starts));
+			starts &= starts - 1;
+		}
+		carry = 0 != (carriageReturns & (static_cast<scanning::Mask>(1) << (scanning::vectorWidth - 1)));
+		pos += scanning::vectorWidth;
+	}
+	for (; pos < end; ++pos) {
+		if ('\r' == *pos || ('\n' == *pos && !carry)) {
+			positions.emplace_back(pos - data);
+		}
+		carry = '\r' == *pos;
+	}
+}
+
+/**@brief Count lines across consecutive blocks of memory, counting the same way reading with njh::files::crossPlatGetline would
+ *
+ */
+class LineCounter {
+	uint64_t lineEndings_ = 0;
+	bool previousEndedWithCR_ = false;
+	bool trailingContent_ = false; /**< whether there is data after the last line ending*/
+public:
+	/**@brief Add the next block of data
+	 *
+	 * @param data the start of the block
+	 * @param len the length of the block
+	 */
+	void add(const char * data, size_t len) {
+		if (0 == len) {
+			return;
+		}
+		lineEndings_ += countLineEndings(data, len, previousEndedWithCR_);
+		const char last = data[len - 1];
+		trailingContent_ = '\n' != last && '\r' != last;
+	}
+
+	/**@brief The number of lines so far, a last line without a line ending is counted
+	 *
+	 */
+	uint64_t count() const {
+		return lineEndings_ + (trailingContent_ ? 1 : 0);
+	}
+};
+
+/**@brief Count lines in a block of memory the same way reading with njh::files::crossPlatGetline would
+ *
+ * @param data the start of the memory
+ * @param len the length of the memory
+ * @return the number of lines
+ */
+inline uint64_t countLines(const char * data, size_t len) {
+	LineCounter counter;
+	counter.add(data, len);
+	return counter.count();
+}
+
+}  // namespace files
+}  // namespace njh
+
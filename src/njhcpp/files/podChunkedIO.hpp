@@ -0,0 +1,372 @@
+#pragma once
+/*
+ * podChunkedIO.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Compressed POD files that can be read in parallel and randomly accessed.
+// The elements are split into fixed size blocks that are each compressed on
+// their own, and an index of where every block starts is stored up front,
+// so any element can be reached by inflating only its block and the blocks
+// can be inflated on several threads straight into the destination.
+//
+// Layout: a PODFileHeader with the chunked flag set, then at its dataOffset_
+// the number of elements per block and the number of blocks (uint64 each),
+// then per block its file offset, compressed size (uint64 each), the crc32
+// of its uncompressed bytes and 4 bytes of padding, then the blocks.
+
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "njhcpp/files/podFileHeader.hpp"
+#include "njhcpp/concurrency/concurrencyUtils.hpp" //runVoidFunctionPooled()
+
+namespace njh {
+namespace files {
+
+/**@brief Where a block of a chunked POD file is
+ *
+ */
+struct PODChunkedBlock {
+	uint64_t offset_ = 0; /**< where the compressed block starts in the file*/
+	uint64_t compressedBytes_ = 0;
+	uint32_t checksum_ = 0; /**< crc32 of the uncompressed block*/
+};
+
+/**@brief The number of bytes at the header's dataOffset_ taken up by the block count and index, the blocks come after
+ *
+ */
+inline uint64_t podChunkedIndexSize(uint64_t numBlocks) {
+	return 2 * sizeof(uint64_t) + numBlocks * 24;
+}
+
+/**@brief Lay out the block count and index as they go at the header's dataOffset_
+ *
+ * @param elementsPerBlock the number of elements in each block
+ * @param blocks where the blocks are
+ * @return podChunkedIndexSize(blocks.size()) bytes
+ */
+inline std::vector<char> podChunkedIndexBytes(uint64_t elementsPerBlock, const std::vector<PODChunkedBlock> & blocks) {
+	std::vector<char> ret(podChunkedIndexSize(blocks.size()), 0);
+	const uint64_t numBlocks = blocks.size();
+	std::memcpy(ret.data(), &elementsPerBlock, sizeof(uint64_t));
+	std::memcpy(ret.data() + 8, &numBlocks, sizeof(uint64_t));
+	for (uint64_t block = 0; block < numBlocks; ++block) {
+		char * entry = ret.data() + 16 + block * 24;
+		std::memcpy(entry, &blocks[block].offset_, sizeof(uint64_t));
+		std::memcpy(entry + 8, &blocks[block].compressedBytes_, sizeof(uint64_t));
+		std::memcpy(entry + 16, &blocks[block].checksum_, sizeof(uint32_t));
+	}
+	return ret;
+}
+
+/**@brief Compress one block of a chunked file
+ *
+ * @param data the uncompressed block
+ * @param numBytes its size
+ * @param level the zlib compression level
+ * @param out set to the compressed bytes
+ * @param fnp the file it's for, for error messages
+ * @return the block's compressed size and checksum, its offset is left 0
+ */
+inline PODChunkedBlock compressPODChunkedBlock(const void * data, uint64_t numBytes, int level,
+		std::vector<char> & out, const bfs::path & fnp) {
+	PODChunkedBlock ret;
+	uLongf compressedBytes = ::compressBound(numBytes);
+	out.resize(compressedBytes);
+	if (Z_OK != ::compress2(reinterpret_cast<Bytef *>(out.data()), &compressedBytes,
+			static_cast<const Bytef *>(data), numBytes, level)) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error in compressing a block for " << fnp << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+	out.resize(compressedBytes);
+	ret.compressedBytes_ = compressedBytes;
+	ret.checksum_ = PODFileHeader::crc32(data, numBytes);
+	return ret;
+}
+
+/**@brief Write elements as separately compressed blocks with an index
+ *
+ * @param fnp the file to write to, will overwrite
+ * @param header describes the data, see PODFileHeader::make, the chunked flag and checksum are set here
+ * @param data the elements, header.numElements_ of them
+ * @param elementsPerBlock the number of elements in each block, smaller blocks make random access cheaper and compress a little worse
+ * @param numThreads the number of threads to compress with
+ * @param level the zlib compression level
+ */
+template<typename T>
+void writePODChunked(const bfs::path & fnp, PODFileHeader header, const T * data,
+		uint64_t elementsPerBlock = 64 * 1024, uint32_t numThreads = 1, int level = Z_DEFAULT_COMPRESSION) {
+	elementsPerBlock = std::max<uint64_t>(1, elementsPerBlock);
+	const uint64_t numBlocks = (header.numElements_ + elementsPerBlock - 1) / elementsPerBlock;
+	std::vector<std::vector<char>> compressed(numBlocks);
+	std::vector<PODChunkedBlock> blocks(numBlocks);
+	std::atomic<uint64_t> nextBlock { 0 };
+	std::function<void()> compressBlocks = [&]() {
+		uint64_t block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+		while (block < numBlocks) {
+			const uint64_t start = block * elementsPerBlock;
+			const uint64_t num = std::min<uint64_t>(elementsPerBlock, header.numElements_ - start);
+			blocks[block] = compressPODChunkedBlock(data + start, num * sizeof(T), level, compressed[block], fnp);
+			block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+	concurrent::runVoidFunctionPooled(compressBlocks, numThreads);
+
+	uint64_t offset = header.dataOffset_ + podChunkedIndexSize(numBlocks);
+	uint32_t checksum = 0;
+	for (uint64_t block = 0; block < numBlocks; ++block) {
+		blocks[block].offset_ = offset;
+		offset += blocks[block].compressedBytes_;
+		const uint64_t num = std::min<uint64_t>(elementsPerBlock, header.numElements_ - block * elementsPerBlock);
+		checksum = ::crc32_combine(checksum, blocks[block].checksum_, num * sizeof(T));
+	}
+	header.flags_ |= PODFileHeader::chunkedFlag_;
+	header.setChecksum(checksum);
+
+	std::ofstream out(fnp.string(), std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!out.is_open()) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error in opening " << fnp << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+	auto headerBytes = header.toBytes();
+	out.write(headerBytes.data(), headerBytes.size());
+	out.seekp(header.dataOffset_);
+	auto indexBytes = podChunkedIndexBytes(elementsPerBlock, blocks);
+	out.write(indexBytes.data(), indexBytes.size());
+	for (const auto & block : compressed) {
+		out.write(block.data(), block.size());
+	}
+	if (!out) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error in writing " << fnp << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+}
+
+/**@brief Write a vector as separately compressed blocks with an index, read it back with PODChunkedReader or readPODvector
+ *
+ * @param fnp the file to write to, will overwrite
+ * @param d the vector
+ * @param elementsPerBlock the number of elements in each block
+ * @param numThreads the number of threads to compress with
+ * @param level the zlib compression level
+ */
+template<typename T>
+void writePODvectorChunked(const bfs::path & fnp, const std::vector<T> & d,
+		uint64_t elementsPerBlock = 64 * 1024, uint32_t numThreads = 1, int level = Z_DEFAULT_COMPRESSION) {
+	writePODChunked(fnp, PODFileHeader::make<T>(PODFileHeader::Layout::VECTOR, d.size(), 1), d.data(),
+			elementsPerBlock, numThreads, level);
+}
+
+/**@brief Reads files written by writePODChunked, the whole thing on several threads or just a range of elements
+ *
+ * Reads use pread so one reader can be shared by several threads
+ */
+template<typename T>
+class PODChunkedReader {
+	bfs::path fnp_;
+	int fd_ = -1;
+	PODFileHeader header_;
+	uint64_t elementsPerBlock_ = 0;
+	std::vector<PODChunkedBlock> blocks_;
+
+	void readAt(void * dest, uint64_t len, uint64_t offset) const {
+		char * out = static_cast<char *>(dest);
+		while (len > 0) {
+			ssize_t got = ::pread(fd_, out, len, offset);
+			if (got <= 0) {
+				if (got < 0 && EINTR == errno) {
+					continue;
+				}
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error in reading " << fnp_ << " at " << offset << ": "
+						<< (0 == got ? "unexpected end of file" : std::strerror(errno)) << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+			out += got;
+			len -= got;
+			offset += got;
+		}
+	}
+
+public:
+	explicit PODChunkedReader(const bfs::path & fnp) :
+			fnp_(fnp), header_(PODFileHeader::read(fnp)) {
+		header_.template check<T>(header_.layout_, fnp_);
+		if (!header_.isChunked()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp_ << " isn't stored in compressed blocks" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		fd_ = ::open(fnp_.c_str(), O_RDONLY);
+		if (fd_ < 0) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in opening " << fnp_ << ": " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		try {
+			uint64_t numBlocks = 0;
+			readAt(&elementsPerBlock_, sizeof(elementsPerBlock_), header_.dataOffset_);
+			readAt(&numBlocks, sizeof(numBlocks), header_.dataOffset_ + sizeof(elementsPerBlock_));
+			const uint64_t fileSize = bfs::file_size(fnp_);
+			if (0 == elementsPerBlock_
+					|| numBlocks != (header_.numElements_ + elementsPerBlock_ - 1) / elementsPerBlock_
+					|| podChunkedIndexSize(numBlocks) > fileSize) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error the block index of " << fnp_ << " doesn't match its header" << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+			std::vector<char> index(podChunkedIndexSize(numBlocks) - 2 * sizeof(uint64_t));
+			readAt(index.data(), index.size(), header_.dataOffset_ + 2 * sizeof(uint64_t));
+			blocks_.resize(numBlocks);
+			for (uint64_t block = 0; block < numBlocks; ++block) {
+				std::memcpy(&blocks_[block].offset_, index.data() + block * 24, sizeof(uint64_t));
+				std::memcpy(&blocks_[block].compressedBytes_, index.data() + block * 24 + 8, sizeof(uint64_t));
+				std::memcpy(&blocks_[block].checksum_, index.data() + block * 24 + 16, sizeof(uint32_t));
+				if (blocks_[block].offset_ + blocks_[block].compressedBytes_ > fileSize) {
+					std::stringstream ss;
+					ss << __PRETTY_FUNCTION__ << ", error block " << block << " of " << fnp_
+							<< " runs past the end of the file, it may have been cut short" << "\n";
+					throw std::runtime_error { ss.str() };
+				}
+			}
+		} catch (...) {
+			::close(fd_);
+			throw;
+		}
+	}
+
+	PODChunkedReader(const PODChunkedReader & other) = delete;
+	PODChunkedReader & operator=(const PODChunkedReader & other) = delete;
+
+	~PODChunkedReader() {
+		if (fd_ >= 0) {
+			::close(fd_);
+		}
+	}
+
+	const PODFileHeader & header() const {
+		return header_;
+	}
+
+	/**@brief The number of elements
+	 *
+	 */
+	uint64_t size() const {
+		return header_.numElements_;
+	}
+
+	uint64_t numBlocks() const {
+		return blocks_.size();
+	}
+
+	uint64_t elementsPerBlock() const {
+		return elementsPerBlock_;
+	}
+
+	/**@brief The number of elements in a block, only the last can be short
+	 *
+	 */
+	uint64_t blockSize(uint64_t block) const {
+		return std::min<uint64_t>(elementsPerBlock_, header_.numElements_ - block * elementsPerBlock_);
+	}
+
+	/**@brief Decompress one block
+	 *
+	 * @param block the block
+	 * @param dest where to put the elements, room for blockSize(block) of them
+	 * @param compressedBuffer scratch space for the compressed bytes, reused between calls
+	 */
+	void readBlock(uint64_t block, T * dest, std::vector<char> & compressedBuffer) const {
+		const auto & info = blocks_[block];
+		compressedBuffer.resize(info.compressedBytes_);
+		readAt(compressedBuffer.data(), info.compressedBytes_, info.offset_);
+		const uLongf expectedBytes = blockSize(block) * sizeof(T);
+		uLongf destBytes = expectedBytes;
+		if (Z_OK != ::uncompress(reinterpret_cast<Bytef *>(dest), &destBytes,
+				reinterpret_cast<const Bytef *>(compressedBuffer.data()), info.compressedBytes_)
+				|| destBytes != expectedBytes
+				|| PODFileHeader::crc32(dest, destBytes) != info.checksum_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error block " << block << " of " << fnp_ << " is corrupt" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	/**@brief Read every element, blocks are decompressed in parallel straight into the result
+	 *
+	 * @param numThreads the number of threads to use
+	 * @return the elements
+	 */
+	std::vector<T> readAll(uint32_t numThreads = 1) const {
+		std::vector<T> ret(size());
+		std::atomic<uint64_t> nextBlock { 0 };
+		std::function<void()> readBlocks = [&]() {
+			std::vector<char> buffer;
+			uint64_t block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+			while (block < blocks_.size()) {
+				readBlock(block, ret.data() + block * elementsPerBlock_, buffer);
+				block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+			}
+		};
+		concurrent::runVoidFunctionPooled(readBlocks, numThreads);
+		return ret;
+	}
+
+	/**@brief Read a range of elements, only the blocks it overlaps are read
+	 *
+	 * @param start the first element
+	 * @param num the number of elements, cut short at the end
+	 * @return the elements
+	 */
+	std::vector<T> getRange(uint64_t start, uint64_t num) const {
+		if (start >= size()) {
+			return {};
+		}
+		num = std::min(num, size() - start);
+		std::vector<T> ret(num);
+		std::vector<char> buffer;
+		std::vector<T> partial;
+		const uint64_t stop = start + num;
+		for (uint64_t block = start / elementsPerBlock_; block * elementsPerBlock_ < stop; ++block) {
+			const uint64_t blockStart = block * elementsPerBlock_;
+			const uint64_t blockStop = blockStart + blockSize(block);
+			if (blockStart >= start && blockStop <= stop) {
+				readBlock(block, ret.data() + (blockStart - start), buffer);
+			} else {
+				//only part of the block is wanted
+				partial.resize(blockSize(block));
+				readBlock(block, partial.data(), buffer);
+				const uint64_t copyStart = std::max(start, blockStart);
+				const uint64_t copyStop = std::min(stop, blockStop);
+				std::copy(partial.begin() + (copyStart - blockStart), partial.begin() + (copyStop - blockStart),
+						ret.begin() + (copyStart - start));
+			}
+		}
+		return ret;
+	}
+
+	/**@brief Read one element
+	 *
+	 */
+	T at(uint64_t pos) const {
+		auto range = getRange(pos, 1);
+		if (range.empty()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error position " << pos << " is out of range for size " << size() << "\n";
+			throw std::out_of_range { ss.str() };
+		}
+		return range.front();
+	}
+};
+
+}  // namespace files
+}  // namespace njh
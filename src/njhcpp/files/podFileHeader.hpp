@@ -0,0 +1,326 @@
+#pragma once
+/*
+ * podFileHeader.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// The header of the self describing POD container files. It records the
+// element type, the byte order of the machine that wrote the file, the
+// dimensions, whether the data is a vector, a dense matrix or the lower
+// triangle of a distance matrix, and a crc32 of the data. The header takes
+// the first 256 bytes so the data after it starts 64 byte aligned in a
+// mapping and can be handed to SIMD code as is.
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <zlib.h>
+#include "njhcpp/files/fileUtilities.hpp"
+#include "njhcpp/files/fileObjects/MappedFile.hpp"
+#include "njhcpp/utils/typeUtils.hpp" //njh::TypeName::get
+
+namespace njh {
+namespace files {
+
+class PODFileHeader {
+public:
+	enum class Layout : uint32_t {
+		VECTOR = 0, /**< a plain vector, nRow_ elements and nCol_ of 1*/
+		DENSE = 1, /**< a row major nRow_ by nCol_ matrix*/
+		LOWER_TRIANGLE = 2 /**< the packed lower triangle of a symmetric nRow_ by nRow_ matrix without the diagonal, row i has i elements*/
+	};
+
+	static constexpr size_t headerSize_ = 256; /**< the data starts right after, a multiple of 64*/
+	static constexpr uint32_t currentVersion_ = 1;
+	static constexpr uint32_t byteOrderMark_ = 0x01020304; /**< reads back as 0x04030201 on a machine with the other byte order*/
+	static constexpr uint32_t hasChecksumFlag_ = 1;
+	static constexpr uint32_t chunkedFlag_ = 2; /**< the data is stored as separately compressed blocks with an index, see podChunkedIO.hpp*/
+
+	uint32_t version_ = currentVersion_;
+	Layout layout_ = Layout::VECTOR;
+	uint32_t elementSize_ = 0; /**< sizeof the element type*/
+	std::string typeName_; /**< njh::TypeName::get of the element type, at most 127 characters are kept*/
+	uint64_t nRow_ = 0;
+	uint64_t nCol_ = 0;
+	uint64_t numElements_ = 0; /**< the number of elements stored*/
+	uint64_t dataOffset_ = headerSize_; /**< where the data starts in the file*/
+	uint32_t dataChecksum_ = 0; /**< crc32 of the data, only meaningful if hasChecksum()*/
+	uint32_t flags_ = 0;
+
+	/**@brief A header for elements of type T
+	 *
+	 */
+	template<typename T>
+	static PODFileHeader make(Layout layout, uint64_t nRow, uint64_t nCol) {
+		PODFileHeader ret;
+		ret.layout_ = layout;
+		ret.elementSize_ = sizeof(T);
+		ret.typeName_ = njh::TypeName::get<T>().substr(0, 127);
+		ret.nRow_ = nRow;
+		ret.nCol_ = nCol;
+		ret.numElements_ = expectedElements(layout, nRow, nCol);
+		return ret;
+	}
+
+	static uint64_t expectedElements(Layout layout, uint64_t nRow, uint64_t nCol) {
+		if (Layout::LOWER_TRIANGLE == layout) {
+			return 0 == nRow ? 0 : (nRow * (nRow - 1)) / 2;
+		}
+		return nRow * nCol;
+	}
+
+	bool hasChecksum() const {
+		return 0 != (flags_ & hasChecksumFlag_);
+	}
+
+	void setChecksum(uint32_t checksum) {
+		dataChecksum_ = checksum;
+		flags_ |= hasChecksumFlag_;
+	}
+
+	void clearChecksum() {
+		dataChecksum_ = 0;
+		flags_ &= ~hasChecksumFlag_;
+	}
+
+	bool isChunked() const {
+		return 0 != (flags_ & chunkedFlag_);
+	}
+
+	/**@brief The size of the uncompressed data
+	 *
+	 */
+	uint64_t dataBytes() const {
+		return numElements_ * elementSize_;
+	}
+
+	/**@brief crc32 of a block of memory of any size, can be continued by passing the previous result as crc
+	 *
+	 */
+	static uint32_t crc32(const void * data, uint64_t len, uint32_t crc = 0) {
+		const Bytef * bytes = static_cast<const Bytef *>(data);
+		while (len > 0) {
+			//zlib takes 32 bit lengths
+			const uInt chunk = static_cast<uInt>(std::min<uint64_t>(len, 1UL << 30));
+			crc = ::crc32(crc, bytes, chunk);
+			bytes += chunk;
+			len -= chunk;
+		}
+		return crc;
+	}
+
+	/**@brief Whether a block of bytes starts with the container magic, so files with and without a header can be told apart
+	 *
+	 */
+	static bool hasMagic(const char * data, size_t len) {
+		return len >= magic().size() && 0 == std::memcmp(data, magic().data(), magic().size());
+	}
+
+	/**@brief Whether a file starts with the container magic
+	 *
+	 */
+	static bool fileHasHeader(const bfs::path & fnp) {
+		std::ifstream in(fnp.string(), std::ios::binary);
+		std::array<char, 8> start;
+		return in.read(start.data(), start.size()) && hasMagic(start.data(), start.size());
+	}
+
+	/**@brief Throw if the data is stored in compressed blocks, for readers that need it stored as is
+	 *
+	 */
+	void checkNotChunked(const bfs::path & fnp) const {
+		if (isChunked()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " is stored in compressed blocks, read it with PODChunkedReader" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	/**@brief Throw unless the header describes elements of type T in the given layout
+	 *
+	 */
+	template<typename T>
+	void check(Layout layout, const bfs::path & fnp) const {
+		if (sizeof(T) != elementSize_ || njh::TypeName::get<T>().substr(0, 127) != typeName_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " holds " << typeName_ << " (" << elementSize_ << " bytes) not "
+					<< njh::TypeName::get<T>() << " (" << sizeof(T) << " bytes)" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		if (layout != layout_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " holds a " << layoutName(layout_) << " not a " << layoutName(layout) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	static std::string layoutName(Layout layout) {
+		switch (layout) {
+		case Layout::VECTOR:
+			return "vector";
+		case Layout::DENSE:
+			return "dense matrix";
+		case Layout::LOWER_TRIANGLE:
+			return "lower triangle matrix";
+		}
+		return "unknown layout";
+	}
+
+	/**@brief The header as the bytes written at the start of the file
+	 *
+	 */
+	std::array<char, headerSize_> toBytes() const {
+		std::array<char, headerSize_> ret { };
+		std::memcpy(ret.data(), magic().data(), magic().size());
+		put(ret, 8, version_);
+		put(ret, 12, byteOrderMark_);
+		put(ret, 16, static_cast<uint32_t>(layout_));
+		put(ret, 20, elementSize_);
+		put(ret, 24, nRow_);
+		put(ret, 32, nCol_);
+		put(ret, 40, numElements_);
+		put(ret, 48, dataOffset_);
+		put(ret, 56, dataChecksum_);
+		put(ret, 60, flags_);
+		std::memcpy(ret.data() + 64, typeName_.c_str(), std::min<size_t>(typeName_.size(), 127));
+		put(ret, headerSize_ - 4, crc32(ret.data(), headerSize_ - 4));
+		return ret;
+	}
+
+	/**@brief Parse a header, throws if the bytes aren't a valid header
+	 *
+	 * @param data the start of the file
+	 * @param len the number of bytes available
+	 * @param fnp the file, for error messages
+	 */
+	static PODFileHeader fromBytes(const char * data, size_t len, const bfs::path & fnp) {
+		if (len < headerSize_ || !hasMagic(data, len)) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " doesn't start with a POD container header" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		if (byteOrderMark_ != get<uint32_t>(data, 12)) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " was written on a machine with a different byte order" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		if (crc32(data, headerSize_ - 4) != get<uint32_t>(data, headerSize_ - 4)) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error the header of " << fnp << " is corrupt" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		PODFileHeader ret;
+		ret.version_ = get<uint32_t>(data, 8);
+		if (ret.version_ > currentVersion_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " is version " << ret.version_
+					<< " of the format, only up to " << currentVersion_ << " can be read" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		ret.layout_ = static_cast<Layout>(get<uint32_t>(data, 16));
+		ret.elementSize_ = get<uint32_t>(data, 20);
+		ret.nRow_ = get<uint64_t>(data, 24);
+		ret.nCol_ = get<uint64_t>(data, 32);
+		ret.numElements_ = get<uint64_t>(data, 40);
+		ret.dataOffset_ = get<uint64_t>(data, 48);
+		ret.dataChecksum_ = get<uint32_t>(data, 56);
+		ret.flags_ = get<uint32_t>(data, 60);
+		ret.typeName_ = std::string(data + 64, ::strnlen(data + 64, 127));
+		if (expectedElements(ret.layout_, ret.nRow_, ret.nCol_) != ret.numElements_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " header has " << ret.numElements_ << " elements which doesn't match a "
+					<< layoutName(ret.layout_) << " of " << ret.nRow_ << " by " << ret.nCol_ << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		return ret;
+	}
+
+	/**@brief Read the header of a file
+	 *
+	 */
+	static PODFileHeader read(const bfs::path & fnp) {
+		std::ifstream in(fnp.string(), std::ios::binary);
+		if (!in) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in opening " << fnp << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		std::array<char, headerSize_> bytes { };
+		in.read(bytes.data(), bytes.size());
+		auto ret = fromBytes(bytes.data(), in.gcount(), fnp);
+		ret.checkFileSize(bfs::file_size(fnp), fnp);
+		return ret;
+	}
+
+	/**@brief Throw if the file isn't exactly the size the header says, chunked files are checked against their block index instead
+	 *
+	 */
+	void checkFileSize(uint64_t fileSize, const bfs::path & fnp) const {
+		if (!isChunked() && fileSize != dataOffset_ + dataBytes()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " is " << fileSize << " bytes but its header says it should be "
+					<< dataOffset_ + dataBytes() << ", it may have been cut short" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	/**@brief Throw if the data doesn't match the checksum, does nothing if the header has no checksum
+	 *
+	 */
+	void verify(const void * data, const bfs::path & fnp) const {
+		if (hasChecksum() && crc32(data, dataBytes()) != dataChecksum_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error the data in " << fnp << " doesn't match its checksum" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	/**@brief Overwrite the header at the start of an existing file, the data is left alone
+	 *
+	 */
+	void writeTo(const bfs::path & fnp) const {
+		std::fstream out(fnp.string(), std::ios::binary | std::ios::in | std::ios::out);
+		auto bytes = toBytes();
+		if (!out || !out.write(bytes.data(), bytes.size())) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in writing header to " << fnp << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	/**@brief Compute the checksum of a container file's data and store it in its header, for files filled in place through a writable view
+	 *
+	 * @param fnp the file
+	 * @return the updated header
+	 */
+	static PODFileHeader updateChecksum(const bfs::path & fnp) {
+		auto header = read(fnp);
+		MappedFile file(fnp);
+		header.setChecksum(crc32(file.data() + header.dataOffset_, header.dataBytes()));
+		header.writeTo(fnp);
+		return header;
+	}
+
+private:
+	static const std::array<char, 8> & magic() {
+		static const std::array<char, 8> magic { { 'N', 'J', 'H', 'P', 'O', 'D', '\r', '\n' } };
+		return magic;
+	}
+
+	template<typename U>
+	static void put(std::array<char, headerSize_> & bytes, size_t pos, U val) {
+		std::memcpy(bytes.data() + pos, &val, sizeof(U));
+	}
+
+	template<typename U>
+	static U get(const char * data, size_t pos) {
+		U ret;
+		std::memcpy(&ret, data + pos, sizeof(U));
+		return ret;
+	}
+};
+
+}  // namespace files
+}  // namespace njh
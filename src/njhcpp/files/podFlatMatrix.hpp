@@ -0,0 +1,309 @@
+#pragma once
+/*
+ * podFlatMatrix.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Matrices held in one contiguous row major allocation, what the bulk
+// loaders in podVecIO.hpp (readPODmatrixFlat, readPODDistMatrixFlat) return,
+// along with the large pread based reading they share.
+
+#include <atomic>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include "njhcpp/common.h"
+#include "njhcpp/concurrency/concurrencyUtils.hpp" //runVoidFunctionPooled()
+
+namespace njh {
+namespace files {
+
+/**@brief Read a byte range of a file into memory with large pread calls, optionally split across threads by byte range
+ *
+ * @param fnp the file
+ * @param dest where to put the bytes, room for numBytes
+ * @param numBytes the number of bytes to read, throws if the file is shorter
+ * @param offset where in the file to start
+ * @param numThreads the number of threads to read with, each gets a contiguous piece of at least 64MB
+ */
+inline void preadFileRange(const bfs::path & fnp, void * dest, uint64_t numBytes, uint64_t offset = 0, uint32_t numThreads = 1) {
+	if (0 == numBytes) {
+		return;
+	}
+	int fd = ::open(fnp.c_str(), O_RDONLY);
+	if (fd < 0) {
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error in opening " << fnp << ": " << std::strerror(errno) << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+#if defined(POSIX_FADV_SEQUENTIAL)
+	::posix_fadvise(fd, offset, numBytes, POSIX_FADV_SEQUENTIAL);
+#endif
+	const uint64_t minPieceBytes = 64UL * 1024 * 1024;
+	const uint64_t pieceBytes = std::max<uint64_t>(minPieceBytes, (numBytes + std::max<uint32_t>(1, numThreads) - 1) / std::max<uint32_t>(1, numThreads));
+	const uint64_t numPieces = (numBytes + pieceBytes - 1) / pieceBytes;
+	std::atomic<uint64_t> nextPiece { 0 };
+	std::function<void()> readPieces = [&]() {
+		uint64_t piece = nextPiece.fetch_add(1, std::memory_order_relaxed);
+		while (piece < numPieces) {
+			uint64_t pos = piece * pieceBytes;
+			const uint64_t stop = std::min(numBytes, pos + pieceBytes);
+			while (pos < stop) {
+				//a single pread on linux moves at most about 2GB
+				const size_t len = std::min<uint64_t>(stop - pos, 1UL << 30);
+				ssize_t got = ::pread(fd, static_cast<char *>(dest) + pos, len, offset + pos);
+				if (got <= 0) {
+					if (got < 0 && EINTR == errno) {
+						continue;
+					}
+					std::stringstream ss;
+					ss << __PRETTY_FUNCTION__ << ", error in reading " << fnp << " at " << offset + pos << ": "
+							<< (0 == got ? "unexpected end of file" : std::strerror(errno)) << "\n";
+					throw std::runtime_error { ss.str() };
+				}
+				pos += got;
+			}
+			piece = nextPiece.fetch_add(1, std::memory_order_relaxed);
+		}
+	};
+	try {
+		concurrent::runVoidFunctionPooled(readPieces, std::min<uint64_t>(numThreads, numPieces));
+	} catch (...) {
+		::close(fd);
+		throw;
+	}
+	::close(fd);
+}
+
+/**@brief A view of a contiguous run of elements, e.g. a row of a PODFlatMatrix, only valid while the matrix is
+ *
+ */
+template<typename T>
+class PODRowView {
+	const T * data_;
+	size_t size_;
+
+public:
+	PODRowView(const T * data, size_t size) :
+			data_(data), size_(size) {
+	}
+
+	size_t size() const {
+		return size_;
+	}
+
+	bool empty() const {
+		return 0 == size_;
+	}
+
+	const T * data() const {
+		return data_;
+	}
+
+	const T * begin() const {
+		return data_;
+	}
+
+	const T * end() const {
+		return data_ + size_;
+	}
+
+	const T & operator[](size_t pos) const {
+		return data_[pos];
+	}
+
+	std::vector<T> toVector() const {
+		return std::vector<T>(begin(), end());
+	}
+};
+
+/**@brief A row major matrix in a single allocation
+ *
+ */
+template<typename T>
+class PODFlatMatrix {
+	std::vector<T> data_;
+	size_t nRow_ = 0;
+	size_t nCol_ = 0;
+
+public:
+	PODFlatMatrix() = default;
+
+	/**@brief A value initialized matrix
+	 *
+	 */
+	PODFlatMatrix(size_t nRow, size_t nCol) :
+			data_(nRow * nCol), nRow_(nRow), nCol_(nCol) {
+	}
+
+	/**@brief Take over row major elements
+	 *
+	 * @param data the elements, a multiple of nCol of them
+	 * @param nCol the number of columns
+	 */
+	PODFlatMatrix(std::vector<T> && data, size_t nCol) :
+			data_(std::move(data)), nRow_(0 == nCol ? 0 : data_.size() / nCol), nCol_(nCol) {
+		if ((0 == nCol_ && !data_.empty()) || (0 != nCol_ && 0 != data_.size() % nCol_)) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error number of columns, " << nCol
+					<< ", doesn't make sense with " << data_.size() << " elements" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	size_t numRows() const {
+		return nRow_;
+	}
+
+	size_t numCols() const {
+		return nCol_;
+	}
+
+	const T & operator()(size_t row, size_t col) const {
+		return data_[row * nCol_ + col];
+	}
+
+	T & operator()(size_t row, size_t col) {
+		return data_[row * nCol_ + col];
+	}
+
+	PODRowView<T> row(size_t row) const {
+		return PODRowView<T>(data_.data() + row * nCol_, nCol_);
+	}
+
+	T * mutableRow(size_t row) {
+		return data_.data() + row * nCol_;
+	}
+
+	/**@brief All the elements, row major
+	 *
+	 */
+	const std::vector<T> & elements() const {
+		return data_;
+	}
+
+	std::vector<T> & mutableElements() {
+		return data_;
+	}
+
+	/**@brief Copy into a vector of rows, what readPODmatrix returns
+	 *
+	 */
+	std::vector<std::vector<T>> toVectors() const {
+		std::vector<std::vector<T>> ret;
+		ret.reserve(nRow_);
+		for (size_t pos = 0; pos < nRow_; ++pos) {
+			ret.emplace_back(row(pos).toVector());
+		}
+		return ret;
+	}
+};
+
+/**@brief A symmetric distance matrix held as its packed lower triangle in a single allocation, the in memory counterpart of PODDistMatrixView
+ *
+ * Row i holds the distances to elements 0 to i-1, the diagonal isn't stored
+ */
+template<typename T>
+class PODFlatDistMatrix {
+	std::vector<T> data_;
+	size_t numOfOrigElement_ = 0;
+
+	static size_t index(size_t i, size_t j) {
+		if (i < j) {
+			std::swap(i, j);
+		}
+		return i * (i - 1) / 2 + j;
+	}
+
+public:
+	/**@brief The number of stored distances for numOfOrigElement elements
+	 *
+	 */
+	static size_t numOfElements(size_t numOfOrigElement) {
+		return 0 == numOfOrigElement ? 0 : numOfOrigElement * (numOfOrigElement - 1) / 2;
+	}
+
+	PODFlatDistMatrix() = default;
+
+	/**@brief A value initialized matrix
+	 *
+	 */
+	explicit PODFlatDistMatrix(size_t numOfOrigElement) :
+			data_(numOfElements(numOfOrigElement)), numOfOrigElement_(numOfOrigElement) {
+	}
+
+	/**@brief Take over the packed lower triangle
+	 *
+	 * @param data the distances, numOfElements(numOfOrigElement) of them
+	 * @param numOfOrigElement the number of elements the distances are between
+	 */
+	PODFlatDistMatrix(std::vector<T> && data, size_t numOfOrigElement) :
+			data_(std::move(data)), numOfOrigElement_(numOfOrigElement) {
+		if (data_.size() != numOfElements(numOfOrigElement_)) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error number of orginal elements, " << numOfOrigElement
+					<< ", doesn't make sense with " << data_.size() << " distances" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	/**@brief The number of elements the distances are between
+	 *
+	 */
+	size_t size() const {
+		return numOfOrigElement_;
+	}
+
+	/**@brief The distance between elements i and j, either order, T() for i == j
+	 *
+	 */
+	T operator()(size_t i, size_t j) const {
+		if (i == j) {
+			return T();
+		}
+		return data_[index(i, j)];
+	}
+
+	/**@brief Set the distance between elements i and j, throws if i == j
+	 *
+	 */
+	void set(size_t i, size_t j, const T & val) {
+		if (i == j) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error the diagonal, " << i << ", isn't stored" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		data_[index(i, j)] = val;
+	}
+
+	/**@brief Row i of the lower triangle, the distances from i to elements 0 to i-1
+	 *
+	 */
+	PODRowView<T> row(size_t i) const {
+		return PODRowView<T>(data_.data() + (0 == i ? 0 : index(i, 0)), i);
+	}
+
+	/**@brief All the distances, row by row
+	 *
+	 */
+	const std::vector<T> & elements() const {
+		return data_;
+	}
+
+	/**@brief Copy into a vector of rows of increasing size, what readPODDistMatrix returns
+	 *
+	 */
+	std::vector<std::vector<T>> toVectors() const {
+		std::vector<std::vector<T>> ret(numOfOrigElement_);
+		for (size_t pos = 1; pos < numOfOrigElement_; ++pos) {
+			ret[pos] = row(pos).toVector();
+		}
+		return ret;
+	}
+};
+
+}  // namespace files
+}  // namespace njh
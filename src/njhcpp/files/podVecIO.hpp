@@ -10,33 +10,274 @@
 #include "njhcpp/files/fileUtilities.hpp"
 #include <zlib.h>
 #include "njhcpp/utils/typeUtils.hpp" //njh::TypeName::get
+#include "njhcpp/utils/stringUtils.hpp" //appendAsNeededRet()
+#include "njhcpp/files/podFileHeader.hpp"
+#include "njhcpp/files/podChunkedIO.hpp"
+#include "njhcpp/files/podFlatMatrix.hpp"
+#include "njhcpp/files/podWriters.hpp"
 
 namespace njh {
 namespace files {
 
+/**@brief Write data behind a POD container header, the header's checksum is filled in here
+ *
+ * @param fnp the file to write to, will overwrite
+ * @param header describes the data, see PODFileHeader::make
+ * @param data the elements, header.numElements_ of them
+ */
+inline void writePODContainerRaw(const bfs::path & fnp, PODFileHeader header, const void * data) {
+	header.setChecksum(PODFileHeader::crc32(data, header.dataBytes()));
+	std::ofstream out(fnp.string(), std::ios::binary | std::ios::out | std::ios::trunc);
+	if (!out.is_open()) {
+		throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": could not open file " << fnp);
+	}
+	auto bytes = header.toBytes();
+	out.write(bytes.data(), bytes.size());
+	out.write(static_cast<const char *>(data), header.dataBytes());
+	if (!out) {
+		throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": error in writing " << fnp);
+	}
+}
+
+/**@brief Write a vector with a header describing it, see PODFileHeader
+ *
+ * @param fnp the file to write to, will overwrite
+ * @param d the vector
+ */
+template<typename T>
+void writePODvectorContainer(const bfs::path & fnp, const std::vector<T> & d) {
+	writePODContainerRaw(fnp, PODFileHeader::make<T>(PODFileHeader::Layout::VECTOR, d.size(), 1), d.data());
+}
+
+/**@brief Write a matrix with a header describing it, see PODFileHeader, all rows have to be the same size
+ *
+ * @param fnp the file to write to, will overwrite
+ * @param mat the matrix
+ */
+template<typename T>
+void writePODmatrixContainer(const bfs::path & fnp, const std::vector<std::vector<T>> & mat) {
+	if (mat.empty() || mat.front().empty()) {
+		for (const auto & row : mat) {
+			if (!row.empty()) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ": Not all rows in mat are the same size: 0, " << row.size() << std::endl;
+				throw std::runtime_error { ss.str() };
+			}
+		}
+		writePODContainerRaw(fnp, PODFileHeader::make<T>(PODFileHeader::Layout::DENSE, mat.size(), 0), nullptr);
+		return;
+	}
+	const size_t nCol = mat.front().size();
+	for (const auto & row : mat) {
+		if (nCol != row.size()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ": Not all rows in mat are the same size: " << nCol << ", " << row.size() << std::endl;
+			throw std::runtime_error { ss.str() };
+		}
+	}
+	PODWriterOptions options;
+	options.container_ = true;
+	PODMatrixWriter<T> writer(fnp, nCol, options, mat.size());
+	for (const auto & row : mat) {
+		writer.addRow(row.data());
+	}
+	writer.close();
+}
+
+/**@brief Write a distance matrix with a header describing it, see PODFileHeader, row i should have i elements (the first row can be left out)
+ *
+ * @param fnp the file to write to, will overwrite
+ * @param mat the matrix
+ */
+template<typename T>
+void writePODDistMatContainer(const bfs::path & fnp, const std::vector<std::vector<T>> & mat) {
+	const size_t offSet = (!mat.empty() && !mat.front().empty()) ? 1 : 0;
+	const size_t numOfOrigElement = mat.size() + offSet;
+	for (size_t pos = 0; pos < mat.size(); ++pos) {
+		if (pos + offSet != mat[pos].size()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ": row: " << pos << ", should be size " << (pos + offSet) << " but is " << mat[pos].size();
+			throw std::runtime_error { ss.str() };
+		}
+	}
+	if (0 == numOfOrigElement) {
+		writePODContainerRaw(fnp, PODFileHeader::make<T>(PODFileHeader::Layout::LOWER_TRIANGLE, 0, 0), nullptr);
+		return;
+	}
+	PODWriterOptions options;
+	options.container_ = true;
+	PODVectorWriter<T> writer(fnp, options,
+			PODFileHeader::expectedElements(PODFileHeader::Layout::LOWER_TRIANGLE, numOfOrigElement, numOfOrigElement),
+			PODFileHeader::Layout::LOWER_TRIANGLE, numOfOrigElement);
+	for (const auto & row : mat) {
+		writer.append(row);
+	}
+	writer.close();
+}
+
+/**@brief Read the data of a container file written by one of the write*Container functions, checking the type, layout and checksum
+ *
+ * @param fnp the file
+ * @param layout the layout expected
+ * @param header set to the file's header
+ * @param numThreads the number of threads to read with
+ * @return the elements
+ */
+template<typename T>
+std::vector<T> readPODContainerData(const bfs::path & fnp, PODFileHeader::Layout layout, PODFileHeader & header, uint32_t numThreads = 1) {
+	header = PODFileHeader::read(fnp);
+	header.check<T>(layout, fnp);
+	if (header.isChunked()) {
+		return PODChunkedReader<T>(fnp).readAll(numThreads);
+	}
+	std::vector<T> ret(header.numElements_);
+	preadFileRange(fnp, ret.data(), header.dataBytes(), header.dataOffset_, numThreads);
+	header.verify(ret.data(), fnp);
+	return ret;
+}
+
+/**@brief Read a vector written by writePODvectorContainer
+ *
+ */
+template<typename T>
+std::vector<T> readPODvectorContainer(const bfs::path & fnp) {
+	PODFileHeader header;
+	return readPODContainerData<T>(fnp, PODFileHeader::Layout::VECTOR, header);
+}
+
+/**@brief Read a matrix written by writePODmatrixContainer
+ *
+ */
+template<typename T>
+std::vector<std::vector<T>> readPODmatrixContainer(const bfs::path & fnp) {
+	PODFileHeader header;
+	auto flat = readPODContainerData<T>(fnp, PODFileHeader::Layout::DENSE, header);
+	std::vector<std::vector<T>> ret;
+	ret.reserve(header.nRow_);
+	for (uint64_t row = 0; row < header.nRow_; ++row) {
+		ret.emplace_back(flat.begin() + row * header.nCol_, flat.begin() + (row + 1) * header.nCol_);
+	}
+	return ret;
+}
+
+/**@brief Read a distance matrix written by writePODDistMatContainer, row i has i elements
+ *
+ */
+template<typename T>
+std::vector<std::vector<T>> readPODDistMatrixContainer(const bfs::path & fnp) {
+	PODFileHeader header;
+	auto flat = readPODContainerData<T>(fnp, PODFileHeader::Layout::LOWER_TRIANGLE, header);
+	std::vector<std::vector<T>> ret(header.nRow_);
+	auto rowStart = flat.begin();
+	for (uint64_t row = 1; row < header.nRow_; ++row) {
+		ret[row].assign(rowStart, rowStart + row);
+		rowStart += row;
+	}
+	return ret;
+}
+
+/**@brief Load a row major matrix file into a single allocation, reading it with large preads split across threads
+ *
+ * Handles both raw files from writePODmatrix and container files from writePODmatrixContainer
+ *
+ * @param fnp the file to read from
+ * @param nCol the number of columns, for container files 0 takes it from the header
+ * @param numThreads the number of threads to read with
+ * @return the matrix
+ */
+template<typename T>
+PODFlatMatrix<T> readPODmatrixFlat(const bfs::path & fnp, uint64_t nCol, uint32_t numThreads = 1) {
+	if (PODFileHeader::fileHasHeader(fnp)) {
+		PODFileHeader header;
+		auto flat = readPODContainerData<T>(fnp, PODFileHeader::Layout::DENSE, header, numThreads);
+		if (0 != nCol && 0 != header.nRow_ && nCol != header.nCol_) {
+			throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": number of columns, " << nCol
+					<< ", doesn't match the " << header.nCol_ << " in the header of file: " << fnp);
+		}
+		return PODFlatMatrix<T>(std::move(flat), header.nCol_);
+	}
+	uint64_t numBytes = bfs::file_size(fnp);
+	if (numBytes % sizeof(T) != 0) {
+		throw njh::err::Exception(
+				njh::err::F() << __PRETTY_FUNCTION__ << ": wrong type for reading file, sizes don't make sense for file: " << fnp);
+	}
+	uint64_t numOfAllElements = numBytes / sizeof(T);
+	if (0 == nCol || 0 != numOfAllElements % nCol) {
+		throw njh::err::Exception(
+				njh::err::F() << __PRETTY_FUNCTION__ << ": number of columns, " << nCol << ", doesn't make sense with file size for file: " << fnp);
+	}
+	std::vector<T> flat(numOfAllElements);
+	preadFileRange(fnp, flat.data(), numBytes, 0, numThreads);
+	return PODFlatMatrix<T>(std::move(flat), nCol);
+}
+
+/**@brief Load a distance matrix file into a single allocation, reading it with large preads split across threads
+ *
+ * Handles both raw files from writePODDistMat and container files from writePODDistMatContainer
+ *
+ * @param fnp the file to read from
+ * @param numOfOrigElement the number of elements the distances are between, for container files 0 takes it from the header
+ * @param numThreads the number of threads to read with
+ * @return the matrix
+ */
+template<typename T>
+PODFlatDistMatrix<T> readPODDistMatrixFlat(const bfs::path & fnp, uint64_t numOfOrigElement, uint32_t numThreads = 1) {
+	if (PODFileHeader::fileHasHeader(fnp)) {
+		PODFileHeader header;
+		auto flat = readPODContainerData<T>(fnp, PODFileHeader::Layout::LOWER_TRIANGLE, header, numThreads);
+		if (0 != numOfOrigElement && numOfOrigElement != header.nRow_) {
+			throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": number of orginal elements, " << numOfOrigElement
+					<< ", doesn't match the " << header.nRow_ << " in the header of file: " << fnp);
+		}
+		return PODFlatDistMatrix<T>(std::move(flat), header.nRow_);
+	}
+	uint64_t numBytes = bfs::file_size(fnp);
+	if (numBytes % sizeof(T) != 0) {
+		throw njh::err::Exception(
+				njh::err::F() << __PRETTY_FUNCTION__ << ": wrong type for reading file, sizes don't make sense for file: " << fnp);
+	}
+	uint64_t numOfElements = PODFlatDistMatrix<T>::numOfElements(numOfOrigElement);
+	if (numBytes != numOfElements * sizeof(T)) {
+		throw njh::err::Exception(
+				njh::err::F() << __PRETTY_FUNCTION__ << ": number of orginal elements, "
+						<< numOfOrigElement
+						<< ", doesn't make sense with file size for file: " << fnp);
+	}
+	std::vector<T> flat(numOfElements);
+	preadFileRange(fnp, flat.data(), numBytes, 0, numThreads);
+	return PODFlatDistMatrix<T>(std::move(flat), numOfOrigElement);
+}
+
 /**@brief Write out a vector as a chunk of data to compressed binary file
  *
  * @param fnp The file to write to, will overwrite it if it already exits
  * @param d The vector to write
  */
 template<typename T>
-void writePODvectorGz(bfs::path fnp, const std::vector<T> d) {
-
-	if (bfs::exists(fnp)) {
-		bfs::remove(fnp);
+void writePODvectorGz(const bfs::path & fnp, const std::vector<T> & d) {
+	const auto outFnp = njh::appendAsNeededRet(fnp.string(), ".gz");
+	auto gzFileOut = gzopen(outFnp.c_str(), "w");
+	if (nullptr == gzFileOut) {
+		throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": could not open file " << outFnp);
 	}
-	njh::files::touch(fnp);
+	gzbuffer(gzFileOut, 128 * 1024);
+	const char * bytes = reinterpret_cast<const char *>(d.data());
 	uint64_t numBytes = d.size() * sizeof(T);
-	//bfs::resize_file(fnp, numBytes);
-	auto gzFileOut = gzopen(njh::appendAsNeededRet(fnp.string(), ".gz").c_str(), "w");
-	/** @todo figure way to test if the file opened
-	if (!()) {
-		throw njh::err::Exception(njh::err::F() << "could not open file " << fnp);
-	}*/
-	gzwrite(gzFileOut, d.data(), numBytes);
-	gzclose(gzFileOut);
-
-	//std::cout << "wrote " << fnp << " (" << d.size() << " elements)" << std::endl;
+	while (numBytes > 0) {
+		//gzwrite takes a 32 bit length
+		const unsigned int toWrite = static_cast<unsigned int>(std::min<uint64_t>(numBytes, 1UL << 30));
+		if (gzwrite(gzFileOut, bytes, toWrite) <= 0) {
+			int errnum = 0;
+			std::string message = gzerror(gzFileOut, &errnum);
+			gzclose(gzFileOut);
+			throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": error in writing " << outFnp << ": " << message);
+		}
+		bytes += toWrite;
+		numBytes -= toWrite;
+	}
+	if (Z_OK != gzclose(gzFileOut)) {
+		throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": error in closing " << outFnp);
+	}
 }
 
 /**@brief Read a chunk of data from a compressed binary file, most likely written by njh::files::writePODvector
@@ -46,33 +287,57 @@ void writePODvectorGz(bfs::path fnp, const std::vector<T> d) {
  */
 template<typename T>
 std::vector<T> readPODvectorGz(bfs::path fnp) {
+	if (PODFileHeader::fileHasHeader(fnp)) {
+		//written by writePODvectorChunked
+		return readPODvectorContainer<T>(fnp);
+	}
 	auto gzInFile = gzopen(fnp.string().c_str(), "r");
-	auto pos = gztell(gzInFile);
-	if (EOF == pos) {
+	if (nullptr == gzInFile || EOF == gztell(gzInFile)) {
+		if (nullptr != gzInFile) {
+			gzclose(gzInFile);
+		}
 		throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": error in opening " << fnp);
 	}
-	std::vector<T> ret;
 	gzbuffer(gzInFile, 128 * 1024);
-	uint32_t bufferSize = 10000;
-	auto bufferBytes = sizeof(T) * bufferSize;
-	std::vector<T> temp(bufferSize);
-	while(!gzeof(gzInFile)){
-
-		int32_t bytes_read = gzread(gzInFile, temp.data(), bufferBytes);
-		if(0 != bytes_read % sizeof(T)){
-			std::stringstream ss;
-			ss << "Error in: " << __PRETTY_FUNCTION__
-					<< " read in " << bytes_read
-					<< " bytes which is not divisible by the size of " << njh::TypeName::get<T>()
-					<< ", " << sizeof(T) << std::endl;
-			throw std::runtime_error{ss.str()};
+	//the gzip trailer has the uncompressed size mod 2^32, for most files that sizes ret exactly up front
+	uint64_t sizeHint = 0;
+	{
+		std::ifstream in(fnp.string(), std::ios::binary);
+		uint32_t trailerSize = 0;
+		if (in.seekg(-4, std::ios::end) && in.read(reinterpret_cast<char *>(&trailerSize), sizeof(trailerSize))) {
+			sizeHint = trailerSize;
+		}
+	}
+	std::vector<T> ret(std::max<uint64_t>(1024, sizeHint / sizeof(T) + 1));
+	uint64_t bytesFilled = 0;
+	while (true) {
+		if (bytesFilled == ret.size() * sizeof(T)) {
+			ret.resize(ret.size() * 2);
+		}
+		//gzread takes a 32 bit length
+		const unsigned int toRead = static_cast<unsigned int>(std::min<uint64_t>(ret.size() * sizeof(T) - bytesFilled, 1UL << 30));
+		int bytesRead = gzread(gzInFile, reinterpret_cast<char *>(ret.data()) + bytesFilled, toRead);
+		if (bytesRead < 0) {
+			int errnum = 0;
+			std::string message = gzerror(gzInFile, &errnum);
+			gzclose(gzInFile);
+			throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": error in reading " << fnp << ": " << message);
 		}
-		uint32_t elements_read = bytes_read/sizeof(T);
-		if(0 != elements_read){
-			ret.insert(ret.end(), temp.begin(), temp.begin() + elements_read);
+		if (0 == bytesRead) {
+			break;
 		}
+		bytesFilled += bytesRead;
 	}
 	gzclose(gzInFile);
+	if (0 != bytesFilled % sizeof(T)) {
+		std::stringstream ss;
+		ss << "Error in: " << __PRETTY_FUNCTION__
+				<< " read in " << bytesFilled
+				<< " bytes which is not divisible by the size of " << njh::TypeName::get<T>()
+				<< ", " << sizeof(T) << std::endl;
+		throw std::runtime_error{ss.str()};
+	}
+	ret.resize(bytesFilled / sizeof(T));
 	return ret;
 }
 
@@ -83,24 +348,10 @@ std::vector<T> readPODvectorGz(bfs::path fnp) {
  * @param d The vector to write
  */
 template<typename T>
-void writePODvector(bfs::path fnp, const std::vector<T> d) {
-
-	if (bfs::exists(fnp)) {
-		bfs::remove(fnp);
-	}
-	touch(fnp);
-	uint64_t numBytes = d.size() * sizeof(T);
-	bfs::resize_file(fnp, numBytes);
-
-	std::ofstream out(fnp.string(), std::ios::binary | std::ios::out);
-	if (!out.is_open()) {
-		throw njh::err::Exception(njh::err::F() << "could not open file " << fnp);
-	}
-	auto* cstr = reinterpret_cast<const char*>(d.data());
-	out.write(cstr, numBytes);
-	out.close();
-
-	//std::cout << "wrote " << fnp << " (" << d.size() << " elements)" << std::endl;
+void writePODvector(const bfs::path & fnp, const std::vector<T> & d) {
+	PODVectorWriter<T> writer(fnp, PODWriterOptions(), d.size());
+	writer.append(d);
+	writer.close();
 }
 
 /**@brief Read a chunk of data, most likely written by njh::files::writePODvector
@@ -110,6 +361,9 @@ void writePODvector(bfs::path fnp, const std::vector<T> d) {
  */
 template<typename T>
 std::vector<T> readPODvector(bfs::path fnp) {
+	if (PODFileHeader::fileHasHeader(fnp)) {
+		return readPODvectorContainer<T>(fnp);
+	}
 	uint64_t numBytes = bfs::file_size(fnp);
 	if (numBytes % sizeof(T) != 0) {
 		throw njh::err::Exception(
@@ -137,24 +391,12 @@ std::vector<T> readPODvector(bfs::path fnp) {
  * @param mat the matrix to write
  */
 template<typename T>
-void writePODmatrixNocheck(bfs::path fnp, const std::vector<std::vector<T>> mat) {
-
-	if (bfs::exists(fnp)) {
-		bfs::remove(fnp);
-	}
-	njh::files::touch(fnp);
-	uint64_t numBytes = mat.size() * mat.size() * sizeof(T);
-	bfs::resize_file(fnp, numBytes);
-
-	std::ofstream out(fnp.string(), std::ios::binary | std::ios::out);
-	if (!out.is_open()) {
-		throw njh::err::Exception(njh::err::F() << "could not open file " << fnp);
-	}
+void writePODmatrixNocheck(const bfs::path & fnp, const std::vector<std::vector<T>> & mat) {
+	PODVectorWriter<T> writer(fnp, PODWriterOptions(), mat.size() * (mat.empty() ? 0 : mat.front().size()));
 	for(const auto & row : mat){
-		auto* cstr = reinterpret_cast<const char*>(row.data());
-		out.write(cstr, numBytes);
+		writer.append(row);
 	}
-	out.close();
+	writer.close();
 }
 
 /**@brief write out a matrix of most likely number as binary format
@@ -163,7 +405,7 @@ void writePODmatrixNocheck(bfs::path fnp, const std::vector<std::vector<T>> mat)
  * @param mat the matrix to write
  */
 template<typename T>
-void writePODmatrix(bfs::path fnp, const std::vector<std::vector<T>> mat) {
+void writePODmatrix(const bfs::path & fnp, const std::vector<std::vector<T>> & mat) {
 	if(mat.empty()){
 		std::stringstream ss;
 		ss << __PRETTY_FUNCTION__ << ": mat is empty";;
@@ -183,6 +425,8 @@ void writePODmatrix(bfs::path fnp, const std::vector<std::vector<T>> mat) {
 
 
 /**@brief Write in a matrix of most likely numbers from a binary file
+ *
+ * Each row is its own allocation, readPODmatrixFlat avoids that
  *
  * @param fnp the file to read from
  * @param nCol the number of columns in the matrix
@@ -190,30 +434,7 @@ void writePODmatrix(bfs::path fnp, const std::vector<std::vector<T>> mat) {
  */
 template<typename T>
 std::vector<std::vector<T>> readPODmatrix(bfs::path fnp, uint32_t nCol) {
-	uint64_t numBytes = bfs::file_size(fnp);
-	if (numBytes % sizeof(T) != 0) {
-		throw njh::err::Exception(
-				njh::err::F() << __PRETTY_FUNCTION__ << ": wrong type for reading file, sizes don't make sense for file: " << fnp);
-	}
-	uint64_t numOfAllElements = numBytes / sizeof(T);
-	if(0 != numOfAllElements % (nCol)){
-		throw njh::err::Exception(
-						njh::err::F() << __PRETTY_FUNCTION__ << ": number of columns, " << nCol << ", doesn't make sense with file size for file: " << fnp);
-	}
-	uint64_t numOfRowElements = numOfAllElements / nCol;
-	uint64_t colBytes = sizeof(T) * nCol;
-
-	std::ifstream in(fnp.string(), std::ios::binary | std::ios::in);
-	if (!in.is_open()) {
-		throw njh::err::Exception(njh::err::F() << "could not open file " << fnp);
-	}
-
-	std::vector<std::vector<T>> mat = std::vector<std::vector<T>>(numOfRowElements, std::vector<T>(nCol));
-	for(uint32_t row = 0; row <= numOfRowElements; ++row){
-		in.read(reinterpret_cast<char*>(mat[row].data()), colBytes);
-	}
-	in.close();
-	return mat;
+	return readPODmatrixFlat<T>(fnp, nCol).toVectors();
 }
 
 /**@brief writes out a distance matrix, which only has half the matrix filled out, first vector can be empty to represent the empty top corner
@@ -223,32 +444,16 @@ std::vector<std::vector<T>> readPODmatrix(bfs::path fnp, uint32_t nCol) {
  * @param mat the matrix to write
  */
 template<typename T>
-void writePODDistMatNocheck(bfs::path fnp, const std::vector<std::vector<T>> mat) {
-
-	if (bfs::exists(fnp)) {
-		bfs::remove(fnp);
-	}
-	njh::files::touch(fnp);
+void writePODDistMatNocheck(const bfs::path & fnp, const std::vector<std::vector<T>> & mat) {
 	uint64_t numOfOrigElement = mat.size();
-	if(!mat.front().empty()){
+	if(!mat.empty() && !mat.front().empty()){
 		numOfOrigElement = mat.size() + 1;
 	}
-	uint32_t numOfElements = ((numOfOrigElement - 1) * numOfOrigElement)/2;
-	uint64_t numBytes = numOfElements * sizeof(T);
-	bfs::resize_file(fnp, numBytes);
-
-	std::ofstream out(fnp.string(), std::ios::binary | std::ios::out);
-	if (!out.is_open()) {
-		throw njh::err::Exception(njh::err::F() << __PRETTY_FUNCTION__ << ": could not open file " << fnp);
-	}
+	PODVectorWriter<T> writer(fnp, PODWriterOptions(), PODFlatDistMatrix<T>::numOfElements(numOfOrigElement));
 	for(const auto & row : mat){
-		if(0 == row.size()){
-			continue;
-		}
-		auto* cstr = reinterpret_cast<const char*>(row.data());
-		out.write(cstr, sizeof(T) * row.size());
+		writer.append(row);
 	}
-	out.close();
+	writer.close();
 }
 
 /**@brief writes out a distance matrix, which only has half the matrix filled out, first vector can be empty to represent the empty top corner
@@ -258,7 +463,7 @@ void writePODDistMatNocheck(bfs::path fnp, const std::vector<std::vector<T>> mat
  * @param mat the matrix to write
  */
 template<typename T>
-void writePODDistMat(bfs::path fnp, const std::vector<std::vector<T>> mat) {
+void writePODDistMat(const bfs::path & fnp, const std::vector<std::vector<T>> & mat) {
 	if(mat.empty() || mat.size() < 2){
 		std::stringstream ss;
 		ss << __PRETTY_FUNCTION__ << ": mat is empty";;
@@ -280,6 +485,8 @@ void writePODDistMat(bfs::path fnp, const std::vector<std::vector<T>> mat) {
 
 
 /**@brief read in a distance matrix of likely numbers from a binary file, each row size should increase by 1 making the matrix only half full
+ *
+ * Each row is its own allocation, readPODDistMatrixFlat avoids that
  *
  * @param fnp
  * @param numOfOrigElement
@@ -287,37 +494,7 @@ void writePODDistMat(bfs::path fnp, const std::vector<std::vector<T>> mat) {
  */
 template<typename T>
 std::vector<std::vector<T>> readPODDistMatrix(bfs::path fnp, uint32_t numOfOrigElement) {
-	uint64_t numBytes = bfs::file_size(fnp);
-	if (numBytes % sizeof(T) != 0) {
-		throw njh::err::Exception(
-				njh::err::F() << __PRETTY_FUNCTION__ << ": wrong type for reading file, sizes don't make sense for file: " << fnp);
-	}
-	uint32_t numOfElements = ((numOfOrigElement - 1) * numOfOrigElement)/2;
-	uint64_t expectedNumBytes = numOfElements * sizeof(T);
-
-	if (0 != numBytes % (expectedNumBytes)) {
-		throw njh::err::Exception(
-				njh::err::F() << __PRETTY_FUNCTION__ << ": number of orginal elements, "
-						<< numOfOrigElement
-						<< ", doesn't make sense with file size for file: " << fnp);
-	}
-
-	std::ifstream in(fnp.string(), std::ios::binary | std::ios::in);
-	if (!in.is_open()) {
-		throw njh::err::Exception(njh::err::F() << "could not open file " << fnp);
-	}
-
-	std::vector<std::vector<T>> mat(numOfOrigElement);
-
-	for(uint32_t row = 0; row <= numOfOrigElement; ++row){
-		mat[row].resize(row);
-		std::cout << mat[row].size() << std::endl;
-		if(0 != row){
-			in.read(reinterpret_cast<char*>(mat[row].data()), row * sizeof(T));
-		}
-	}
-	in.close();
-	return mat;
+	return readPODDistMatrixFlat<T>(fnp, numOfOrigElement).toVectors();
 }
 
 }  // namespace files
@@ -0,0 +1,462 @@
+#pragma once
+/*
+ * podVecViews.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Views of the binary files written by the functions in podVecIO.hpp that
+// memory map the file instead of reading it into vectors. Opening is
+// constant time, only the pages actually touched are read, memory use is
+// bounded by the page cache rather than the heap, and several processes
+// mapping the same file share one copy of it. Files with a PODFileHeader are
+// opened with openContainer(), which takes the type, layout and dimensions
+// from the header instead of trusting the caller.
+
+#include <type_traits>
+#include <algorithm>
+#include "njhcpp/files/fileObjects/MappedFile.hpp"
+#include "njhcpp/files/fileUtilities.hpp" //touch
+#include "njhcpp/utils/typeUtils.hpp" //njh::TypeName::get
+#include "njhcpp/files/podFileHeader.hpp"
+
+namespace njh {
+namespace files {
+
+/**@brief A vector of T stored as raw bytes in a file, as written by writePODvector
+ *
+ */
+template<typename T>
+class PODVectorView {
+	static_assert(std::is_trivially_copyable<T>::value, "PODVectorView only works with trivially copyable types");
+
+	MappedFile file_;
+	T * data_ = nullptr; /**< the start of the elements in the mapping*/
+	size_t size_ = 0; /**< the number of elements*/
+
+public:
+	/**@brief Map a file of Ts
+	 *
+	 * @param fnp the file
+	 * @param writable whether to map it writable, changes go straight to the file
+	 * @param offsetBytes where the elements start in the file, e.g. after a header, has to be a multiple of alignof(T),
+	 * with 0 throws if the file starts with a PODFileHeader so the header isn't read as data, open those with openContainer()
+	 */
+	explicit PODVectorView(const bfs::path & fnp, bool writable = false, size_t offsetBytes = 0) :
+			file_(fnp, writable) {
+		if (0 == offsetBytes && PODFileHeader::hasMagic(file_.data(), file_.size())) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " starts with a PODFileHeader, open it with openContainer()" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		if (0 != offsetBytes % alignof(T) || offsetBytes > file_.size()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error offset " << offsetBytes << " is not a valid start for "
+					<< njh::TypeName::get<T>() << " elements in " << fnp << " of size " << file_.size() << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		const size_t numBytes = file_.size() - offsetBytes;
+		if (0 != numBytes % sizeof(T)) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp << " has " << numBytes
+					<< " bytes of data which is not divisible by the size of " << njh::TypeName::get<T>() << ", " << sizeof(T) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		size_ = numBytes / sizeof(T);
+		if (size_ > 0) {
+			data_ = reinterpret_cast<T *>(const_cast<char *>(file_.data()) + offsetBytes);
+		}
+	}
+
+	/**@brief Make a new file big enough for numElements (zero filled) and map it writable
+	 *
+	 * @param fnp the file, overwritten if it exists
+	 * @param numElements the number of elements
+	 * @return the view
+	 */
+	static PODVectorView create(const bfs::path & fnp, size_t numElements) {
+		if (bfs::exists(fnp)) {
+			bfs::remove(fnp);
+		}
+		touch(fnp);
+		bfs::resize_file(fnp, numElements * sizeof(T));
+		return PODVectorView(fnp, true);
+	}
+
+	/**@brief Map a container file written by one of the write*Container functions or made with createContainer
+	 *
+	 * @param fnp the file
+	 * @param layout the layout expected
+	 * @param header set to the file's header
+	 * @param writable whether to map it writable, the file's checksum is dropped since the data can then change, see PODFileHeader::updateChecksum
+	 * @param verifyChecksum whether to check the data against the checksum, this reads the whole file
+	 * @return the view of the data
+	 */
+	static PODVectorView openContainer(const bfs::path & fnp, PODFileHeader::Layout layout,
+			PODFileHeader & header, bool writable = false, bool verifyChecksum = false) {
+		header = PODFileHeader::read(fnp);
+		header.template check<T>(layout, fnp);
+		header.checkNotChunked(fnp);
+		PODVectorView ret(fnp, writable, header.dataOffset_);
+		if (verifyChecksum) {
+			header.verify(ret.data(), fnp);
+		}
+		if (writable && header.hasChecksum()) {
+			header.clearChecksum();
+			header.writeTo(fnp);
+		}
+		return ret;
+	}
+
+	/**@brief Map a vector container file
+	 *
+	 */
+	static PODVectorView openContainer(const bfs::path & fnp, bool writable = false, bool verifyChecksum = false) {
+		PODFileHeader header;
+		return openContainer(fnp, PODFileHeader::Layout::VECTOR, header, writable, verifyChecksum);
+	}
+
+	/**@brief Make a new zero filled container file and map its data writable, the checksum can be added once it's filled in with PODFileHeader::updateChecksum
+	 *
+	 * @param fnp the file, overwritten if it exists
+	 * @param header describes the data, see PODFileHeader::make
+	 * @return the view of the data
+	 */
+	static PODVectorView createContainer(const bfs::path & fnp, PODFileHeader header) {
+		if (bfs::exists(fnp)) {
+			bfs::remove(fnp);
+		}
+		touch(fnp);
+		header.clearChecksum();
+		bfs::resize_file(fnp, header.dataOffset_ + header.dataBytes());
+		header.writeTo(fnp);
+		return PODVectorView(fnp, true, header.dataOffset_);
+	}
+
+	static PODVectorView createContainer(const bfs::path & fnp, size_t numElements) {
+		return createContainer(fnp, PODFileHeader::make<T>(PODFileHeader::Layout::VECTOR, numElements, 1));
+	}
+
+	const T * data() const {
+		return data_;
+	}
+
+	/**@brief Writable access to the elements, throws if not mapped writable
+	 *
+	 */
+	T * mutableData() {
+		file_.mutableData();
+		return data_;
+	}
+
+	size_t size() const {
+		return size_;
+	}
+
+	bool empty() const {
+		return 0 == size_;
+	}
+
+	bool writable() const {
+		return file_.writable();
+	}
+
+	const T & operator[](size_t pos) const {
+		return data_[pos];
+	}
+
+	/**@brief Access with bounds checking
+	 *
+	 */
+	const T & at(size_t pos) const {
+		if (pos >= size_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error position " << pos << " is out of range for size " << size_ << "\n";
+			throw std::out_of_range { ss.str() };
+		}
+		return data_[pos];
+	}
+
+	const T * begin() const {
+		return data_;
+	}
+
+	const T * end() const {
+		return data_ + size_;
+	}
+
+	/**@brief Copy the elements into a vector, what readPODvector returns
+	 *
+	 */
+	std::vector<T> toVector() const {
+		return std::vector<T>(begin(), end());
+	}
+
+	/**@brief Hint at how the elements will be accessed, e.g. MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED
+	 *
+	 */
+	void advise(int advice) const {
+		file_.advise(advice);
+	}
+
+	/**@brief Flush changes to the file
+	 *
+	 */
+	void sync(bool wait = true) const {
+		file_.sync(wait);
+	}
+
+	const MappedFile & file() const {
+		return file_;
+	}
+};
+
+/**@brief A row major matrix of T stored as raw bytes in a file, as written by writePODmatrix
+ *
+ */
+template<typename T>
+class PODMatrixView {
+	PODVectorView<T> vec_;
+	size_t nCol_;
+	size_t nRow_;
+
+public:
+	/**@brief Map a matrix file
+	 *
+	 * @param fnp the file
+	 * @param nCol the number of columns
+	 * @param writable whether to map it writable
+	 * @param offsetBytes where the elements start in the file, with 0 throws if the file has a PODFileHeader, see openContainer()
+	 */
+	PODMatrixView(const bfs::path & fnp, size_t nCol, bool writable = false, size_t offsetBytes = 0) :
+			PODMatrixView(PODVectorView<T>(fnp, writable, offsetBytes), nCol) {
+	}
+
+	/**@brief View the elements of a vector view as a matrix
+	 *
+	 * @param vec the elements, row major
+	 * @param nCol the number of columns
+	 */
+	PODMatrixView(PODVectorView<T> && vec, size_t nCol) :
+			vec_(std::move(vec)), nCol_(nCol), nRow_(0 == nCol ? 0 : vec_.size() / nCol) {
+		const auto & fnp = vec_.file().path();
+		if (0 == nCol_ || 0 != vec_.size() % nCol_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error number of columns, " << nCol
+					<< ", doesn't make sense with the " << vec_.size() << " elements in " << fnp << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	/**@brief Make a new zero filled matrix file and map it writable
+	 *
+	 */
+	static PODMatrixView create(const bfs::path & fnp, size_t nRow, size_t nCol) {
+		PODVectorView<T>::create(fnp, nRow * nCol);
+		return PODMatrixView(fnp, nCol, true);
+	}
+
+	/**@brief Map a dense matrix container file, the dimensions come from its header
+	 *
+	 * @param fnp the file
+	 * @param writable whether to map it writable, the file's checksum is dropped
+	 * @param verifyChecksum whether to check the data against the checksum, this reads the whole file
+	 */
+	static PODMatrixView openContainer(const bfs::path & fnp, bool writable = false, bool verifyChecksum = false) {
+		PODFileHeader header;
+		auto vec = PODVectorView<T>::openContainer(fnp, PODFileHeader::Layout::DENSE, header, writable, verifyChecksum);
+		return PODMatrixView(std::move(vec), std::max<uint64_t>(1, header.nCol_));
+	}
+
+	/**@brief Make a new zero filled dense matrix container file and map it writable
+	 *
+	 */
+	static PODMatrixView createContainer(const bfs::path & fnp, size_t nRow, size_t nCol) {
+		auto vec = PODVectorView<T>::createContainer(fnp, PODFileHeader::make<T>(PODFileHeader::Layout::DENSE, nRow, nCol));
+		return PODMatrixView(std::move(vec), nCol);
+	}
+
+	size_t numRows() const {
+		return nRow_;
+	}
+
+	size_t numCols() const {
+		return nCol_;
+	}
+
+	const T & operator()(size_t row, size_t col) const {
+		return vec_[row * nCol_ + col];
+	}
+
+	/**@brief Writable access to an element, throws if not mapped writable
+	 *
+	 */
+	T & mutableAt(size_t row, size_t col) {
+		return vec_.mutableData()[row * nCol_ + col];
+	}
+
+	/**@brief A pointer to the start of a row, the row has numCols() elements
+	 *
+	 */
+	const T * row(size_t row) const {
+		return vec_.data() + row * nCol_;
+	}
+
+	/**@brief Copy into a vector of rows, what readPODmatrix returns
+	 *
+	 */
+	std::vector<std::vector<T>> toVectors() const {
+		std::vector<std::vector<T>> ret;
+		ret.reserve(nRow_);
+		for (size_t pos = 0; pos < nRow_; ++pos) {
+			ret.emplace_back(row(pos), row(pos) + nCol_);
+		}
+		return ret;
+	}
+
+	const PODVectorView<T> & elements() const {
+		return vec_;
+	}
+
+	void sync(bool wait = true) const {
+		vec_.sync(wait);
+	}
+};
+
+/**@brief A symmetric distance matrix stored as its packed lower triangle, as written by writePODDistMat
+ *
+ * Row i holds the distances to elements 0 to i-1, so the file has n*(n-1)/2 values and the diagonal isn't stored
+ */
+template<typename T>
+class PODDistMatrixView {
+	PODVectorView<T> vec_;
+	size_t numOfOrigElement_;
+
+	static size_t numOfElements(size_t numOfOrigElement) {
+		return 0 == numOfOrigElement ? 0 : (numOfOrigElement * (numOfOrigElement - 1)) / 2;
+	}
+
+	static size_t index(size_t row, size_t col) {
+		if (row < col) {
+			std::swap(row, col);
+		}
+		return (row * (row - 1)) / 2 + col;
+	}
+
+public:
+	/**@brief Map a distance matrix file
+	 *
+	 * @param fnp the file
+	 * @param numOfOrigElement the number of elements the distances are between
+	 * @param writable whether to map it writable
+	 * @param offsetBytes where the distances start in the file, with 0 throws if the file has a PODFileHeader, see openContainer()
+	 */
+	PODDistMatrixView(const bfs::path & fnp, size_t numOfOrigElement, bool writable = false, size_t offsetBytes = 0) :
+			PODDistMatrixView(PODVectorView<T>(fnp, writable, offsetBytes), numOfOrigElement) {
+	}
+
+	/**@brief View the elements of a vector view as a distance matrix
+	 *
+	 * @param vec the packed lower triangle
+	 * @param numOfOrigElement the number of elements the distances are between
+	 */
+	PODDistMatrixView(PODVectorView<T> && vec, size_t numOfOrigElement) :
+			vec_(std::move(vec)), numOfOrigElement_(numOfOrigElement) {
+		const auto & fnp = vec_.file().path();
+		if (numOfElements(numOfOrigElement_) != vec_.size()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error number of original elements, " << numOfOrigElement
+					<< ", should give " << numOfElements(numOfOrigElement_) << " distances but " << fnp
+					<< " has " << vec_.size() << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	/**@brief Make a new zero filled distance matrix file and map it writable
+	 *
+	 */
+	static PODDistMatrixView create(const bfs::path & fnp, size_t numOfOrigElement) {
+		PODVectorView<T>::create(fnp, numOfElements(numOfOrigElement));
+		return PODDistMatrixView(fnp, numOfOrigElement, true);
+	}
+
+	/**@brief Map a distance matrix container file, the number of elements comes from its header
+	 *
+	 * @param fnp the file
+	 * @param writable whether to map it writable, the file's checksum is dropped
+	 * @param verifyChecksum whether to check the data against the checksum, this reads the whole file
+	 */
+	static PODDistMatrixView openContainer(const bfs::path & fnp, bool writable = false, bool verifyChecksum = false) {
+		PODFileHeader header;
+		auto vec = PODVectorView<T>::openContainer(fnp, PODFileHeader::Layout::LOWER_TRIANGLE, header, writable, verifyChecksum);
+		return PODDistMatrixView(std::move(vec), header.nRow_);
+	}
+
+	/**@brief Make a new zero filled distance matrix container file and map it writable
+	 *
+	 */
+	static PODDistMatrixView createContainer(const bfs::path & fnp, size_t numOfOrigElement) {
+		auto vec = PODVectorView<T>::createContainer(fnp,
+				PODFileHeader::make<T>(PODFileHeader::Layout::LOWER_TRIANGLE, numOfOrigElement, numOfOrigElement));
+		return PODDistMatrixView(std::move(vec), numOfOrigElement);
+	}
+
+	/**@brief The number of elements the distances are between, the matrix is this by this
+	 *
+	 */
+	size_t size() const {
+		return numOfOrigElement_;
+	}
+
+	/**@brief The distance between elements i and j, either order, T() for i == j
+	 *
+	 */
+	T operator()(size_t i, size_t j) const {
+		if (i == j) {
+			return T();
+		}
+		return vec_[index(i, j)];
+	}
+
+	/**@brief Set the distance between elements i and j, throws if not mapped writable or i == j
+	 *
+	 */
+	void set(size_t i, size_t j, const T & val) {
+		if (i == j) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error the diagonal, " << i << ", isn't stored" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		vec_.mutableData()[index(i, j)] = val;
+	}
+
+	/**@brief A pointer to row i of the lower triangle, the distances from i to elements 0 to i-1
+	 *
+	 */
+	const T * row(size_t i) const {
+		return vec_.data() + index(i, 0);
+	}
+
+	/**@brief Copy into a vector of rows of increasing size, what readPODDistMatrix returns
+	 *
+	 */
+	std::vector<std::vector<T>> toVectors() const {
+		std::vector<std::vector<T>> ret(numOfOrigElement_);
+		for (size_t pos = 1; pos < numOfOrigElement_; ++pos) {
+			ret[pos].assign(row(pos), row(pos) + pos);
+		}
+		return ret;
+	}
+
+	const PODVectorView<T> & elements() const {
+		return vec_;
+	}
+
+	void sync(bool wait = true) const {
+		vec_.sync(wait);
+	}
+};
+
+}  // namespace files
+}  // namespace njh
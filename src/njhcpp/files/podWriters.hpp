@@ -0,0 +1,363 @@
+#pragma once
+/*
+ * podWriters.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Writers that take POD data a chunk or row at a time, so a vector or
+// matrix can be written out while it's being computed without ever being
+// held in memory all at once. They write with large buffered pwrite calls,
+// preallocate the file when the final size is known, and can write the
+// self-describing container format of podFileHeader.hpp or the chunked
+// compressed format of podChunkedIO.hpp, compressing blocks in parallel.
+
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+#include "njhcpp/files/fileUtilities.hpp" //preallocateFd
+#include "njhcpp/files/podFileHeader.hpp"
+#include "njhcpp/files/podChunkedIO.hpp"
+#include "njhcpp/concurrency/concurrencyUtils.hpp" //runVoidFunctionPooled()
+
+namespace njh {
+namespace files {
+
+/**@brief How a POD writer lays out its file
+ *
+ */
+struct PODWriterOptions {
+	bool container_ = false; /**< write a PODFileHeader with a checksum before the data, read back with the *Container readers*/
+	bool compress_ = false; /**< write separately compressed blocks with an index, implies container_, needs the number of elements up front*/
+	uint64_t elementsPerBlock_ = 64 * 1024; /**< elements per compressed block*/
+	uint32_t numThreads_ = 1; /**< threads to compress blocks with*/
+	int level_ = Z_DEFAULT_COMPRESSION; /**< zlib compression level*/
+	uint64_t bufferBytes_ = 8 * 1024 * 1024; /**< how much to gather before each write*/
+};
+
+/**@brief Write all of len bytes at offset, retrying short writes
+ *
+ */
+inline void pwriteFully(int fd, const void * data, uint64_t len, uint64_t offset, const bfs::path & fnp) {
+	const char * bytes = static_cast<const char *>(data);
+	while (len > 0) {
+		//a single pwrite on linux moves at most about 2GB
+		ssize_t wrote = ::pwrite(fd, bytes, std::min<uint64_t>(len, 1UL << 30), offset);
+		if (wrote < 0) {
+			if (EINTR == errno) {
+				continue;
+			}
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in writing to " << fnp << " at " << offset << ": " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		bytes += wrote;
+		len -= wrote;
+		offset += wrote;
+	}
+}
+
+/**@brief Write a vector of T to a file a chunk at a time
+ *
+ * close() must be called to finish the file, the destructor closes it too but can't report errors
+ */
+template<typename T>
+class PODVectorWriter {
+	static_assert(std::is_trivially_copyable<T>::value, "PODVectorWriter needs a trivially copyable type");
+
+	bfs::path fnp_;
+	PODWriterOptions options_;
+	PODFileHeader::Layout layout_;
+	uint64_t nCol_;
+	uint64_t expectedElements_;
+	int fd_ = -1;
+	uint64_t dataOffset_ = 0; /**< where the elements or compressed blocks start*/
+	uint64_t fileOffset_ = 0; /**< where the next write goes*/
+	uint64_t numElements_ = 0; /**< elements appended so far*/
+	uint32_t checksum_ = 0;
+	std::vector<char> buffer_;
+	uint64_t bufferFilled_ = 0;
+	std::vector<PODChunkedBlock> blocks_;
+
+	/**@brief Write out what's buffered, compressing it into blocks first if compressing
+	 *
+	 */
+	void flushBuffer() {
+		if (0 == bufferFilled_) {
+			return;
+		}
+		if (!options_.compress_) {
+			pwriteFully(fd_, buffer_.data(), bufferFilled_, fileOffset_, fnp_);
+			fileOffset_ += bufferFilled_;
+			bufferFilled_ = 0;
+			return;
+		}
+		const uint64_t blockBytes = options_.elementsPerBlock_ * sizeof(T);
+		const uint64_t numBlocks = (bufferFilled_ + blockBytes - 1) / blockBytes;
+		std::vector<std::vector<char>> compressed(numBlocks);
+		std::vector<PODChunkedBlock> blocks(numBlocks);
+		std::atomic<uint64_t> nextBlock { 0 };
+		std::function<void()> compressBlocks = [&]() {
+			uint64_t block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+			while (block < numBlocks) {
+				const uint64_t start = block * blockBytes;
+				blocks[block] = compressPODChunkedBlock(buffer_.data() + start,
+						std::min(blockBytes, bufferFilled_ - start), options_.level_, compressed[block], fnp_);
+				block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+			}
+		};
+		concurrent::runVoidFunctionPooled(compressBlocks, std::min<uint64_t>(options_.numThreads_, numBlocks));
+		for (uint64_t block = 0; block < numBlocks; ++block) {
+			pwriteFully(fd_, compressed[block].data(), compressed[block].size(), fileOffset_, fnp_);
+			blocks[block].offset_ = fileOffset_;
+			fileOffset_ += compressed[block].size();
+			const uint64_t start = block * blockBytes;
+			checksum_ = ::crc32_combine(checksum_, blocks[block].checksum_, std::min(blockBytes, bufferFilled_ - start));
+			blocks_.emplace_back(blocks[block]);
+		}
+		bufferFilled_ = 0;
+	}
+
+	PODFileHeader makeHeader() const {
+		auto header = PODFileHeader::make<T>(layout_, PODFileHeader::Layout::DENSE == layout_ ? numElements_ / nCol_ : numElements_, nCol_);
+		if (PODFileHeader::Layout::LOWER_TRIANGLE == layout_) {
+			header.nRow_ = nCol_;
+			header.numElements_ = PODFileHeader::expectedElements(layout_, nCol_, nCol_);
+		}
+		return header;
+	}
+
+public:
+	/**@brief Open a file for writing, will overwrite it
+	 *
+	 * @param fnp the file
+	 * @param options how to lay out the file
+	 * @param expectedElements the number of elements that will be appended if known, used to preallocate the file, needed if compressing
+	 * @param layout what the elements are, for the container header, matrix writers pass their layout
+	 * @param nCol the number of columns for a dense matrix or the number of elements of a distance matrix
+	 */
+	PODVectorWriter(const bfs::path & fnp, const PODWriterOptions & options = PODWriterOptions(), uint64_t expectedElements = 0,
+			PODFileHeader::Layout layout = PODFileHeader::Layout::VECTOR, uint64_t nCol = 1) :
+			fnp_(fnp), options_(options), layout_(layout), nCol_(std::max<uint64_t>(1, nCol)), expectedElements_(expectedElements) {
+		if (options_.compress_) {
+			options_.container_ = true;
+			options_.elementsPerBlock_ = std::max<uint64_t>(1, options_.elementsPerBlock_);
+			if (0 == expectedElements_) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error compressing " << fnp_ << " needs the number of elements up front for the block index" << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+			//whole blocks per buffer, enough for every thread to have one
+			const uint64_t blockBytes = options_.elementsPerBlock_ * sizeof(T);
+			options_.bufferBytes_ = blockBytes * std::max<uint64_t>(options_.numThreads_,
+					std::max<uint64_t>(1, options_.bufferBytes_ / blockBytes));
+		}
+		options_.bufferBytes_ = std::max<uint64_t>(sizeof(T), options_.bufferBytes_ - options_.bufferBytes_ % sizeof(T));
+		fd_ = ::open(fnp_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (fd_ < 0) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in opening " << fnp_ << ": " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		if (options_.container_) {
+			dataOffset_ = PODFileHeader::headerSize_;
+		}
+		if (options_.compress_) {
+			const uint64_t numBlocks = (expectedElements_ + options_.elementsPerBlock_ - 1) / options_.elementsPerBlock_;
+			fileOffset_ = dataOffset_ + podChunkedIndexSize(numBlocks);
+		} else {
+			fileOffset_ = dataOffset_;
+			if (0 != expectedElements_) {
+				//just an optimization, so it's only done where fallocate works, anything unused is cut back on close,
+				//a failure here isn't fatal, a full disk will still be reported by the writes themselves
+				try {
+					preallocateFd(fd_, 0, dataOffset_ + expectedElements_ * sizeof(T), true);
+				} catch (const std::exception &) {
+				}
+			}
+		}
+		buffer_.resize(options_.bufferBytes_);
+	}
+
+	PODVectorWriter(const PODVectorWriter & other) = delete;
+	PODVectorWriter & operator=(const PODVectorWriter & other) = delete;
+
+	~PODVectorWriter() {
+		try {
+			close();
+		} catch (const std::exception & e) {
+			std::cerr << e.what() << std::endl;
+		}
+	}
+
+	/**@brief Append elements
+	 *
+	 * @param data the elements
+	 * @param num how many
+	 */
+	void append(const T * data, uint64_t num) {
+		if (fd_ < 0) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error " << fnp_ << " has already been closed" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		if (options_.compress_ && numElements_ + num > expectedElements_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error appending " << num << " elements to " << fnp_ << " would go past the "
+					<< expectedElements_ << " expected, which the compressed block index was sized for" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		const char * bytes = reinterpret_cast<const char *>(data);
+		uint64_t numBytes = num * sizeof(T);
+		numElements_ += num;
+		if (options_.container_ && !options_.compress_) {
+			checksum_ = PODFileHeader::crc32(bytes, numBytes, checksum_);
+		}
+		while (numBytes > 0) {
+			if (0 == bufferFilled_ && !options_.compress_ && numBytes >= buffer_.size()) {
+				//big enough to skip the buffer
+				pwriteFully(fd_, bytes, numBytes, fileOffset_, fnp_);
+				fileOffset_ += numBytes;
+				return;
+			}
+			const uint64_t toCopy = std::min<uint64_t>(numBytes, buffer_.size() - bufferFilled_);
+			std::memcpy(buffer_.data() + bufferFilled_, bytes, toCopy);
+			bufferFilled_ += toCopy;
+			bytes += toCopy;
+			numBytes -= toCopy;
+			if (buffer_.size() == bufferFilled_) {
+				flushBuffer();
+			}
+		}
+	}
+
+	void append(const std::vector<T> & data) {
+		append(data.data(), data.size());
+	}
+
+	void append(const T & element) {
+		append(&element, 1);
+	}
+
+	/**@brief The number of elements appended so far
+	 *
+	 */
+	uint64_t size() const {
+		return numElements_;
+	}
+
+	const bfs::path & file() const {
+		return fnp_;
+	}
+
+	/**@brief Write out anything buffered, the header and block index, and close the file, does nothing if already closed
+	 *
+	 */
+	void close() {
+		if (fd_ < 0) {
+			return;
+		}
+		try {
+			flushBuffer();
+			if (options_.container_) {
+				auto header = makeHeader();
+				if (PODFileHeader::Layout::LOWER_TRIANGLE == layout_ && numElements_ != header.numElements_) {
+					std::stringstream ss;
+					ss << __PRETTY_FUNCTION__ << ", error a distance matrix of " << nCol_ << " elements needs "
+							<< header.numElements_ << " distances but " << numElements_ << " were written to " << fnp_ << "\n";
+					throw std::runtime_error { ss.str() };
+				}
+				header.dataOffset_ = dataOffset_;
+				header.setChecksum(checksum_);
+				if (options_.compress_) {
+					header.flags_ |= PODFileHeader::chunkedFlag_;
+					auto indexBytes = podChunkedIndexBytes(options_.elementsPerBlock_, blocks_);
+					pwriteFully(fd_, indexBytes.data(), indexBytes.size(), dataOffset_, fnp_);
+				}
+				auto headerBytes = header.toBytes();
+				pwriteFully(fd_, headerBytes.data(), headerBytes.size(), 0, fnp_);
+			}
+			//drop any preallocation past what was written
+			if (0 != ::ftruncate(fd_, fileOffset_)) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error in truncating " << fnp_ << ": " << std::strerror(errno) << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+		} catch (...) {
+			::close(fd_);
+			fd_ = -1;
+			throw;
+		}
+		int status = ::close(fd_);
+		fd_ = -1;
+		if (0 != status) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in closing " << fnp_ << ": " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+};
+
+/**@brief Write a row major matrix of T to a file a row at a time, readable by readPODmatrix or readPODmatrixFlat
+ *
+ */
+template<typename T>
+class PODMatrixWriter {
+	uint64_t nCol_;
+	PODVectorWriter<T> writer_;
+
+public:
+	/**@brief Open a file for writing, will overwrite it
+	 *
+	 * @param fnp the file
+	 * @param nCol the number of columns, every row must be this long
+	 * @param options how to lay out the file
+	 * @param expectedRows the number of rows that will be added if known, used to preallocate the file, needed if compressing
+	 */
+	PODMatrixWriter(const bfs::path & fnp, uint64_t nCol, const PODWriterOptions & options = PODWriterOptions(), uint64_t expectedRows = 0) :
+			nCol_(nCol), writer_(fnp, options, expectedRows * nCol, PODFileHeader::Layout::DENSE, nCol) {
+		if (0 == nCol_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error number of columns can't be 0 for " << fnp << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	/**@brief Add a row
+	 *
+	 * @param row the row, numCols() elements
+	 */
+	void addRow(const T * row) {
+		writer_.append(row, nCol_);
+	}
+
+	void addRow(const std::vector<T> & row) {
+		if (nCol_ != row.size()) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error row has " << row.size() << " elements but " << writer_.file()
+					<< " has " << nCol_ << " columns" << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		addRow(row.data());
+	}
+
+	uint64_t numRows() const {
+		return writer_.size() / nCol_;
+	}
+
+	uint64_t numCols() const {
+		return nCol_;
+	}
+
+	void close() {
+		writer_.close();
+	}
+};
+
+}  // namespace files
+}  // namespace njh
@@ -14,4 +14,6 @@
 
 #include "njhcpp/md5/md5.hpp"
 #include "njhcpp/md5/md5Utils.hpp"
+#include "njhcpp/md5/xxHash64.hpp"
+#include "njhcpp/md5/ChecksumEngine.hpp"
 
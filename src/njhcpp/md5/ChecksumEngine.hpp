@@ -0,0 +1,294 @@
+#pragma once
+/*
+ * ChecksumEngine.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Checksums many files at once on the shared thread pool, largest files
+// first so one big file started last doesn't leave the other threads idle,
+// with either MD5 or the much faster XXH64. Results can be kept in a tab
+// separated cache file keyed by path, size, modification time and inode, so
+// files that haven't changed since they were last hashed are never read again.
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <sys/stat.h>
+#include "njhcpp/utils.h"
+#include "njhcpp/files/fileUtilities.hpp" //files::last_write_time
+#include "njhcpp/md5/md5Utils.hpp"
+#include "njhcpp/md5/xxHash64.hpp"
+#include "njhcpp/concurrency/concurrencyUtils.hpp" //runVoidFunctionPooled()
+
+namespace njh {
+
+class ChecksumEngine {
+public:
+	enum class Algorithm {
+		MD5, XXH64
+	};
+
+	/**@brief A file's checksum
+	 *
+	 */
+	struct Result {
+		files::bfs::path file_;
+		std::string digest_;
+		uint64_t size_ = 0;
+		bool fromCache_ = false; /**< whether the digest came from the cache rather than reading the file*/
+	};
+
+	/**@brief What the cache remembers about a file, it's only trusted if all of it still matches
+	 *
+	 */
+	struct CacheEntry {
+		uint64_t size_ = 0;
+		int64_t modTime_ = 0; /**< seconds since the epoch*/
+		uint64_t inode_ = 0;
+		std::string digest_;
+	};
+
+	/**@brief Set up an engine
+	 *
+	 * @param algorithm which checksum to compute
+	 * @param numThreads how many files to hash at once
+	 * @param cacheFnp a file to keep digests in between runs, blank for none, loaded here if it exists
+	 */
+	explicit ChecksumEngine(Algorithm algorithm = Algorithm::XXH64, uint32_t numThreads = 1,
+			const files::bfs::path & cacheFnp = "") :
+			algorithm_(algorithm), numThreads_(std::max<uint32_t>(1, numThreads)), cacheFnp_(cacheFnp) {
+		if ("" != cacheFnp_.string() && files::bfs::exists(cacheFnp_)) {
+			loadCache();
+		}
+	}
+
+	ChecksumEngine(const ChecksumEngine & other) = delete;
+	ChecksumEngine & operator=(const ChecksumEngine & other) = delete;
+
+	~ChecksumEngine() {
+		try {
+			saveCache();
+		} catch (const std::exception & e) {
+			std::cerr << e.what() << std::endl;
+		}
+	}
+
+	static std::string algorithmName(Algorithm algorithm) {
+		return Algorithm::MD5 == algorithm ? "md5" : "xxh64";
+	}
+
+	static Algorithm algorithmFromName(const std::string & name) {
+		if ("md5" == name) {
+			return Algorithm::MD5;
+		} else if ("xxh64" == name) {
+			return Algorithm::XXH64;
+		}
+		std::stringstream ss;
+		ss << __PRETTY_FUNCTION__ << ", error unknown checksum algorithm " << name << ", options are md5 or xxh64" << "\n";
+		throw std::runtime_error { ss.str() };
+	}
+
+	/**@brief Checksum a file without the cache
+	 *
+	 * @param fnp the file
+	 * @param algorithm which checksum
+	 * @param buffer where to read into, reused between calls
+	 * @return the hex digest
+	 */
+	static std::string hashFile(const files::bfs::path & fnp, Algorithm algorithm, std::vector<char> & buffer) {
+		if (Algorithm::MD5 == algorithm) {
+			MD5 md5;
+			readFileBlocks(fnp, blockSize_, [&md5](const char * data, uint64_t len) {
+				md5.update(data, len);
+			}, buffer);
+			return md5.finalize().hexdigest();
+		}
+		XXHash64 xxh;
+		readFileBlocks(fnp, blockSize_, [&xxh](const char * data, uint64_t len) {
+			xxh.update(data, len);
+		}, buffer);
+		return xxh.hexdigest();
+	}
+
+	/**@brief Checksum a file, from the cache if it hasn't changed
+	 *
+	 */
+	Result hashFile(const files::bfs::path & fnp) {
+		std::vector<char> buffer;
+		return hashFile(fnp, buffer);
+	}
+
+	/**@brief Checksum many files at once, largest first
+	 *
+	 * @param fnps the files
+	 * @return the results in the same order as fnps
+	 */
+	std::vector<Result> hashFiles(const std::vector<files::bfs::path> & fnps) {
+		std::vector<Result> ret(fnps.size());
+		std::vector<std::pair<uint64_t, size_t>> bySize;
+		bySize.reserve(fnps.size());
+		for (size_t pos = 0; pos < fnps.size(); ++pos) {
+			bySize.emplace_back(fileStats(fnps[pos]).size_, pos);
+		}
+		//longest processing time first
+		std::stable_sort(bySize.begin(), bySize.end(),
+				[](const std::pair<uint64_t, size_t> & p1, const std::pair<uint64_t, size_t> & p2) {
+					return p1.first > p2.first;
+				});
+		std::atomic<size_t> next { 0 };
+		std::function<void()> hashAll = [&]() {
+			std::vector<char> buffer;
+			size_t pos = next.fetch_add(1, std::memory_order_relaxed);
+			while (pos < bySize.size()) {
+				ret[bySize[pos].second] = hashFile(fnps[bySize[pos].second], buffer);
+				pos = next.fetch_add(1, std::memory_order_relaxed);
+			}
+		};
+		concurrent::runVoidFunctionPooled(hashAll, std::min<size_t>(numThreads_, std::max<size_t>(1, fnps.size())));
+		return ret;
+	}
+
+	/**@brief Write the cache file if anything was added, done on destruction too, the cache file is replaced in one rename
+	 *
+	 */
+	void saveCache() {
+		std::lock_guard<std::mutex> lock(mut_);
+		if ("" == cacheFnp_.string() || !cacheChanged_) {
+			return;
+		}
+		const auto tempFnp = files::bfs::path(cacheFnp_.string() + ".tmp" + std::to_string(::getpid()));
+		{
+			std::ofstream out(tempFnp.string());
+			if (!out) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error in opening " << tempFnp << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+			out << "#file\talgorithm\tsize\tmodTime\tinode\tdigest" << "\n";
+			for (const auto & entry : cache_) {
+				out << entry.first.first
+						<< "\t" << entry.first.second
+						<< "\t" << entry.second.size_
+						<< "\t" << entry.second.modTime_
+						<< "\t" << entry.second.inode_
+						<< "\t" << entry.second.digest_ << "\n";
+			}
+			if (!out) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error in writing " << tempFnp << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+		}
+		files::bfs::rename(tempFnp, cacheFnp_);
+		cacheChanged_ = false;
+	}
+
+	Algorithm algorithm() const {
+		return algorithm_;
+	}
+
+	/**@brief The number of files in the cache
+	 *
+	 */
+	size_t cacheSize() const {
+		std::lock_guard<std::mutex> lock(mut_);
+		return cache_.size();
+	}
+
+private:
+	static const uint64_t blockSize_ = 4 * 1024 * 1024;
+
+	Algorithm algorithm_;
+	uint32_t numThreads_;
+	files::bfs::path cacheFnp_;
+	mutable std::mutex mut_;
+	std::map<std::pair<std::string, std::string>, CacheEntry> cache_; /**< keyed by absolute path and algorithm name*/
+	bool cacheChanged_ = false;
+
+	static CacheEntry fileStats(const files::bfs::path & fnp) {
+		CacheEntry ret;
+		struct stat info;
+		if (0 != ::stat(fnp.c_str(), &info)) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in getting info for " << fnp << ": " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		ret.size_ = info.st_size;
+		ret.inode_ = info.st_ino;
+		ret.modTime_ = std::chrono::duration_cast<std::chrono::seconds>(
+				files::last_write_time(fnp).time_since_epoch()).count();
+		return ret;
+	}
+
+	Result hashFile(const files::bfs::path & fnp, std::vector<char> & buffer) {
+		Result ret;
+		ret.file_ = fnp;
+		auto stats = fileStats(fnp);
+		ret.size_ = stats.size_;
+		const auto key = std::make_pair(files::bfs::absolute(fnp).string(), algorithmName(algorithm_));
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			auto search = cache_.find(key);
+			if (cache_.end() != search
+					&& search->second.size_ == stats.size_
+					&& search->second.modTime_ == stats.modTime_
+					&& search->second.inode_ == stats.inode_) {
+				ret.digest_ = search->second.digest_;
+				ret.fromCache_ = true;
+				return ret;
+			}
+		}
+		ret.digest_ = hashFile(fnp, algorithm_, buffer);
+		//only trust the digest if the file didn't change while it was being read, and not for a file modified
+		//within the last couple seconds as the modification time only has whole seconds and it could change again unnoticed
+		auto statsAfter = fileStats(fnp);
+		const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+				std::chrono::system_clock::now().time_since_epoch()).count();
+		if ("" != cacheFnp_.string()
+				&& stats.modTime_ < now - 1
+				&& statsAfter.size_ == stats.size_
+				&& statsAfter.modTime_ == stats.modTime_
+				&& statsAfter.inode_ == stats.inode_) {
+			stats.digest_ = ret.digest_;
+			std::lock_guard<std::mutex> lock(mut_);
+			cache_[key] = stats;
+			cacheChanged_ = true;
+		}
+		return ret;
+	}
+
+	void loadCache() {
+		std::ifstream in(cacheFnp_.string());
+		if (!in) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in opening " << cacheFnp_ << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		std::string line;
+		while (std::getline(in, line)) {
+			if (line.empty() || '#' == line.front()) {
+				continue;
+			}
+			auto toks = tokenizeString(line, "\t");
+			if (6 != toks.size()) {
+				//skip a line cut short by a crash
+				continue;
+			}
+			CacheEntry entry;
+			try {
+				entry.size_ = std::stoull(toks[2]);
+				entry.modTime_ = std::stoll(toks[3]);
+				entry.inode_ = std::stoull(toks[4]);
+			} catch (const std::exception &) {
+				continue;
+			}
+			entry.digest_ = toks[5];
+			cache_[std::make_pair(toks[0], toks[1])] = entry;
+		}
+	}
+};
+
+}  // namespace njh
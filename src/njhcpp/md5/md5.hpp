@@ -32,6 +32,7 @@ documentation and/or software.
 */
 
 #include <cstring>
+#include <cstdint>
 #include <iostream>
 #include <cstdio>
 
@@ -69,43 +70,21 @@ public:
 	  finalize();
 	}
 	// MD5 block update operation. Continues an MD5 message-digest
-	// operation, processing another message block
-	void update(const unsigned char input[], size_type length)
+	// operation, processing another message block. Takes a 64 bit length,
+	// it's fed through in pieces small enough for the 32 bit bit counting
+	void update(const unsigned char input[], uint64_t length)
 	{
-	  // compute number of bytes mod 64
-	  size_type index = count[0] / 8 % blocksize;
-
-	  // Update number of bits
-	  if ((count[0] += (length << 3)) < (length << 3))
-	    count[1]++;
-	  count[1] += (length >> 29);
-
-	  // number of bytes we need to fill in buffer
-	  size_type firstpart = 64 - index;
-
-	  size_type i;
-
-	  // transform as many times as possible.
-	  if (length >= firstpart)
-	  {
-	    // fill buffer first, transform
-	    memcpy(&buffer[index], input, firstpart);
-	    transform(buffer);
-
-	    // transform chunks of blocksize (64 bytes)
-	    for (i = firstpart; i + blocksize <= length; i += blocksize)
-	      transform(&input[i]);
-
-	    index = 0;
+	  // keep length << 3 from overflowing 32 bits
+	  static const uint64_t maxPiece = 1UL << 28;
+	  while (length > maxPiece) {
+	    updatePiece(input, maxPiece);
+	    input += maxPiece;
+	    length -= maxPiece;
 	  }
-	  else
-	    i = 0;
-
-	  // buffer remaining input
-	  memcpy(&buffer[index], &input[i], length-i);
+	  updatePiece(input, length);
 	}
 	// for convenience provide a verson with signed char
-	void update(const char input[], size_type length)
+	void update(const char input[], uint64_t length)
 	{
 	  update((const unsigned char*)input, length);
 	}
@@ -161,6 +140,42 @@ public:
   friend std::ostream& operator<<(std::ostream&, MD5 md5);
 
 private:
+  // one piece of update(), length has to be under 2^29 so the bit count doesn't overflow
+  void updatePiece(const unsigned char input[], size_type length)
+  {
+    // compute number of bytes mod 64
+    size_type index = count[0] / 8 % blocksize;
+
+    // Update number of bits
+    if ((count[0] += (length << 3)) < (length << 3))
+      count[1]++;
+    count[1] += (length >> 29);
+
+    // number of bytes we need to fill in buffer
+    size_type firstpart = 64 - index;
+
+    size_type i;
+
+    // transform as many times as possible.
+    if (length >= firstpart)
+    {
+      // fill buffer first, transform
+      memcpy(&buffer[index], input, firstpart);
+      transform(buffer);
+
+      // transform chunks of blocksize (64 bytes)
+      for (i = firstpart; i + blocksize <= length; i += blocksize)
+        transform(&input[i]);
+
+      index = 0;
+    }
+    else
+      i = 0;
+
+    // buffer remaining input
+    memcpy(&buffer[index], &input[i], length-i);
+  }
+
   void init()
   {
     finalized=false;
@@ -9,6 +9,10 @@
 
 #include "njhcpp/md5/md5.hpp"
 #include "njhcpp/files.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <functional>
 
 namespace njh {
 
@@ -27,11 +31,110 @@ inline std::string md5(const std::string str)
     return md5.hexdigest();
 }
 
-inline std::string md5File(const files::bfs::path & fnp)
+/**@brief Hash everything left in a stream, read in blocks so the stream is never held in memory
+ *
+ * @param in the stream
+ * @param blockSize how much to read at a time
+ * @return the hex digest
+ */
+inline std::string md5Stream(std::istream & in, uint64_t blockSize = 4 * 1024 * 1024)
 {
-    MD5 md5 = MD5(files::get_file_contents(fnp, false));
+    MD5 md5;
+    std::vector<char> buffer(blockSize);
+    while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0) {
+        md5.update(buffer.data(), static_cast<uint64_t>(in.gcount()));
+    }
+    if (in.bad()) {
+        std::stringstream ss;
+        ss << __PRETTY_FUNCTION__ << ", error in reading stream" << "\n";
+        throw std::runtime_error { ss.str() };
+    }
+    return md5.finalize().hexdigest();
+}
 
-    return md5.hexdigest();
+/**@brief Read a file in large blocks with pread and hand each one to func, memory use doesn't grow with the file
+ *
+ * @param fnp the file
+ * @param blockSize how much to read at a time
+ * @param func called with each block and its length, in order
+ * @param buffer where to read into, resized to blockSize, passed in so threads hashing many files can reuse one
+ */
+inline void readFileBlocks(const files::bfs::path & fnp, uint64_t blockSize,
+		const std::function<void(const char *, uint64_t)> & func, std::vector<char> & buffer)
+{
+    int fd = ::open(fnp.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::stringstream ss;
+        ss << __PRETTY_FUNCTION__ << ", error in opening " << fnp << ": " << std::strerror(errno) << "\n";
+        throw std::runtime_error { ss.str() };
+    }
+#if defined(POSIX_FADV_SEQUENTIAL)
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    buffer.resize(blockSize);
+    uint64_t offset = 0;
+    try {
+        while (true) {
+            ssize_t got = ::pread(fd, buffer.data(), buffer.size(), offset);
+            if (got < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+                std::stringstream ss;
+                ss << __PRETTY_FUNCTION__ << ", error in reading " << fnp << " at " << offset << ": " << std::strerror(errno) << "\n";
+                throw std::runtime_error { ss.str() };
+            }
+            if (0 == got) {
+                break;
+            }
+            func(buffer.data(), static_cast<uint64_t>(got));
+            offset += got;
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+}
+
+/**@brief Hash a file's bytes, read in large blocks with pread so memory use doesn't grow with the file
+ *
+ * @param fnp the file
+ * @param blockSize how much to read at a time
+ * @return the hex digest
+ */
+inline std::string md5File(const files::bfs::path & fnp, uint64_t blockSize = 4 * 1024 * 1024)
+{
+    MD5 md5;
+    std::vector<char> buffer;
+    readFileBlocks(fnp, blockSize, [&md5](const char * data, uint64_t len) {
+        md5.update(data, len);
+    }, buffer);
+    return md5.finalize().hexdigest();
+}
+
+/**@brief Hash the decompressed contents of a gzipped file, so it matches md5File of the uncompressed file
+ *
+ * Files that aren't gzipped are read as they are, like zcat -f
+ *
+ * @param fnp the file
+ * @param blockSize how much to decompress at a time
+ * @return the hex digest
+ */
+inline std::string md5GzFileContents(const files::bfs::path & fnp, uint64_t blockSize = 4 * 1024 * 1024)
+{
+    if (!files::bfs::exists(fnp)) {
+        std::stringstream ss;
+        ss << __PRETTY_FUNCTION__ << ", error " << fnp << " doesn't exist" << "\n";
+        throw std::runtime_error { ss.str() };
+    }
+    GZSTREAM::igzstream in(fnp);
+    if (!in) {
+        std::stringstream ss;
+        ss << __PRETTY_FUNCTION__ << ", error in opening " << fnp << "\n";
+        throw std::runtime_error { ss.str() };
+    }
+    return md5Stream(in, blockSize);
 }
 
 }  // namespace njh
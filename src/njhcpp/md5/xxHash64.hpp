@@ -0,0 +1,169 @@
+#pragma once
+/*
+ * xxHash64.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// The XXH64 hash of Yann Collet's xxHash (BSD licensed), a fast
+// non-cryptographic checksum, many times faster than MD5 and good for
+// telling whether a file has changed. Digests match the reference
+// implementation's XXH64() and xxhsum -H1. Inputs are read as little endian.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <cstdio>
+
+namespace njh {
+
+class XXHash64 {
+public:
+	explicit XXHash64(uint64_t seed = 0) :
+			seed_(seed) {
+		reset();
+	}
+
+	/**@brief Start over
+	 *
+	 */
+	void reset() {
+		acc_[0] = seed_ + prime1_ + prime2_;
+		acc_[1] = seed_ + prime2_;
+		acc_[2] = seed_;
+		acc_[3] = seed_ - prime1_;
+		totalLength_ = 0;
+		bufferFilled_ = 0;
+	}
+
+	/**@brief Add more input
+	 *
+	 * @param input the bytes
+	 * @param length how many
+	 */
+	void update(const void * input, uint64_t length) {
+		const unsigned char * bytes = static_cast<const unsigned char *>(input);
+		totalLength_ += length;
+		if (bufferFilled_ + length < stripeSize_) {
+			std::memcpy(buffer_ + bufferFilled_, bytes, length);
+			bufferFilled_ += length;
+			return;
+		}
+		if (bufferFilled_ > 0) {
+			const uint64_t fill = stripeSize_ - bufferFilled_;
+			std::memcpy(buffer_ + bufferFilled_, bytes, fill);
+			processStripe(buffer_);
+			bytes += fill;
+			length -= fill;
+			bufferFilled_ = 0;
+		}
+		while (length >= stripeSize_) {
+			processStripe(bytes);
+			bytes += stripeSize_;
+			length -= stripeSize_;
+		}
+		std::memcpy(buffer_, bytes, length);
+		bufferFilled_ = length;
+	}
+
+	/**@brief The hash of everything added so far, more can still be added afterwards
+	 *
+	 */
+	uint64_t digest() const {
+		uint64_t hash = 0;
+		if (totalLength_ >= stripeSize_) {
+			hash = rotl(acc_[0], 1) + rotl(acc_[1], 7) + rotl(acc_[2], 12) + rotl(acc_[3], 18);
+			for (const auto acc : acc_) {
+				hash = mergeRound(hash, acc);
+			}
+		} else {
+			hash = seed_ + prime5_;
+		}
+		hash += totalLength_;
+		const unsigned char * bytes = buffer_;
+		uint64_t left = bufferFilled_;
+		while (left >= 8) {
+			hash ^= round(0, read64(bytes));
+			hash = rotl(hash, 27) * prime1_ + prime4_;
+			bytes += 8;
+			left -= 8;
+		}
+		if (left >= 4) {
+			hash ^= static_cast<uint64_t>(read32(bytes)) * prime1_;
+			hash = rotl(hash, 23) * prime2_ + prime3_;
+			bytes += 4;
+			left -= 4;
+		}
+		while (left > 0) {
+			hash ^= (*bytes) * prime5_;
+			hash = rotl(hash, 11) * prime1_;
+			++bytes;
+			--left;
+		}
+		hash ^= hash >> 33;
+		hash *= prime2_;
+		hash ^= hash >> 29;
+		hash *= prime3_;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	/**@brief The digest as 16 hex characters, big endian like xxhsum prints it
+	 *
+	 */
+	std::string hexdigest() const {
+		char buf[17];
+		std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(digest()));
+		return std::string(buf);
+	}
+
+private:
+	static const uint64_t prime1_ = 11400714785074694791ULL;
+	static const uint64_t prime2_ = 14029467366897019727ULL;
+	static const uint64_t prime3_ = 1609587929392839161ULL;
+	static const uint64_t prime4_ = 9650029242287828579ULL;
+	static const uint64_t prime5_ = 2870177450012600261ULL;
+	static const uint64_t stripeSize_ = 32;
+
+	uint64_t seed_;
+	uint64_t acc_[4];
+	uint64_t totalLength_ = 0;
+	unsigned char buffer_[stripeSize_];
+	uint64_t bufferFilled_ = 0;
+
+	static uint64_t rotl(uint64_t val, int bits) {
+		return (val << bits) | (val >> (64 - bits));
+	}
+
+	static uint64_t read64(const unsigned char * bytes) {
+		uint64_t ret;
+		std::memcpy(&ret, bytes, sizeof(ret));
+		return ret;
+	}
+
+	static uint32_t read32(const unsigned char * bytes) {
+		uint32_t ret;
+		std::memcpy(&ret, bytes, sizeof(ret));
+		return ret;
+	}
+
+	static uint64_t round(uint64_t acc, uint64_t input) {
+		acc += input * prime2_;
+		acc = rotl(acc, 31);
+		return acc * prime1_;
+	}
+
+	static uint64_t mergeRound(uint64_t hash, uint64_t acc) {
+		hash ^= round(0, acc);
+		return hash * prime1_ + prime4_;
+	}
+
+	void processStripe(const unsigned char * stripe) {
+		for (uint32_t lane = 0; lane < 4; ++lane) {
+			acc_[lane] = round(acc_[lane], read64(stripe + lane * 8));
+		}
+	}
+};
+
+}  // namespace njh
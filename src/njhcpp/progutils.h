@@ -9,3 +9,4 @@
 #include "njhcpp/progutils/FlagHolder.hpp"
 #include "njhcpp/progutils/ProgressBar.hpp"
 #include "njhcpp/progutils/CmdArgs.hpp"
+#include "njhcpp/progutils/BatchJournal.hpp"
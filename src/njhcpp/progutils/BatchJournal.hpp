@@ -0,0 +1,184 @@
+#pragma once
+/*
+ * BatchJournal.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// An append-only record of which batch commands have finished, one tab
+// separated line per finished command written and flushed as soon as it
+// finishes, so after a crash or a lost node a rerun of the batch can skip
+// the commands that already completed, whose inputs haven't changed since and
+// whose declared output files are still there with the same md5.
+
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <fstream>
+#include "njhcpp/utils.h"
+#include "njhcpp/files/fileUtilities.hpp" //files::last_write_time
+#include "njhcpp/md5/md5Utils.hpp"
+
+namespace njh {
+namespace progutils {
+
+class BatchJournal {
+public:
+	/**@brief One finished command
+	 *
+	 */
+	struct Entry {
+		std::string cmdHash_; /**< md5 of the command line*/
+		bool success_ = false; /**< whether the command succeeded*/
+		int32_t returnCode_ = 0; /**< the return code*/
+		int64_t startTime_ = 0; /**< when the command started, in seconds since the epoch*/
+		double time_ = 0; /**< how long the command took in seconds*/
+		std::vector<std::string> outputChecksums_; /**< md5 of each of the command's declared output files, in the order they were declared*/
+		std::string cmd_; /**< the command line*/
+	};
+
+	/**@brief Open a journal, loading the entries already in it
+	 *
+	 * @param fnp the journal file, created if it doesn't exist and appended to otherwise
+	 */
+	explicit BatchJournal(const files::bfs::path & fnp) :
+			fnp_(fnp) {
+		bool endsMidLine = false;
+		{
+			std::ifstream in(fnp_.string(), std::ios::binary);
+			std::string line;
+			while (std::getline(in, line)) {
+				Entry entry;
+				if (parseLine(line, entry)) {
+					//a command can be in the journal more than once, the last entry wins
+					entries_[entry.cmdHash_] = entry;
+				}
+			}
+			in.clear();
+			in.seekg(0, std::ios::end);
+			if (in && in.tellg() > 0) {
+				in.seekg(-1, std::ios::end);
+				endsMidLine = '\n' != in.get();
+			}
+		}
+		out_.open(fnp_.string(), std::ios::app);
+		if (!out_) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in opening " << fnp_ << " for appending\n";
+			throw std::runtime_error { ss.str() };
+		}
+		if (endsMidLine) {
+			//the last record was cut off by a crash, end it so the next one starts on its own line
+			out_ << std::endl;
+		}
+	}
+
+	static std::string hashCmd(const std::string & cmd) {
+		return njh::md5(cmd);
+	}
+
+	/**@brief The current time in the form stored in Entry::startTime_
+	 *
+	 */
+	static int64_t now() {
+		return std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+	}
+
+	/**@brief The md5 of each output file, for Entry::outputChecksums_, a missing file gets NA
+	 *
+	 */
+	static std::vector<std::string> checksumOutputs(const std::vector<files::bfs::path> & outputs) {
+		std::vector<std::string> ret;
+		for (const auto & output : outputs) {
+			ret.emplace_back(files::bfs::is_regular_file(output) ? md5File(output) : "NA");
+		}
+		return ret;
+	}
+
+	/**@brief Whether a command finished successfully before, none of its inputs have been modified since it started and its outputs are unchanged
+	 *
+	 * @param cmd the command line
+	 * @param inputs the files the command reads
+	 * @param outputs the files the command writes, each has to still exist with the md5 recorded when the command finished
+	 * @return true if the command can be skipped
+	 */
+	bool isDone(const std::string & cmd, const std::vector<files::bfs::path> & inputs,
+			const std::vector<files::bfs::path> & outputs = std::vector<files::bfs::path>{}) const {
+		Entry entry;
+		{
+			std::lock_guard<std::mutex> lock(mut_);
+			auto search = entries_.find(hashCmd(cmd));
+			if (entries_.end() == search || !search->second.success_) {
+				return false;
+			}
+			entry = search->second;
+		}
+		const auto started = std::chrono::system_clock::from_time_t(entry.startTime_);
+		//write times only have second resolution so an input written in the second the command started counts as changed
+		bool inputsUnchanged = std::all_of(inputs.begin(), inputs.end(), [&started](const files::bfs::path & fnp) {
+			return files::bfs::exists(fnp) && files::last_write_time(fnp) < started;
+		});
+		//outputs are checked last as it means reading them, a missing output means the command has to be rerun
+		return inputsUnchanged && outputs.size() == entry.outputChecksums_.size()
+				&& std::all_of(outputs.begin(), outputs.end(), [](const files::bfs::path & fnp) {
+					return files::bfs::is_regular_file(fnp);
+				})
+				&& checksumOutputs(outputs) == entry.outputChecksums_;
+	}
+
+	/**@brief Add an entry, written and flushed right away
+	 *
+	 */
+	void record(Entry entry) {
+		if ("" == entry.cmdHash_) {
+			entry.cmdHash_ = hashCmd(entry.cmd_);
+		}
+		std::lock_guard<std::mutex> lock(mut_);
+		out_ << entry.cmdHash_
+				<< "\t" << (entry.success_ ? "done" : "failed")
+				<< "\t" << entry.returnCode_
+				<< "\t" << entry.startTime_
+				<< "\t" << entry.time_
+				<< "\t" << (entry.outputChecksums_.empty() ? std::string("NA") : njh::conToStr(entry.outputChecksums_, ","))
+				<< "\t" << replaceString(replaceString(entry.cmd_, "\t", " "), "\n", " ") << std::endl;
+		entries_[entry.cmdHash_] = entry;
+	}
+
+	const files::bfs::path & fnp() const {
+		return fnp_;
+	}
+
+private:
+	files::bfs::path fnp_;
+	std::ofstream out_;
+	std::map<std::string, Entry> entries_; /**< the last entry for each command hash*/
+	mutable std::mutex mut_;
+
+	/**@brief Parse a journal line, lines cut short by a crash are skipped
+	 *
+	 */
+	static bool parseLine(const std::string & line, Entry & entry) {
+		auto toks = tokenizeString(line, "\t");
+		if (toks.size() < 7) {
+			return false;
+		}
+		try {
+			entry.cmdHash_ = toks[0];
+			entry.success_ = "done" == toks[1];
+			entry.returnCode_ = std::stoi(toks[2]);
+			entry.startTime_ = std::stoll(toks[3]);
+			entry.time_ = std::stod(toks[4]);
+			if ("NA" != toks[5]) {
+				entry.outputChecksums_ = tokenizeString(toks[5], ",");
+			}
+			entry.cmd_ = toks[6];
+		} catch (const std::exception &) {
+			return false;
+		}
+		return 32 == entry.cmdHash_.size();
+	}
+};
+
+}  // namespace progutils
+}  // namespace njh
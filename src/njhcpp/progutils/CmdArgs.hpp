@@ -469,6 +469,28 @@ public:
 		return ss.str();
 	}
 
+	/**@brief The arguments as an argv that would parse back into these arguments, for running the program again e.g. in another process
+	 *
+	 * @return the program, the sub-program if there is one and then each flag, flags with values starting with a dash are given as flag=value
+	 */
+	std::vector<std::string> toArgv() const {
+		std::vector<std::string> ret { masterProgramRaw_ };
+		if ("" != subProgram_) {
+			ret.emplace_back(subProgram_);
+		}
+		for (const auto & arg : arguments_) {
+			if ("" == arg.second) {
+				ret.emplace_back(arg.first);
+			} else if (beginsWith(arg.second, "-")) {
+				ret.emplace_back(arg.first + "=" + arg.second);
+			} else {
+				ret.emplace_back(arg.first);
+				ret.emplace_back(arg.second);
+			}
+		}
+		return ret;
+	}
+
 	/**@brief Reset the command line call with what is currently stored in arguments
 	 *
 	 */
@@ -10,6 +10,10 @@
 #include "njhcpp/utils.h"
 #include "njhcpp/progutils/programSetUp.hpp"
 #include "njhcpp/concurrency.h"
+#include "njhcpp/system/RunOutput.hpp" //ResourceUsage
+#include "njhcpp/system/ProcessScheduler.hpp"
+#include "njhcpp/progutils/BatchJournal.hpp"
+#include <numeric>
 #include <thread>
 namespace njh{
 namespace progutils {
@@ -206,12 +210,17 @@ class ProgramRunner {
    *
    */
   virtual int batchRun(CmdArgs inputCommands) {
-    std::vector<std::string> batchFlags{"-ending", "--ending", "-pattern", "--pattern", "-run", "--run", "batch"};
+    std::vector<std::string> batchFlags{"-ending", "--ending", "-pattern", "--pattern", "-run", "--run", "batch", "-batchResume", "--batchResume",
+    	"-batchOutputs", "--batchOutputs"};
     std::string ending = "", program = "", pattern = "";
     ProgramSetUp setUp(inputCommands);
     bool endFlag = setUp.setOption(ending , "-ending", "A file extension to run batch commands on", false);
     setUp.setOption(pattern, "-pattern", "File Pattern to run batch command", !endFlag);
     setUp.setOption(program, "-run", "ProgramToRun", true);
+    bool resume = false;
+    setUp.setOption(resume, "-batchResume", "Skip commands the batch journal records as done whose input file hasn't changed since");
+    std::string outputs = "";
+    setUp.setOption(outputs, "-batchOutputs", "Comma separated output files of each command, THIS is replaced like in the arguments, their md5s are journaled and with -batchResume a command is rerun if they changed");
     if(setUp.commands_.gettingFlags()){
     	std::cout << bashCT::boldGreen("Batch") << bashCT::boldBlack(" Commands") << std::endl;
     	setUp.printFlags(std::cout);
@@ -245,6 +254,8 @@ class ProgramRunner {
     	inputCommands.removeArgumentCaseInsen(flag);
     }
     inputCommands.subProgram_ = program;
+    BatchJournal journal(batchJournalName(inputCommands));
+    runLog << "Journal: " << journal.fnp().string() << std::endl;
     // gather the necessary files
     if(endFlag){
     	pattern = ".*" + ending;
@@ -258,7 +269,7 @@ class ProgramRunner {
   	}
     // run the command on each file
     for (const auto &file : specificFiles) {
-      if (containsSubString(file.string(), "batchRunLog")) {
+      if (isBatchBookkeepingFile(file)) {
         continue;
       }
       CmdArgs currentCommands = inputCommands;
@@ -266,13 +277,28 @@ class ProgramRunner {
         com.second = replaceString(com.second, "THIS", file.filename().string() );
       }
       currentCommands.resetCommandLine();
+      const auto outputFiles = batchOutputFiles(outputs, file.filename().string());
+      if (resume && journal.isDone(currentCommands.commandLine_, {file}, outputFiles)) {
+        runLog << currentCommands.commandLine_ << std::endl;
+        runLog << "\tSkipped, already done" << std::endl;
+        continue;
+      }
       // log current run command
       std::cout << currentCommands.commandLine_ << std::endl;
       runLog << currentCommands.commandLine_ << std::endl;
       std::cout << std::endl;
       // run the current command
       stopWatch watch;
-      runProgram(currentCommands);
+      BatchJournal::Entry entry;
+      entry.startTime_ = BatchJournal::now();
+      entry.returnCode_ = runProgram(currentCommands);
+      entry.success_ = 0 == entry.returnCode_;
+      entry.time_ = watch.totalTime();
+      entry.cmd_ = currentCommands.commandLine_;
+      if (entry.success_) {
+        entry.outputChecksums_ = BatchJournal::checksumOutputs(outputFiles);
+      }
+      journal.record(entry);
       std::cout << "\tCurrent Command Run Time: " << watch.totalTimeFormatted(6) << std::endl;
       runLog << "\tCurrent Command Run Time: " << watch.totalTimeFormatted(6) << std::endl;
       setUp.logRunTime(runLog);
@@ -288,12 +314,15 @@ class ProgramRunner {
    *
    * @param inputCommands A map of string pairs with argument and flag pairs,
    *should contain -ending for file extension and -run for subprogram to run and
-   *-numThreads for number of threads
-   * @return int indicating run success
+   *-numThreads for number of threads, -batchProcesses runs each command in its own process
+   *(see batchRunProcesses) with -batchRetries and -batchSummary
+   * @return int indicating run success, 0 if every command returned 0
    *
    */
   virtual int batchRunThreaded(CmdArgs inputCommands) {
-    std::vector<std::string> batchFlags{"-ending", "--ending", "-pattern", "--pattern", "-run", "--run", "batchthreaded", "-batchthreads", "--batchthreads"};
+    std::vector<std::string> batchFlags{"-ending", "--ending", "-pattern", "--pattern", "-run", "--run", "batchthreaded", "-batchthreads", "--batchthreads",
+    	"-batchProcesses", "--batchProcesses", "-batchRetries", "--batchRetries", "-batchSummary", "--batchSummary",
+    	"-batchResume", "--batchResume", "-batchOutputs", "--batchOutputs"};
     std::string ending = "", program = "", pattern = "";
     ProgramSetUp setUp(inputCommands);
     bool endFlag = setUp.setOption(ending , "-ending", "A file extension to run batch commands on", false);
@@ -301,6 +330,16 @@ class ProgramRunner {
     setUp.setOption(program, "-run", "Program To Run a Batch of Commands with", true);
     uint32_t numThreads = 2;
     setUp.setOption(numThreads, "-batchThreads", "Number of Threads use for the batch commands");
+    bool resume = false;
+    setUp.setOption(resume, "-batchResume", "Skip commands the batch journal records as done whose input file hasn't changed since");
+    std::string outputs = "";
+    setUp.setOption(outputs, "-batchOutputs", "Comma separated output files of each command, THIS is replaced like in the arguments, their md5s are journaled and with -batchResume a command is rerun if they changed");
+    bool processes = false;
+    setUp.setOption(processes, "-batchProcesses", "Run each command in its own process so one that exits or crashes doesn't take down the batch");
+    uint32_t retries = 0;
+    setUp.setOption(retries, "-batchRetries", "Number of times to retry a failed command, with -batchProcesses");
+    std::string summaryPrefix = "";
+    setUp.setOption(summaryPrefix, "-batchSummary", "Prefix for the .json and .tsv summary of each command's exit code, time and resource usage, with -batchProcesses");
     if(setUp.commands_.gettingFlags()){
     	std::cout << bashCT::boldGreen("Batch") << bashCT::boldBlack(" Commands") << std::endl;
     	setUp.printFlags(std::cout);
@@ -334,6 +373,8 @@ class ProgramRunner {
     	inputCommands.removeArgumentCaseInsen(flag);
     }
     inputCommands.subProgram_ = program;
+    BatchJournal journal(batchJournalName(inputCommands));
+    runLog << "Journal: " << journal.fnp().string() << std::endl;
     // gather the necessary files
     if(endFlag){
     	pattern = ".*" + ending;
@@ -347,8 +388,9 @@ class ProgramRunner {
   	}
     // run the command on each file
     std::vector<std::shared_ptr<CmdArgs>> allCommands;
+    std::map<std::string, std::vector<files::bfs::path>> outputsByCmd;
     for (const auto &file : specificFiles) {
-      if (containsSubString(file.string(), "batchRunLog")) {
+      if (isBatchBookkeepingFile(file)) {
         continue;
       }
       CmdArgs currentCommands = inputCommands;
@@ -356,36 +398,188 @@ class ProgramRunner {
         com.second = replaceString(com.second, "THIS", file.filename().string() );
       }
       currentCommands.resetCommandLine();
+      const auto outputFiles = batchOutputFiles(outputs, file.filename().string());
+      if (resume && journal.isDone(currentCommands.commandLine_, {file}, outputFiles)) {
+        runLog << currentCommands.commandLine_ << std::endl;
+        runLog << "\tSkipped, already done" << std::endl;
+        continue;
+      }
+      outputsByCmd[currentCommands.commandLine_] = outputFiles;
       allCommands.emplace_back(std::make_shared<CmdArgs>(currentCommands));
     }
+    if (processes) {
+      if ("" == summaryPrefix) {
+        summaryPrefix = "batchRunSummary_" + inputCommands.masterProgram_ + "-" + program + "_" + getCurrentDate();
+      }
+      bool allSucceeded = batchRunProcesses(allCommands, numThreads, retries, runLog, summaryPrefix, journal, outputsByCmd);
+      setUp.logRunTime(runLog);
+      setUp.logRunTime(std::cout);
+      return allSucceeded ? 0 : 1;
+    }
     concurrent::LockableQueue<std::shared_ptr<CmdArgs>> argPool(allCommands);
-  	std::vector<std::thread> threads;
   	std::mutex logMut;
-  	auto runCmds = [this,&logMut,&runLog](concurrent::LockableQueue<std::shared_ptr<CmdArgs>> & pool){
+  	bool allSucceeded = true;
+  	auto runCmds = [this,&logMut,&runLog,&allSucceeded,&journal,&outputsByCmd](concurrent::LockableQueue<std::shared_ptr<CmdArgs>> & pool){
   				std::shared_ptr<CmdArgs> currentCmd;
 					while(pool.getVal(currentCmd)) {
 			      stopWatch watch;
-						runProgram(*currentCmd);
+			      auto startUsage = sys::ResourceUsage::currentThread();
+			      BatchJournal::Entry entry;
+			      entry.startTime_ = BatchJournal::now();
+						int returnCode = runProgram(*currentCmd);
+						auto usage = sys::ResourceUsage::currentThread().since(startUsage);
+						usage.wallTime_ = watch.totalTime();
+						entry.success_ = 0 == returnCode;
+						entry.returnCode_ = returnCode;
+						entry.time_ = usage.wallTime_;
+						entry.cmd_ = currentCmd->commandLine_;
+						if (entry.success_) {
+							entry.outputChecksums_ = BatchJournal::checksumOutputs(outputsByCmd.at(currentCmd->commandLine_));
+						}
+						journal.record(entry);
 						{
 							std::lock_guard<std::mutex> lock(logMut);
 							runLog << currentCmd->commandLine_ << std::endl;
 							runLog << "\tRun Time: " << watch.totalTimeFormatted(6) << std::endl;
+							runLog << "\tReturn Code: " << returnCode << std::endl;
+							runLog << "\tUsage: " << usage.summary() << std::endl;
+							if (0 != returnCode) {
+								allSucceeded = false;
+							}
 						}
 					}
   	};
-  	for (uint32_t t = 0; t < numThreads; ++t) {
-  		threads.emplace_back(std::thread(runCmds, std::ref(argPool)));
-  	}
-  	for (auto &t : threads) {
-  		t.join();
-  	}
+  	std::function<void()> runCmdsFunc = [&runCmds, &argPool]() {
+  		runCmds(argPool);
+  	};
+  	concurrent::runVoidFunctionThreaded(runCmdsFunc, numThreads);
     setUp.logRunTime(runLog);
     setUp.logRunTime(std::cout);
-    return 0;
+    return allSucceeded ? 0 : 1;
   }
 
+  /**@brief Run each command as a separate copy of this executable, at most numThreads at a time, retrying failures
+   *
+   * @param allCommands the commands to run
+   * @param numThreads the max number of processes running at once
+   * @param retries the number of times to rerun a command that fails
+   * @param runLog log of each command's exit code, time and resource usage
+   * @param summaryPrefix written to summaryPrefix.json (everything, including the output of each command) and summaryPrefix.tsv (one line per command)
+   * @param journal each attempt is recorded here as soon as it finishes, with the md5s of its output files if it succeeded
+   * @param outputsByCmd the output files of each command by command line, commands not in it have none
+   * @return whether every command eventually succeeded
+   */
+  virtual bool batchRunProcesses(const std::vector<std::shared_ptr<CmdArgs>> & allCommands,
+  		uint32_t numThreads, uint32_t retries, std::ostream & runLog,
+  		const std::string & summaryPrefix, BatchJournal & journal,
+  		const std::map<std::string, std::vector<files::bfs::path>> & outputsByCmd = {}) const {
+  	std::vector<std::string> cmds;
+  	for (const auto & cmd : allCommands) {
+  		auto argv = cmd->toArgv();
+  		argv.front() = sys::currentExecutable(cmd->masterProgramRaw_);
+  		std::string cmdStr;
+  		for (const auto & arg : argv) {
+  			if ("" != cmdStr) {
+  				cmdStr += " ";
+  			}
+  			cmdStr += sys::shellQuote(arg);
+  		}
+  		cmds.emplace_back(cmdStr);
+  	}
+  	sys::ProcessSchedulerPars pars;
+  	pars.maxConcurrent_ = numThreads;
+  	sys::ProcessScheduler scheduler(pars);
+  	std::vector<sys::RunOutput> results(cmds.size());
+  	std::vector<uint32_t> attempts(cmds.size(), 0);
+  	std::vector<size_t> toRun(cmds.size());
+  	std::iota(toRun.begin(), toRun.end(), 0);
+  	for (uint32_t attempt = 0; attempt <= retries && !toRun.empty(); ++attempt) {
+  		std::vector<std::string> batch;
+  		for (const auto index : toRun) {
+  			batch.emplace_back(cmds[index]);
+  		}
+  		auto outputs = scheduler.run(batch, [&](size_t index, const sys::RunOutput & output) {
+  			BatchJournal::Entry entry;
+  			entry.success_ = output.success_;
+  			entry.returnCode_ = output.returnCode_;
+  			entry.startTime_ = BatchJournal::now() - static_cast<int64_t>(std::ceil(output.time_));
+  			entry.time_ = output.time_;
+  			entry.cmd_ = allCommands[toRun[index]]->commandLine_;
+  			auto outputFiles = outputsByCmd.find(entry.cmd_);
+  			if (entry.success_ && outputsByCmd.end() != outputFiles) {
+  				entry.outputChecksums_ = BatchJournal::checksumOutputs(outputFiles->second);
+  			}
+  			journal.record(entry);
+  		});
+  		std::vector<size_t> failed;
+  		for (size_t pos = 0; pos < toRun.size(); ++pos) {
+  			results[toRun[pos]] = outputs[pos];
+  			++attempts[toRun[pos]];
+  			if (!outputs[pos].success_) {
+  				failed.emplace_back(toRun[pos]);
+  			}
+  		}
+  		toRun = failed;
+  	}
+  	Json::Value summaryJson(Json::arrayValue);
+  	std::ofstream summaryTsv;
+  	files::openTextFile(summaryTsv, summaryPrefix + ".tsv", ".tsv", false, true);
+  	summaryTsv << "cmd\tsuccess\treturnCode\tattempts\twallTime\tuserTime\tsysTime\tmaxRssKb"
+  			<< "\tvoluntaryCtxSwitches\tinvoluntaryCtxSwitches\tcharsRead\tcharsWritten\tbytesRead\tbytesWritten" << std::endl;
+  	for (size_t pos = 0; pos < results.size(); ++pos) {
+  		const auto & result = results[pos];
+  		const auto & usage = result.usage_;
+  		runLog << allCommands[pos]->commandLine_ << std::endl;
+  		runLog << "\tRun Time: " << result.time_ << std::endl;
+  		runLog << "\tReturn Code: " << result.returnCode_ << ", attempts: " << attempts[pos] << std::endl;
+  		runLog << "\tUsage: " << usage.summary() << std::endl;
+  		if (!result.success_) {
+  			runLog << "\tError: " << result.stdErr_ << std::endl;
+  		}
+  		auto resultJson = result.toJson();
+  		resultJson["attempts_"] = attempts[pos];
+  		summaryJson.append(resultJson);
+  		summaryTsv << result.cmd_ << "\t" << njh::boolToStr(result.success_) << "\t" << result.returnCode_ << "\t" << attempts[pos]
+  				<< "\t" << usage.wallTime_ << "\t" << usage.userTime_ << "\t" << usage.sysTime_ << "\t" << usage.maxRssKb_
+  				<< "\t" << usage.voluntaryCtxSwitches_ << "\t" << usage.involuntaryCtxSwitches_
+  				<< "\t" << usage.charsRead_ << "\t" << usage.charsWritten_ << "\t" << usage.bytesRead_ << "\t" << usage.bytesWritten_ << std::endl;
+  	}
+  	std::ofstream summaryJsonFile;
+  	files::openTextFile(summaryJsonFile, summaryPrefix + ".json", ".json", false, true);
+  	summaryJsonFile << summaryJson << std::endl;
+  	return std::all_of(results.begin(), results.end(), [](const sys::RunOutput & result) {return result.success_;});
+  }
 
  protected:
+  /**@brief Whether a file is one of the logs, journals or summaries written by the batch runs so it isn't picked up as an input
+   *
+   */
+  static bool isBatchBookkeepingFile(const files::bfs::path & fnp) {
+    return containsSubString(fnp.string(), "batchRunLog") || containsSubString(fnp.string(), "batchRunJournal")
+        || containsSubString(fnp.string(), "batchRunSummary");
+  }
+
+  /**@brief The output files given with -batchOutputs for the command run on an input file
+   *
+   * @param outputs comma separated file names, THIS is replaced with fileName
+   * @param fileName the name of the input file
+   */
+  static std::vector<files::bfs::path> batchOutputFiles(const std::string & outputs, const std::string & fileName) {
+    std::vector<files::bfs::path> ret;
+    for (const auto & output : tokenizeString(outputs, ",")) {
+      if ("" != output) {
+        ret.emplace_back(replaceString(output, "THIS", fileName));
+      }
+    }
+    return ret;
+  }
+
+  /**@brief The journal for a batch, the name has no date so a rerun of the same batch finds it
+   *
+   */
+  static std::string batchJournalName(const CmdArgs & inputCommands) {
+    return "batchRunJournal_" + inputCommands.masterProgram_ + "-" + inputCommands.subProgram_ + ".tsv";
+  }
   /**@brief A function to add the subprogram funcInfo struct
    *
    * @param title The name of the subprogram
@@ -0,0 +1,492 @@
+#pragma once
+/*
+ * ChildProcess.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Run an external command through /bin/sh with its stdout and stderr on pipes
+// and drain both pipes at the same time with poll(), handing the output to
+// caller supplied sinks as it arrives. Nothing has to be held in memory and a
+// command can't stall by filling one pipe while the other is being read.
+
+#include <string>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <chrono>
+#if defined(__APPLE__)
+#include <mach-o/dyld.h> //_NSGetExecutablePath
+#endif
+#include "njhcpp/IO/OutputStream.hpp"
+#include "njhcpp/utils/time.h" //stopWatch
+#include "njhcpp/system/RunOutput.hpp"
+
+namespace njh {
+namespace sys {
+
+/**@brief Something that takes output from a process as it's read, called with each block of data read from a pipe
+ *
+ */
+typedef std::function<void(const char * data, size_t len)> OutputSink;
+
+/**@brief A sink that throws away the output
+ *
+ */
+inline OutputSink discardSink() {
+	return [](const char *, size_t) {};
+}
+
+/**@brief A sink that writes to a std::ostream, the stream has to outlive the sink
+ *
+ */
+inline OutputSink ostreamSink(std::ostream & out) {
+	return [&out](const char * data, size_t len) {
+		out.write(data, len);
+	};
+}
+
+/**@brief A sink that writes to an OutputStream, locking its mutex so several processes can share one, the stream has to outlive the sink
+ *
+ */
+inline OutputSink outputStreamSink(OutputStream & out) {
+	return [&out](const char * data, size_t len) {
+		std::lock_guard<std::mutex> lock(out.mut_);
+		out.write(data, len);
+	};
+}
+
+/**@brief A sink that appends to a std::string, the string has to outlive the sink
+ *
+ */
+inline OutputSink stringSink(std::string & out) {
+	return [&out](const char * data, size_t len) {
+		out.append(data, len);
+	};
+}
+
+/**@brief Keep at most a set number of bytes of output, the first bytes are kept and the rest is counted and dropped
+ *
+ */
+class CappedBuffer {
+	size_t cap_; /**< the max number of bytes to keep*/
+	std::string buf_; /**< the kept output*/
+	size_t totalBytes_ = 0; /**< all the bytes seen including the dropped ones*/
+public:
+	explicit CappedBuffer(size_t cap) :
+			cap_(cap) {
+	}
+
+	void add(const char * data, size_t len) {
+		totalBytes_ += len;
+		if (buf_.size() < cap_) {
+			buf_.append(data, std::min(len, cap_ - buf_.size()));
+		}
+	}
+
+	/**@brief A sink that adds to this buffer, the buffer has to outlive the sink
+	 *
+	 */
+	OutputSink sink() {
+		return [this](const char * data, size_t len) {
+			add(data, len);
+		};
+	}
+
+	const std::string & str() const {
+		return buf_;
+	}
+
+	bool truncated() const {
+		return totalBytes_ > buf_.size();
+	}
+
+	size_t totalBytes() const {
+		return totalBytes_;
+	}
+};
+
+/**@brief A command run by /bin/sh -c with stdout and stderr connected to pipes
+ *
+ */
+class ChildProcess {
+	std::string cmd_; /**< the command*/
+	pid_t pid_ = -1; /**< the process id of the shell running the command*/
+	int outFd_ = -1; /**< read end of the stdout pipe*/
+	int errFd_ = -1; /**< read end of the stderr pipe*/
+	bool waited_ = false; /**< whether the process has been reaped*/
+	int status_ = 0; /**< the status from waitpid*/
+	bool ownProcessGroup_ = false; /**< whether the command was started in its own process group*/
+	std::chrono::steady_clock::time_point start_; /**< when the process was started*/
+	ResourceUsage usage_; /**< filled in when the process is reaped*/
+
+	/**@brief Once the process has exited but before it's reaped, read its /proc io file while it's still there
+	 *
+	 */
+	void recordIo() {
+#if defined(__linux__)
+		usage_.setIoFromProc("/proc/" + std::to_string(pid_) + "/io");
+#endif
+	}
+
+	/**@brief Record the resources used once the process has been reaped
+	 *
+	 */
+	void setUsage(const struct rusage & usage) {
+		usage_.wallTime_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+		usage_.setFromRusage(usage);
+	}
+
+	/**@brief Wait for the process to exit without reaping it, so /proc/<pid>/io can still be read
+	 *
+	 * @param block whether to wait or just check
+	 * @return whether the process has exited
+	 */
+	bool waitForExit(bool block) {
+		siginfo_t info;
+		while (true) {
+			info.si_pid = 0;
+			if (0 == ::waitid(P_PID, pid_, &info, WEXITED | WNOWAIT | (block ? 0 : WNOHANG))) {
+				return info.si_pid == pid_;
+			}
+			if (EINTR != errno) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error in waiting on " << cmd_ << ": " << std::strerror(errno) << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+			if (!block) {
+				return false;
+			}
+		}
+	}
+
+	/**@brief Make a pipe that won't leak into processes started from other threads, otherwise a copy of the write end held by another child would keep the pipe from ever reaching end of file
+	 *
+	 */
+	static void makePipe(int fds[2]) {
+#if defined(__linux__)
+		int failed = ::pipe2(fds, O_CLOEXEC);
+#else
+		int failed = ::pipe(fds);
+		if (0 == failed) {
+			::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+			::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+		}
+#endif
+		if (0 != failed) {
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in creating pipe: " << std::strerror(errno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+	}
+
+	static void closeFd(int & fd) {
+		if (fd >= 0) {
+			::close(fd);
+			fd = -1;
+		}
+	}
+
+	/**@brief Read what's available from fd and hand it to sink, closes fd at end of file
+	 *
+	 */
+	static void readInto(int & fd, const OutputSink & sink, std::vector<char> & buffer) {
+		ssize_t got = ::read(fd, buffer.data(), buffer.size());
+		if (got > 0) {
+			sink(buffer.data(), got);
+		} else if (0 == got || (EINTR != errno && EAGAIN != errno)) {
+			closeFd(fd);
+		}
+	}
+
+public:
+	static const size_t readBufferSize = 64 * 1024;
+
+	/**@brief Start the command
+	 *
+	 * @param cmd the command, run with /bin/sh -c so it can contain pipes, redirects etc.
+	 * @param ownProcessGroup whether to put the command in its own process group so kill() reaches everything it started,
+	 * the command then no longer gets signals sent to our process group like a Ctrl-C from the terminal
+	 */
+	explicit ChildProcess(const std::string & cmd, bool ownProcessGroup = false) :
+			cmd_(cmd), ownProcessGroup_(ownProcessGroup) {
+		int outPipe[2];
+		int errPipe[2];
+		makePipe(outPipe);
+		try {
+			makePipe(errPipe);
+		} catch (...) {
+			::close(outPipe[0]);
+			::close(outPipe[1]);
+			throw;
+		}
+		start_ = std::chrono::steady_clock::now();
+		pid_ = ::fork();
+		if (pid_ < 0) {
+			int forkErrno = errno;
+			for (int fd : { outPipe[0], outPipe[1], errPipe[0], errPipe[1] }) {
+				::close(fd);
+			}
+			std::stringstream ss;
+			ss << __PRETTY_FUNCTION__ << ", error in forking to run " << cmd_ << ": " << std::strerror(forkErrno) << "\n";
+			throw std::runtime_error { ss.str() };
+		}
+		if (0 == pid_) {
+			//child, dup2 clears close on exec for the new descriptors
+			if (ownProcessGroup) {
+				::setpgid(0, 0);
+			}
+			::dup2(outPipe[1], STDOUT_FILENO);
+			::dup2(errPipe[1], STDERR_FILENO);
+			::execl("/bin/sh", "sh", "-c", cmd_.c_str(), static_cast<char *>(nullptr));
+			::_exit(127);
+		}
+		if (ownProcessGroup) {
+			//set from both sides so the group exists whichever process gets there first
+			::setpgid(pid_, pid_);
+		}
+		::close(outPipe[1]);
+		::close(errPipe[1]);
+		outFd_ = outPipe[0];
+		errFd_ = errPipe[0];
+	}
+
+	ChildProcess(const ChildProcess & other) = delete;
+	ChildProcess & operator=(const ChildProcess & other) = delete;
+
+	/**@brief Close the pipes and reap the process so it doesn't become a zombie, a command that hasn't been waited on is sent SIGTERM first (its whole group if it has its own) so this doesn't block until it finishes on its own
+	 *
+	 */
+	~ChildProcess() {
+		closeFd(outFd_);
+		closeFd(errFd_);
+		if (!waited_ && pid_ > 0) {
+			kill(SIGTERM);
+			int status = 0;
+			while (::waitpid(pid_, &status, 0) < 0 && EINTR == errno) {
+			}
+		}
+	}
+
+	pid_t pid() const {
+		return pid_;
+	}
+
+	const std::string & cmd() const {
+		return cmd_;
+	}
+
+	/**@brief The read end of the stdout pipe, -1 once it has been closed
+	 *
+	 */
+	int outFd() const {
+		return outFd_;
+	}
+
+	/**@brief The read end of the stderr pipe, -1 once it has been closed
+	 *
+	 */
+	int errFd() const {
+		return errFd_;
+	}
+
+	/**@brief Whether both stdout and stderr have reached end of file
+	 *
+	 */
+	bool outputDone() const {
+		return outFd_ < 0 && errFd_ < 0;
+	}
+
+	/**@brief Read once from whichever of stdout or stderr fd is, for driving several processes from one poll() loop
+	 *
+	 * @param fd either outFd() or errFd()
+	 * @param outSink gets stdout
+	 * @param errSink gets stderr
+	 * @param buffer the buffer to read into
+	 */
+	void readFrom(int fd, const OutputSink & outSink, const OutputSink & errSink,
+			std::vector<char> & buffer) {
+		if (fd >= 0 && fd == outFd_) {
+			readInto(outFd_, outSink, buffer);
+		} else if (fd >= 0 && fd == errFd_) {
+			readInto(errFd_, errSink, buffer);
+		}
+	}
+
+	/**@brief Send a signal to the command, to its whole process group if it was started in its own
+	 *
+	 * @param sig the signal, e.g. SIGTERM or SIGKILL
+	 */
+	void kill(int sig) {
+		if (pid_ > 0 && !waited_) {
+			::kill(ownProcessGroup_ ? -pid_ : pid_, sig);
+		}
+	}
+
+	/**@brief Reap the process if it has finished without blocking
+	 *
+	 * @return whether the process has finished
+	 */
+	bool tryWait() {
+		if (!waited_) {
+			if (!waitForExit(false)) {
+				return false;
+			}
+			recordIo();
+			struct rusage usage;
+			pid_t reaped = ::wait4(pid_, &status_, WNOHANG, &usage);
+			if (reaped == pid_) {
+				waited_ = true;
+				setUsage(usage);
+			} else if (reaped < 0 && EINTR != errno) {
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error in waiting on " << cmd_ << ": " << std::strerror(errno) << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+		}
+		return waited_;
+	}
+
+	/**@brief Read the command's stdout and stderr until both are closed, the output is handed to the sinks as it's read
+	 *
+	 * @param outSink gets stdout
+	 * @param errSink gets stderr
+	 */
+	void drain(const OutputSink & outSink, const OutputSink & errSink) {
+		std::vector<char> buffer(readBufferSize);
+		while (outFd_ >= 0 || errFd_ >= 0) {
+			struct pollfd fds[2];
+			nfds_t numFds = 0;
+			if (outFd_ >= 0) {
+				fds[numFds++] = {outFd_, POLLIN, 0};
+			}
+			if (errFd_ >= 0) {
+				fds[numFds++] = {errFd_, POLLIN, 0};
+			}
+			if (::poll(fds, numFds, -1) < 0) {
+				if (EINTR == errno) {
+					continue;
+				}
+				std::stringstream ss;
+				ss << __PRETTY_FUNCTION__ << ", error in polling output of " << cmd_ << ": " << std::strerror(errno) << "\n";
+				throw std::runtime_error { ss.str() };
+			}
+			for (nfds_t pos = 0; pos < numFds; ++pos) {
+				if (0 == (fds[pos].revents & (POLLIN | POLLHUP | POLLERR))) {
+					continue;
+				}
+				if (fds[pos].fd == outFd_) {
+					readInto(outFd_, outSink, buffer);
+				} else {
+					readInto(errFd_, errSink, buffer);
+				}
+			}
+		}
+	}
+
+	/**@brief Wait for the process to finish
+	 *
+	 * @return the status from waitpid (wait4), 0 if the command exited with 0
+	 */
+	int wait() {
+		if (!waited_) {
+			waitForExit(true);
+			recordIo();
+			struct rusage usage;
+			while (::wait4(pid_, &status_, 0, &usage) < 0) {
+				if (EINTR != errno) {
+					std::stringstream ss;
+					ss << __PRETTY_FUNCTION__ << ", error in waiting on " << cmd_ << ": " << std::strerror(errno) << "\n";
+					throw std::runtime_error { ss.str() };
+				}
+			}
+			waited_ = true;
+			setUsage(usage);
+		}
+		return status_;
+	}
+
+	/**@brief The wall time, cpu time, peak memory, context switches and io of the process, only valid after it has been reaped by wait() or tryWait()
+	 *
+	 */
+	const ResourceUsage & usage() const {
+		return usage_;
+	}
+
+	/**@brief Whether the process exited normally with a code of 0, only valid after wait()
+	 *
+	 */
+	bool succeeded() const {
+		return waited_ && WIFEXITED(status_) && 0 == WEXITSTATUS(status_);
+	}
+};
+
+/**@brief Run a command and stream its output into sinks instead of holding it in memory
+ *
+ * @param cmd the command, run with /bin/sh -c
+ * @param outSink gets stdout as it is produced
+ * @param errSink gets stderr as it is produced
+ * @return a RunOutput with the status, time and command, stdOut_ and stdErr_ are left empty
+ */
+inline RunOutput runStreaming(const std::string & cmd, const OutputSink & outSink,
+		const OutputSink & errSink) {
+	njh::stopWatch watch;
+	ChildProcess proc(cmd);
+	proc.drain(outSink, errSink);
+	const int32_t status = proc.wait();
+	return {proc.succeeded(), proc.succeeded() ? 0 : status, "", "", cmd, watch.totalTime(), proc.usage()};
+}
+
+/**@brief Quote an argument so /bin/sh passes it through as is, single quotes and all
+ *
+ * @param arg the argument
+ * @return the argument in single quotes, with any single quotes in it escaped
+ */
+inline std::string shellQuote(const std::string & arg) {
+	std::string ret = "'";
+	for (const auto c : arg) {
+		if ('\'' == c) {
+			ret += "'\\''";
+		} else {
+			ret.push_back(c);
+		}
+	}
+	ret.push_back('\'');
+	return ret;
+}
+
+/**@brief The full path of the running executable, for starting copies of ourselves
+ *
+ * @param fallback returned if the path can't be found, e.g. argv[0]
+ * @return the path
+ */
+inline std::string currentExecutable(const std::string & fallback) {
+#if defined(__linux__)
+	std::vector<char> buffer(4096);
+	ssize_t len = ::readlink("/proc/self/exe", buffer.data(), buffer.size());
+	if (len > 0 && static_cast<size_t>(len) < buffer.size()) {
+		return std::string(buffer.data(), len);
+	}
+#elif defined(__APPLE__)
+	uint32_t size = 4096;
+	std::vector<char> buffer(size);
+	if (0 == _NSGetExecutablePath(buffer.data(), &size)) {
+		return std::string(buffer.data());
+	}
+#endif
+	return fallback;
+}
+
+}  // namespace sys
+}  // namespace njh
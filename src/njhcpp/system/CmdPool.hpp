@@ -10,6 +10,10 @@
 #include <mutex>
 #include <atomic>
 #include "njhcpp/jsonUtils/jsonUtils.hpp"
+#include "njhcpp/system/RunOutput.hpp"
+#include <thread>
+#include <unordered_map>
+#include <unistd.h>
 
 namespace njh {
 namespace sys {
@@ -57,5 +61,168 @@ public:
 	}
 };
 
+/**@brief A command along with the resources it needs
+ *
+ */
+struct JobSpec {
+	std::string cmd_; /**< the command*/
+	uint32_t cores_ = 1; /**< the number of cores the command uses*/
+	uint64_t memoryMb_ = 0; /**< the memory the command uses in megabytes, 0 if unknown*/
+	int32_t priority_ = 0; /**< higher priority jobs are started first*/
+	double expectedTime_ = 0; /**< the expected run time in seconds, among jobs of the same priority the longest are started first, 0 if unknown*/
+
+	JobSpec() = default;
+	JobSpec(const std::string & cmd, uint32_t cores = 1, uint64_t memoryMb = 0,
+			int32_t priority = 0, double expectedTime = 0) :
+			cmd_(cmd), cores_(cores), memoryMb_(memoryMb), priority_(priority), expectedTime_(
+					expectedTime) {
+	}
+
+	Json::Value toJson() const {
+		Json::Value ret;
+		ret["class"] = "njh::sys::JobSpec";
+		ret["cmd_"] = json::toJson(cmd_);
+		ret["cores_"] = json::toJson(cores_);
+		ret["memoryMb_"] = json::toJson(memoryMb_);
+		ret["priority_"] = json::toJson(priority_);
+		ret["expectedTime_"] = json::toJson(expectedTime_);
+		return ret;
+	}
+};
+
+/**@brief The resources available for running jobs
+ *
+ */
+struct ResourceLimits {
+	uint32_t cores_; /**< the number of cores*/
+	uint64_t memoryMb_; /**< the memory in megabytes, 0 for no limit*/
+
+	/**@brief Default to the cores and physical memory of this machine
+	 *
+	 */
+	ResourceLimits() :
+			cores_(std::max<uint32_t>(1, std::thread::hardware_concurrency())), memoryMb_(
+					machineMemoryMb()) {
+	}
+
+	ResourceLimits(uint32_t cores, uint64_t memoryMb) :
+			cores_(std::max<uint32_t>(1, cores)), memoryMb_(memoryMb) {
+	}
+
+	static uint64_t machineMemoryMb() {
+		long pages = ::sysconf(_SC_PHYS_PAGES);
+		long pageSize = ::sysconf(_SC_PAGE_SIZE);
+		if (pages <= 0 || pageSize <= 0) {
+			return 0;
+		}
+		return static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize) / (1024 * 1024);
+	}
+};
+
+/**@brief A pool of jobs handed out so that the cores and memory of the jobs running at once stay within the limits
+ *
+ * Jobs are handed out by priority and then longest expected time first, if the next job doesn't fit in what's free
+ * a later one that does fit is handed out instead. A job asking for more than the limits is treated as needing all of them
+ * so it still runs, alone
+ */
+class ResourceAwareCmdPool {
+	std::vector<JobSpec> jobs_; /**< the jobs in input order*/
+	std::vector<size_t> pending_; /**< indexes of the jobs not yet handed out, in the order to hand them out*/
+	ResourceLimits limits_;
+	uint32_t coresInUse_ = 0;
+	uint64_t memoryInUse_ = 0;
+	std::mutex mut_;
+
+	uint32_t coresFor(const JobSpec & job) const {
+		return std::min(std::max<uint32_t>(1, job.cores_), limits_.cores_);
+	}
+
+	uint64_t memoryFor(const JobSpec & job) const {
+		return 0 == limits_.memoryMb_ ? 0 : std::min(job.memoryMb_, limits_.memoryMb_);
+	}
+
+public:
+	ResourceAwareCmdPool(const std::vector<JobSpec> & jobs, const ResourceLimits & limits) :
+			jobs_(jobs), limits_(limits) {
+		limits_.cores_ = std::max<uint32_t>(1, limits_.cores_);
+		for (size_t pos = 0; pos < jobs_.size(); ++pos) {
+			pending_.emplace_back(pos);
+		}
+		std::stable_sort(pending_.begin(), pending_.end(), [this](size_t first, size_t second) {
+			if (jobs_[first].priority_ != jobs_[second].priority_) {
+				return jobs_[first].priority_ > jobs_[second].priority_;
+			}
+			return jobs_[first].expectedTime_ > jobs_[second].expectedTime_;
+		});
+	}
+
+	/**@brief Get the next job that fits in the resources that are free, the resources are held until finishJob() is called
+	 *
+	 * @param index set to the index of the job in the input
+	 * @return whether a job was handed out, false if none fit right now or none are left
+	 */
+	bool tryGetJob(size_t & index) {
+		std::lock_guard<std::mutex> lock(mut_);
+		for (auto it = pending_.begin(); it != pending_.end(); ++it) {
+			const auto & job = jobs_[*it];
+			if (coresInUse_ + coresFor(job) <= limits_.cores_
+					&& (0 == limits_.memoryMb_ || memoryInUse_ + memoryFor(job) <= limits_.memoryMb_)) {
+				coresInUse_ += coresFor(job);
+				memoryInUse_ += memoryFor(job);
+				index = *it;
+				pending_.erase(it);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/**@brief Give back the resources held by a job handed out by tryGetJob()
+	 *
+	 */
+	void finishJob(size_t index) {
+		std::lock_guard<std::mutex> lock(mut_);
+		coresInUse_ -= coresFor(jobs_[index]);
+		memoryInUse_ -= memoryFor(jobs_[index]);
+	}
+
+	/**@brief Drop the jobs that haven't been handed out yet
+	 *
+	 */
+	void clearPending() {
+		std::lock_guard<std::mutex> lock(mut_);
+		pending_.clear();
+	}
+
+	bool pendingEmpty() {
+		std::lock_guard<std::mutex> lock(mut_);
+		return pending_.empty();
+	}
+
+	const JobSpec & job(size_t index) const {
+		return jobs_[index];
+	}
+
+	/**@brief Update jobs with the wall time and peak memory measured on a previous run of the same commands, so the next run is scheduled with real numbers
+	 *
+	 * @param jobs the jobs to update, matched to outputs by command
+	 * @param outputs the results of the previous run
+	 */
+	static void updateFromPreviousRun(std::vector<JobSpec> & jobs, const std::vector<RunOutput> & outputs) {
+		std::unordered_map<std::string, const RunOutput *> byCmd;
+		for (const auto & output : outputs) {
+			byCmd[output.cmd_] = &output;
+		}
+		for (auto & job : jobs) {
+			auto search = byCmd.find(job.cmd_);
+			if (byCmd.end() != search) {
+				job.expectedTime_ = search->second->usage_.wallTime_;
+				job.memoryMb_ = std::max<uint64_t>(job.memoryMb_,
+						static_cast<uint64_t>(std::max<int64_t>(0, search->second->usage_.maxRssKb_)) / 1024);
+			}
+		}
+	}
+};
+
 }  // namespace sys
 }  // namespace njh
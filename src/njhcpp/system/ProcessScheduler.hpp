@@ -0,0 +1,232 @@
+#pragma once
+/*
+ * ProcessScheduler.hpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// Run many external commands with a limit on how many run at once, from a
+// single thread. The output pipes of every running command are watched with
+// one poll() call, finished commands are reaped with waitpid(WNOHANG) and new
+// ones are started as slots free up, so there is no thread per process.
+// Jobs can declare the cores and memory they need and are then packed so the
+// declared totals stay within the machine's limits.
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <iostream>
+#include <functional>
+#include <poll.h>
+#include "njhcpp/system/ChildProcess.hpp"
+#include "njhcpp/system/RunOutput.hpp"
+#include "njhcpp/system/CmdPool.hpp" //JobSpec, ResourceAwareCmdPool
+#include "njhcpp/bashUtils/textFormatter.hpp" //bashCT::trimForNonTerminalOut
+#include "njhcpp/utils/stringUtils.hpp" //trim
+#include "njhcpp/common.h" //estd::to_string
+
+namespace njh {
+namespace sys {
+
+/**@brief Options for ProcessScheduler
+ *
+ */
+struct ProcessSchedulerPars {
+	uint32_t maxConcurrent_ = 1; /**< the max number of commands running at once*/
+	double timeout_ = 0; /**< seconds a command is allowed to run before it's killed, 0 for no limit, when set (or with failFast_) each command runs in its own process group so everything it started can be killed, which also means a ctrl-c at the terminal no longer reaches it*/
+	bool failFast_ = false; /**< on the first failure stop starting commands and kill the ones running*/
+	bool verbose_ = false; /**< print when commands start and finish*/
+};
+
+/**@brief Run a set of commands with bounded concurrency without a thread per command
+ *
+ */
+class ProcessScheduler {
+	struct Running {
+		size_t index_; /**< position of the command in the input*/
+		std::unique_ptr<ChildProcess> proc_;
+		std::chrono::steady_clock::time_point start_;
+		std::string out_;
+		std::string err_;
+		bool timedOut_ = false;
+		bool killed_ = false;
+	};
+
+	ProcessSchedulerPars pars_;
+
+	/**@brief How long the poll() can wait, short while something still has to be reaped or could hit its timeout
+	 *
+	 */
+	int pollTimeoutMs(const std::vector<Running> & running) const {
+		int ret = -1;
+		auto now = std::chrono::steady_clock::now();
+		for (const auto & run : running) {
+			if (run.proc_->outputDone()) {
+				//pipes are closed but the process hasn't exited yet, check again shortly
+				return 10;
+			}
+			if (pars_.timeout_ > 0 && !run.timedOut_) {
+				auto deadline = run.start_ + std::chrono::duration<double>(pars_.timeout_);
+				int untilDeadline = std::max<int>(0,
+						std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1);
+				ret = -1 == ret ? untilDeadline : std::min(ret, untilDeadline);
+			}
+		}
+		return ret;
+	}
+
+public:
+	/**@brief Called as each command finishes with its index in the input and its result
+	 *
+	 */
+	typedef std::function<void(size_t, const RunOutput &)> FinishedCallback;
+
+	explicit ProcessScheduler(const ProcessSchedulerPars & pars) :
+			pars_(pars) {
+		pars_.maxConcurrent_ = std::max<uint32_t>(1, pars_.maxConcurrent_);
+	}
+
+	/**@brief Run the commands
+	 *
+	 * @param cmds the commands, each run with /bin/sh -c
+	 * @param onFinished if set, called from the calling thread as each command finishes
+	 * @return the results in the same order as cmds, output is trimmed the same way as njh::sys::run(),
+	 * commands skipped because of fail fast have a returnCode_ of -1
+	 */
+	std::vector<RunOutput> run(const std::vector<std::string> & cmds,
+			const FinishedCallback & onFinished = nullptr) {
+		std::vector<JobSpec> jobs;
+		for (const auto & cmd : cmds) {
+			jobs.emplace_back(cmd);
+		}
+		//every job takes one core and memory isn't limited so jobs start in input order, maxConcurrent_ at a time
+		return run(jobs, ResourceLimits(pars_.maxConcurrent_, 0), onFinished);
+	}
+
+	/**@brief Run jobs so the cores and memory they declare never add up to more than the limits
+	 *
+	 * Jobs are started by priority and then longest expected time first, when the next job doesn't fit a later
+	 * smaller one that does is started instead, and at most maxConcurrent_ run at once
+	 *
+	 * @param jobs the jobs, each command run with /bin/sh -c
+	 * @param limits the resources available
+	 * @param onFinished if set, called from the calling thread as each job finishes
+	 * @return the results in the same order as jobs, with the wall time and peak memory of each in usage_
+	 */
+	std::vector<RunOutput> run(const std::vector<JobSpec> & jobs, const ResourceLimits & limits,
+			const FinishedCallback & onFinished = nullptr) {
+		std::vector<RunOutput> ret(jobs.size());
+		for (size_t pos = 0; pos < jobs.size(); ++pos) {
+			ret[pos] = RunOutput { false, -1, "", "", jobs[pos].cmd_, 0, ResourceUsage{} };
+		}
+		ResourceAwareCmdPool pool(jobs, limits);
+		std::vector<bool> started(jobs.size(), false);
+		std::vector<Running> running;
+		std::vector<char> buffer(ChildProcess::readBufferSize);
+		bool failed = false;
+		while (!pool.pendingEmpty() || !running.empty()) {
+			//start jobs while there is room
+			size_t index = 0;
+			while (running.size() < pars_.maxConcurrent_ && pool.tryGetJob(index)) {
+				if (pars_.verbose_) {
+					std::cout << "Running: " << jobs[index].cmd_ << std::endl;
+				}
+				Running run;
+				run.index_ = index;
+				run.start_ = std::chrono::steady_clock::now();
+				//only a job that may have to be killed gets its own process group, otherwise it stays in ours so
+				//a ctrl-c at the terminal still reaches it rather than leaving it running on its own
+				run.proc_ = std::make_unique<ChildProcess>(jobs[index].cmd_, pars_.timeout_ > 0 || pars_.failFast_);
+				running.emplace_back(std::move(run));
+				started[index] = true;
+			}
+			//watch all the open pipes
+			std::vector<struct pollfd> fds;
+			std::vector<size_t> fdOwners;
+			for (size_t pos = 0; pos < running.size(); ++pos) {
+				for (int fd : { running[pos].proc_->outFd(), running[pos].proc_->errFd() }) {
+					if (fd >= 0) {
+						fds.push_back( { fd, POLLIN, 0 });
+						fdOwners.push_back(pos);
+					}
+				}
+			}
+			int timeoutMs = pollTimeoutMs(running);
+			if (!fds.empty() || timeoutMs >= 0) {
+				if (::poll(fds.data(), fds.size(), timeoutMs) < 0 && EINTR != errno) {
+					std::stringstream ss;
+					ss << __PRETTY_FUNCTION__ << ", error in polling: " << std::strerror(errno) << "\n";
+					throw std::runtime_error { ss.str() };
+				}
+			}
+			for (size_t pos = 0; pos < fds.size(); ++pos) {
+				if (0 != (fds[pos].revents & (POLLIN | POLLHUP | POLLERR))) {
+					auto & run = running[fdOwners[pos]];
+					run.proc_->readFrom(fds[pos].fd, stringSink(run.out_), stringSink(run.err_), buffer);
+				}
+			}
+			//kill anything over its time limit
+			auto now = std::chrono::steady_clock::now();
+			for (auto & run : running) {
+				if (pars_.timeout_ > 0 && !run.timedOut_
+						&& std::chrono::duration<double>(now - run.start_).count() >= pars_.timeout_) {
+					run.timedOut_ = true;
+					run.proc_->kill(SIGKILL);
+				}
+			}
+			//reap finished jobs
+			for (auto it = running.begin(); it != running.end();) {
+				if (!it->proc_->outputDone() || !it->proc_->tryWait()) {
+					++it;
+					continue;
+				}
+				pool.finishJob(it->index_);
+				auto & out = ret[it->index_];
+				out.time_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - it->start_).count();
+				out.usage_ = it->proc_->usage();
+				out.success_ = it->proc_->succeeded() && !it->timedOut_;
+				out.returnCode_ = it->proc_->succeeded() ? 0 : it->proc_->wait();
+				out.stdOut_ = bashCT::trimForNonTerminalOut(it->out_);
+				trim(out.stdOut_);
+				out.stdErr_ = bashCT::trimForNonTerminalOut(it->err_);
+				if (it->timedOut_) {
+					out.stdErr_ += "\nkilled after exceeding timeout of " + estd::to_string(pars_.timeout_) + " seconds";
+				} else if (it->killed_) {
+					out.stdErr_ += "\nkilled after another command failed";
+				}
+				trim(out.stdErr_);
+				if (pars_.verbose_) {
+					std::cout << "Done running: " << out.cmd_ << (out.success_ ? "" : ", failed")
+							<< ", " << out.usage_.summary() << std::endl;
+				}
+				if (!out.success_ && !it->killed_) {
+					failed = true;
+				}
+				if (onFinished) {
+					onFinished(it->index_, out);
+				}
+				it = running.erase(it);
+			}
+			if (pars_.failFast_ && failed) {
+				pool.clearPending();
+				for (auto & run : running) {
+					if (!run.killed_) {
+						run.killed_ = true;
+						run.proc_->kill(SIGTERM);
+					}
+				}
+			}
+		}
+		for (size_t pos = 0; pos < jobs.size(); ++pos) {
+			if (!started[pos]) {
+				ret[pos].stdErr_ = "not run because an earlier command failed";
+			}
+		}
+		return ret;
+	}
+};
+
+}  // namespace sys
+}  // namespace njh
@@ -8,10 +8,160 @@
 
 #include "njhcpp/common.h"
 #include "njhcpp/jsonUtils/jsonUtils.hpp"
+#include <fstream>
+#include <sstream>
+#include <sys/resource.h>
 
 namespace njh {
 namespace sys {
 
+/**@brief Resources used by an external command, as reported by the kernel when the process was reaped
+ *
+ * The cpu times, peak memory and context switches come from wait4(), the io counts from /proc/<pid>/io read just before
+ * reaping (linux only, left at 0 elsewhere). All include the descendants the command waited on, e.g. the programs a shell ran
+ */
+struct ResourceUsage {
+	double wallTime_ = 0; /**< wall clock time in seconds from start to being reaped*/
+	double userTime_ = 0; /**< cpu time in seconds spent in user code*/
+	double sysTime_ = 0; /**< cpu time in seconds spent in the kernel on the command's behalf*/
+	int64_t maxRssKb_ = 0; /**< the peak resident set size in kilobytes, of the largest process waited on (the shell or the command it ran)*/
+	int64_t voluntaryCtxSwitches_ = 0; /**< times the command gave up the cpu, usually waiting on io*/
+	int64_t involuntaryCtxSwitches_ = 0; /**< times the command was preempted, high when there are more busy threads than cores*/
+	int64_t charsRead_ = 0; /**< bytes passed to read() and similar calls, including pipes and reads served from the page cache*/
+	int64_t charsWritten_ = 0; /**< bytes passed to write() and similar calls*/
+	int64_t bytesRead_ = 0; /**< bytes actually fetched from storage*/
+	int64_t bytesWritten_ = 0; /**< bytes sent to storage*/
+
+	/**@brief Total cpu time in seconds
+	 *
+	 */
+	double cpuTime() const {
+		return userTime_ + sysTime_;
+	}
+
+	/**@brief Average number of cores kept busy, cpu time over wall time, about 1 per thread for a cpu bound command and near 0 for one waiting on io
+	 *
+	 */
+	double cpuUtilization() const {
+		return wallTime_ > 0 ? cpuTime() / wallTime_ : 0;
+	}
+
+	/**@brief Fill in the cpu times, peak memory and context switches from getrusage() or wait4()
+	 *
+	 */
+	void setFromRusage(const struct rusage & usage) {
+		userTime_ = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000.0;
+		sysTime_ = usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.0;
+#if defined(__APPLE__)
+		//reported in bytes on macOS, kilobytes on linux
+		maxRssKb_ = usage.ru_maxrss / 1024;
+#else
+		maxRssKb_ = usage.ru_maxrss;
+#endif
+		voluntaryCtxSwitches_ = usage.ru_nvcsw;
+		involuntaryCtxSwitches_ = usage.ru_nivcsw;
+	}
+
+	/**@brief Fill in the io counts from a /proc io file, e.g. /proc/<pid>/io or /proc/thread-self/io
+	 *
+	 * @param ioFnp the file to read
+	 * @return whether the file could be read, the counts are left alone if not
+	 */
+	bool setIoFromProc(const std::string & ioFnp) {
+		std::ifstream ioFile(ioFnp);
+		if (!ioFile) {
+			return false;
+		}
+		std::string name;
+		int64_t val = 0;
+		while (ioFile >> name >> val) {
+			if ("rchar:" == name) {
+				charsRead_ = val;
+			} else if ("wchar:" == name) {
+				charsWritten_ = val;
+			} else if ("read_bytes:" == name) {
+				bytesRead_ = val;
+			} else if ("write_bytes:" == name) {
+				bytesWritten_ = val;
+			}
+		}
+		return true;
+	}
+
+	/**@brief The resources used so far by the calling thread (by the whole process where per thread numbers aren't available),
+	 * wallTime_ is left at 0, use since() to get what a stretch of work used
+	 *
+	 */
+	static ResourceUsage currentThread() {
+		ResourceUsage ret;
+		struct rusage usage;
+#if defined(RUSAGE_THREAD)
+		int got = ::getrusage(RUSAGE_THREAD, &usage);
+#else
+		int got = ::getrusage(RUSAGE_SELF, &usage);
+#endif
+		if (0 == got) {
+			ret.setFromRusage(usage);
+		}
+#if defined(__linux__)
+		ret.setIoFromProc("/proc/thread-self/io");
+#endif
+		return ret;
+	}
+
+	/**@brief The difference between this and an earlier snapshot, maxRssKb_ is kept as is since a peak can't be split
+	 *
+	 * @param start the earlier snapshot
+	 * @return what was used in between
+	 */
+	ResourceUsage since(const ResourceUsage & start) const {
+		ResourceUsage ret = *this;
+		ret.wallTime_ -= start.wallTime_;
+		ret.userTime_ -= start.userTime_;
+		ret.sysTime_ -= start.sysTime_;
+		ret.voluntaryCtxSwitches_ -= start.voluntaryCtxSwitches_;
+		ret.involuntaryCtxSwitches_ -= start.involuntaryCtxSwitches_;
+		ret.charsRead_ -= start.charsRead_;
+		ret.charsWritten_ -= start.charsWritten_;
+		ret.bytesRead_ -= start.bytesRead_;
+		ret.bytesWritten_ -= start.bytesWritten_;
+		return ret;
+	}
+
+	/**@brief A one line summary for logs
+	 *
+	 */
+	std::string summary() const {
+		std::stringstream ss;
+		ss << "wall: " << wallTime_ << "s"
+				<< ", cpu: " << cpuTime() << "s (user: " << userTime_ << "s, sys: " << sysTime_ << "s, cores used: " << cpuUtilization() << ")"
+				<< ", max rss: " << maxRssKb_ / 1024.0 << "mb"
+				<< ", ctx switches: " << voluntaryCtxSwitches_ << " voluntary, " << involuntaryCtxSwitches_ << " involuntary"
+				<< ", io: " << charsRead_ << " read, " << charsWritten_ << " written (" << bytesRead_ << " from disk, " << bytesWritten_ << " to disk)";
+		return ss.str();
+	}
+
+	/**@brief convert to json object from jsoncpp
+	 *
+	 * @return a json objects
+	 */
+	Json::Value toJson() const {
+		Json::Value ret;
+		ret["class"] = "njh::sys::ResourceUsage";
+		ret["wallTime_"] = json::toJson(wallTime_);
+		ret["userTime_"] = json::toJson(userTime_);
+		ret["sysTime_"] = json::toJson(sysTime_);
+		ret["maxRssKb_"] = json::toJson(maxRssKb_);
+		ret["voluntaryCtxSwitches_"] = json::toJson(voluntaryCtxSwitches_);
+		ret["involuntaryCtxSwitches_"] = json::toJson(involuntaryCtxSwitches_);
+		ret["charsRead_"] = json::toJson(charsRead_);
+		ret["charsWritten_"] = json::toJson(charsWritten_);
+		ret["bytesRead_"] = json::toJson(bytesRead_);
+		ret["bytesWritten_"] = json::toJson(bytesWritten_);
+		return ret;
+	}
+};
+
 /**@brief struct for holding output and success status of an external command
  *@todo add original run command and run duration info
  */
@@ -21,7 +171,8 @@ struct RunOutput {
 	std::string stdOut_; /**< the output to stdout from the command*/
 	std::string stdErr_; /**< the output to stderr from the command*/
 	std::string cmd_; /**< the command*/
-	double time_; /**< time in millisecond */
+	double time_; /**< wall clock run time in seconds */
+	ResourceUsage usage_; /**< resources used by the command*/
 
 	/**@brief So the struct can be tested in an if statement
 	 *
@@ -43,6 +194,7 @@ struct RunOutput {
 		ret["stdOut_"] = json::toJson(stdOut_);
 		ret["stdErr_"] = json::toJson(stdErr_);
 		ret["time_"] = json::toJson(time_);
+		ret["usage_"] = usage_.toJson();
 		return ret;
 	}
 };
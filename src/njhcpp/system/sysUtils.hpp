@@ -13,164 +13,76 @@
 #include "njhcpp/utils/time.h"
 #include "njhcpp/system/CmdPool.hpp"
 #include "njhcpp/system/RunOutput.hpp"
-#include <pstreams/pstream.h>
+#include "njhcpp/system/ChildProcess.hpp"
+#include "njhcpp/system/ProcessScheduler.hpp"
 #include <thread>
 
 namespace njh{
 namespace sys{
 
 /**@brief run the command in cmds externally and return the status and outputs
+ *
+ * stdout and stderr are read at the same time so a command writing a lot to one can't block while the other is read,
+ * for commands with a lot of output use runStreaming() to avoid holding all of it in memory
  *
  * @param cmds A vector of strings contains the command, content of cmds will be converted to a string with space delimited every string in cmds
  * @return A RunOutPut object holding status and outputs of the externally ran cmd
- * @todo add run time duration
  */
 inline RunOutput run(std::vector<std::string> cmds) {
 	//cat cmds
 	std::string cmd = conToStr(cmds, " ");
-	//start a stopwatch to clock how long it took
-	njh::stopWatch watch;
-	redi::ipstream s(cmd, redi::ipstream::pstdout | redi::ipstream::pstderr);
-	//read stdout
-	std::stringstream outSS;
-	outSS << s.out().rdbuf();
-	auto out = bashCT::trimForNonTerminalOut(outSS.str());
-	trim(out);
-	//read stderr
-	std::stringstream errSS;
-	errSS << s.err().rdbuf();
-	auto err = bashCT::trimForNonTerminalOut(errSS.str());
-	trim(err);
-	s.close();
-	double rTime = watch.totalTime();
-	const int32_t errCode = s.rdbuf()->status();
-	if (s.rdbuf()->exited() && !errCode) {
-		return {true, 0, std::move(out), std::move(err), cmd, rTime};
-	}
-	return {false, errCode, std::move(out), std::move(err), cmd, rTime};
+	std::string out;
+	std::string err;
+	auto ret = runStreaming(cmd, stringSink(out), stringSink(err));
+	ret.stdOut_ = bashCT::trimForNonTerminalOut(out);
+	trim(ret.stdOut_);
+	ret.stdErr_ = bashCT::trimForNonTerminalOut(err);
+	trim(ret.stdErr_);
+	return ret;
 }
 
 inline RunOutput runTest(std::vector<std::string> cmds) {
 	//cat cmds
 	std::string cmd = conToStr(cmds, " ");
-	//start a stopwatch to clock how long it took
-	njh::stopWatch watch;
-	redi::ipstream s(cmd, redi::ipstream::pstdout | redi::ipstream::pstderr);
-	//read stdout
-	std::stringstream outSS;
-	//read stderr
-	std::stringstream errSS;
-	char buf[1024];
-	std::streamsize n;
-	bool finished[2] = { false, false };
-	while (!finished[0] || !finished[1]) {
-		if (!finished[0]) {
-			while ((n = s.err().readsome(buf, sizeof(buf))) > 0) {
-				errSS.write(buf, n);
-			}
-			if (s.eof()) {
-				finished[0] = true;
-				if (!finished[1]) {
-					s.clear();
-				}
-			}
-		}
-		if (!finished[1]) {
-			while ((n = s.out().readsome(buf, sizeof(buf))) > 0) {
-				outSS.write(buf, n).flush();
-			}
-			if (s.eof()) {
-				finished[1] = true;
-				if (!finished[0]) {
-					s.clear();
-				}
-			}
-		}
-	}
-	auto out = outSS.str();
+	std::string out;
+	std::string err;
+	auto ret = runStreaming(cmd, stringSink(out), stringSink(err));
 	trim(out);
-
-	auto err = errSS.str();
 	trim(err);
-	s.close();
-
-	double rTime = watch.totalTime();
-	const int32_t errCode = s.rdbuf()->status();
-	if (s.rdbuf()->exited() && !errCode) {
-		return {true, 0, std::move(out), std::move(err), cmd, rTime};
-	}
-	return {false, errCode, std::move(out), std::move(err), cmd, rTime};
+	ret.stdOut_ = std::move(out);
+	ret.stdErr_ = std::move(err);
+	return ret;
 }
 
 
 
 
 
-/**@brief Run a vector of commands on multiple threads
- * Run multiple commands on the system in several threads, no safety checks on number of threads available or
+/**@brief Run a vector of commands several at a time
+ * Run multiple commands on the system at once, no safety checks on number of cores available or
  *  if commands would clash.  Will run all commands even if one fails, intention of this command is to run
- *  a bunch of small jobs at once
+ *  a bunch of small jobs at once. The commands are run by a ProcessScheduler so no thread is used per command
  *
  * @param cmds A vector of commands to run in parallel, no check is done to ensure they are not clashing
- * @param numThreads The number of threads to use
+ * @param numThreads The number of commands to run at once
  * @param verbose Whether to be print the command when it is being run
- * @param debug Whether to just print the cmds and exit
- * @return A vector njh::sys::RunOutput for status of the commands
+ * @param debug Whether to just print the cmds and return without running them
+ * @return A vector njh::sys::RunOutput for status of the commands, in the same order as cmds, empty in debug mode
  */
 inline std::vector<njh::sys::RunOutput> runCmdsThreaded(
 		const std::vector<std::string> & cmds, uint32_t numThreads, bool verbose,
 		bool debug) {
-	std::mutex allOutputsMut;
-	std::mutex coutMut;
-	std::vector<njh::sys::RunOutput> ret;
-
-	auto runCmds =
-			[&coutMut, &allOutputsMut, &ret, &verbose](const std::shared_ptr<CmdPool<std::string>> & pool) {
-				bool running = true;
-				while(running) {
-					auto currentCmd = pool->getCmd();
-					if(currentCmd.valid_) {
-						if(verbose) {
-							std::lock_guard<std::mutex> lock(coutMut);
-							auto tId = std::this_thread::get_id();
-							std::cout << "Thread: " << tId << std::endl;
-							std::cout << "\tRunning: " << currentCmd.cmd_ << std::endl;
-						}
-						auto currentOut = njh::sys::run(std::vector<std::string> {currentCmd.cmd_});
-						if(verbose){
-							auto tId = std::this_thread::get_id();
-							std::cout << "\tThread: " << tId << std::endl;
-							std::cout << "\tDone running: " << currentCmd.cmd_ << std::endl;
-						}
-						{
-							if(verbose){
-								auto tId = std::this_thread::get_id();
-								std::cout << "\tThread: " << tId << std::endl;
-								std::cout << "\tInserting Results from: " << currentCmd.cmd_ << std::endl;
-							}
-							std::lock_guard<std::mutex> lock(allOutputsMut);
-							ret.emplace_back(currentOut);
-						}
-					} else {
-						running = false;
-					}
-				}
-			};
 	if (debug) {
 		for (const auto & cmd : cmds) {
 			std::cout << cmd << std::endl;
 		}
-		exit(1);
-	}
-	auto pool = std::make_shared<CmdPool<std::string>>(cmds);
-	std::vector<std::thread> threads;
-	for (uint32_t t = 0; t < numThreads; ++t) {
-		threads.emplace_back(std::thread(runCmds, std::cref(pool)));
+		return {};
 	}
-	for (auto &t : threads) {
-		t.join();
-	}
-	return ret;
+	ProcessSchedulerPars pars;
+	pars.maxConcurrent_ = numThreads;
+	pars.verbose_ = verbose;
+	ProcessScheduler scheduler(pars);
+	return scheduler.run(cmds);
 }
 
 
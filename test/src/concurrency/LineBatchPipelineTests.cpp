@@ -0,0 +1,88 @@
+/*
+ * LineBatchPipelineTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include "njhcpp/concurrency/LineBatchPipeline.hpp"
+
+namespace {
+
+njh::files::bfs::path writeNumberedLines(const std::string & name, uint32_t numLines) {
+	auto fnp = njh::files::bfs::temp_directory_path() / njh::files::bfs::unique_path(name + "-%%%%-%%%%.txt");
+	std::ofstream out(fnp.string());
+	for (uint32_t line = 0; line < numLines; ++line) {
+		out << line << "\n";
+	}
+	return fnp;
+}
+
+}  // namespace
+
+TEST_CASE("LineBatchPipeline keeps the order of the output", "[LineBatchPipeline]") {
+	auto fnp = writeNumberedLines("lineBatchOrder", 200);
+	auto outFnp = njh::files::bfs::path(fnp.string() + ".out");
+	{
+		njh::OutOptions outOpts(outFnp);
+		outOpts.overWriteFile_ = true;
+		njh::OutputStream out(outOpts);
+		njh::concurrent::LineBatchPipeline pipeline(njh::InOptions(fnp), 2, 8);
+		pipeline.run([](const njh::concurrent::LineBatch & batch, std::ostream & batchOut) {
+			if (0 == batch.index_) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			}
+			for (const auto & line : batch.lines_) {
+				batchOut << line << "\n";
+			}
+		}, out, true);
+	}
+	std::ifstream in(outFnp.string());
+	std::string line;
+	uint32_t expected = 0;
+	while (std::getline(in, line)) {
+		REQUIRE(std::to_string(expected) == line);
+		++expected;
+	}
+	CHECK(200 == expected);
+	njh::files::bfs::remove(fnp);
+	njh::files::bfs::remove(outFnp);
+}
+
+TEST_CASE("LineBatchPipeline rethrows instead of hanging when a batch throws while keeping order", "[LineBatchPipeline]") {
+	auto fnp = writeNumberedLines("lineBatchThrow", 200);
+	auto outFnp = njh::files::bfs::path(fnp.string() + ".out");
+	//run detached so a regression shows up as a failed test rather than a test run that never finishes
+	auto done = std::make_shared<std::promise<void>>();
+	auto result = done->get_future();
+	std::thread([fnp, outFnp, done]() {
+		try {
+			njh::OutOptions outOpts(outFnp);
+			outOpts.overWriteFile_ = true;
+			njh::OutputStream out(outOpts);
+			njh::concurrent::LineBatchPipeline pipeline(njh::InOptions(fnp), 2, 8);
+			pipeline.run([](const njh::concurrent::LineBatch & batch, std::ostream & batchOut) {
+				if (0 == batch.index_) {
+					//let the other worker get far enough ahead to block waiting on this batch
+					std::this_thread::sleep_for(std::chrono::milliseconds(300));
+					throw std::runtime_error("batch 0 failed");
+				}
+				for (const auto & line : batch.lines_) {
+					batchOut << line << "\n";
+				}
+			}, out, true);
+			done->set_value();
+		} catch (...) {
+			done->set_exception(std::current_exception());
+		}
+	}).detach();
+	REQUIRE(std::future_status::ready == result.wait_for(std::chrono::seconds(10)));
+	CHECK_THROWS_AS(result.get(), std::runtime_error);
+	njh::files::bfs::remove(fnp);
+	njh::files::bfs::remove(outFnp);
+}
@@ -0,0 +1,105 @@
+/*
+ * ParallelAlgorithmsTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <iostream>
+#include <numeric>
+#include <set>
+#include "njhcpp/concurrency/parallelAlgorithms.hpp"
+#include "njhcpp/concurrency/LockableVec.hpp"
+#include "njhcpp/utils/time/stopWatch.hpp"
+
+TEST_CASE("parallel_reduce applies init once", "[parallel_reduce]") {
+	std::vector<uint64_t> nums(10000);
+	std::iota(nums.begin(), nums.end(), 1);
+	const uint64_t expected = 10 + std::accumulate(nums.begin(), nums.end(), uint64_t { 0 });
+	for (const uint32_t numThreads : { 1u, 2u, 7u, 32u }) {
+		const auto sum = njh::concurrent::parallel_reduce(nums, uint64_t { 10 },
+				[](uint64_t & acc, uint64_t num) {acc += num;},
+				[](uint64_t & total, const uint64_t & acc) {total += acc;}, numThreads);
+		CHECK(expected == sum);
+	}
+	SECTION("empty input gives back init") {
+		const std::vector<uint64_t> none;
+		CHECK(10 == njh::concurrent::parallel_reduce(none, uint64_t { 10 },
+				[](uint64_t & acc, uint64_t num) {acc += num;},
+				[](uint64_t & total, const uint64_t & acc) {total += acc;}, 4));
+	}
+	SECTION("a merge keeps init's elements") {
+		const std::vector<uint32_t> small { 1, 2, 3, 4, 5, 6, 7, 8 };
+		const auto merged = njh::concurrent::parallel_reduce(small, std::set<uint32_t> { 100 },
+				[](std::set<uint32_t> & acc, uint32_t num) {acc.emplace(num);},
+				[](std::set<uint32_t> & total, const std::set<uint32_t> & acc) {total.insert(acc.begin(), acc.end());}, 3, 1);
+		CHECK(std::set<uint32_t> { 1, 2, 3, 4, 5, 6, 7, 8, 100 } == merged);
+	}
+}
+
+TEST_CASE("parallel_for_each visits every element once", "[parallel_for_each]") {
+	std::vector<uint32_t> counts(5000, 0);
+	njh::concurrent::parallel_for_each(counts, [](uint32_t & count) {++count;}, 4, 3);
+	CHECK(std::all_of(counts.begin(), counts.end(), [](uint32_t count) {return 1 == count;}));
+}
+
+TEST_CASE("parallel algorithms benchmark", "[.benchmark][parallel_reduce]") {
+	//summing 20M numbers on 4 threads, claiming one element at a time against claiming chunks
+	const uint32_t numThreads = 4;
+	std::vector<uint64_t> nums(20000000);
+	std::iota(nums.begin(), nums.end(), 1);
+	const uint64_t expected = nums.size() * (nums.size() + 1) / 2;
+	{
+		njh::stopWatch watch;
+		CHECK(expected == std::accumulate(nums.begin(), nums.end(), uint64_t { 0 }));
+		std::cout << "serial\t" << watch.totalTime() << std::endl;
+	}
+	//0 is getVal, one element at a time
+	for (const size_t grainSize : { 0, 1, 16, 256, 4096 }) {
+		njh::concurrent::LockableVec<uint64_t> vals(nums);
+		std::vector<njh::concurrent::CacheLinePadded<uint64_t>> sums(numThreads, njh::concurrent::CacheLinePadded<uint64_t> { 0 });
+		std::atomic<uint32_t> nextThread { 0 };
+		std::function<void()> work = [&]() {
+			uint64_t & sum = sums[nextThread++].val_;
+			if (0 == grainSize) {
+				uint64_t val = 0;
+				while (vals.getVal(val)) {
+					sum += val;
+				}
+			} else {
+				size_t start = 0;
+				size_t stop = 0;
+				while (vals.getRange(grainSize, start, stop)) {
+					for (size_t pos = start; pos < stop; ++pos) {
+						sum += vals[pos];
+					}
+				}
+			}
+		};
+		njh::stopWatch watch;
+		njh::concurrent::runVoidFunctionPooled(work, numThreads);
+		std::cout << (0 == grainSize ? std::string("LockableVec getVal") : "LockableVec getRange grain " + std::to_string(grainSize))
+				<< "\t" << watch.totalTime() << std::endl;
+		uint64_t total = 0;
+		for (const auto & sum : sums) {
+			total += sum.val_;
+		}
+		CHECK(expected == total);
+	}
+	for (const size_t grainSize : { 1, 0 }) {
+		njh::stopWatch watch;
+		const uint64_t total = njh::concurrent::parallel_reduce(nums, uint64_t { 0 },
+				[](uint64_t & acc, uint64_t num) {acc += num;},
+				[](uint64_t & total, const uint64_t & acc) {total += acc;}, numThreads, grainSize);
+		std::cout << "parallel_reduce grain " << (0 == grainSize ? std::string("default") : std::to_string(grainSize))
+				<< "\t" << watch.totalTime() << std::endl;
+		CHECK(expected == total);
+	}
+	{
+		njh::stopWatch watch;
+		njh::concurrent::parallel_for_each(nums, [](uint64_t & num) {num *= 2;}, numThreads);
+		std::cout << "parallel_for_each grain default\t" << watch.totalTime() << std::endl;
+		CHECK(2 * expected == std::accumulate(nums.begin(), nums.end(), uint64_t { 0 }));
+	}
+}
@@ -0,0 +1,161 @@
+/*
+ * RingBufferQueueTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include "njhcpp/concurrency/BoundedQueue.hpp"
+#include "njhcpp/concurrency/RingBufferQueue.hpp"
+#include "njhcpp/utils/time/stopWatch.hpp"
+
+namespace {
+
+/**@brief Pass perProducer values from each producer to the consumers and give back the sum the consumers saw
+ *
+ */
+template<typename QUEUE>
+uint64_t passValues(QUEUE & queue, uint32_t numProducers, uint32_t numConsumers, uint64_t perProducer) {
+	std::vector<uint64_t> sums(numConsumers, 0);
+	std::vector<std::thread> consumers;
+	for (uint32_t consumer = 0; consumer < numConsumers; ++consumer) {
+		consumers.emplace_back([&queue, &sums, consumer]() {
+			std::unique_ptr<uint64_t> val;
+			while (queue.pop(val)) {
+				sums[consumer] += *val;
+			}
+		});
+	}
+	std::vector<std::thread> producers;
+	for (uint32_t producer = 0; producer < numProducers; ++producer) {
+		producers.emplace_back([&queue, perProducer]() {
+			for (uint64_t num = 1; num <= perProducer; ++num) {
+				queue.push(std::make_unique<uint64_t>(num));
+			}
+		});
+	}
+	for (auto & producer : producers) {
+		producer.join();
+	}
+	queue.close();
+	for (auto & consumer : consumers) {
+		consumer.join();
+	}
+	return std::accumulate(sums.begin(), sums.end(), uint64_t { 0 });
+}
+
+}  // namespace
+
+//the two queues are meant to be swappable, so they go through the same tests
+TEMPLATE_TEST_CASE("queues share BoundedQueue's interface", "[RingBufferQueue][BoundedQueue]",
+		njh::concurrent::BoundedQueue<std::string>, njh::concurrent::RingBufferQueue<std::string>) {
+	TestType queue(4);
+	CHECK(queue.empty());
+	const std::string copied = "copied";
+	CHECK(queue.push(copied));
+	CHECK("copied" == copied);
+	CHECK(queue.push(std::string("moved")));
+	CHECK_FALSE(queue.empty());
+	CHECK(2 == queue.size());
+	std::string val;
+	CHECK(queue.pop(val));
+	CHECK("copied" == val);
+	CHECK(queue.pop(val));
+	CHECK("moved" == val);
+	CHECK(queue.empty());
+
+	SECTION("pushBatch larger than the capacity") {
+		std::vector<std::string> vals;
+		for (uint32_t num = 0; num < 100; ++num) {
+			vals.emplace_back(std::to_string(num));
+		}
+		std::vector<std::string> popped;
+		std::thread consumer([&queue, &popped]() {
+			std::string val;
+			while (queue.pop(val)) {
+				popped.emplace_back(val);
+			}
+		});
+		CHECK(100 == queue.pushBatch(vals));
+		queue.close();
+		consumer.join();
+		REQUIRE(100 == popped.size());
+		for (uint32_t num = 0; num < 100; ++num) {
+			CHECK(std::to_string(num) == popped[num]);
+		}
+	}
+	SECTION("pushBatch after close") {
+		queue.close();
+		std::vector<std::string> vals { "a", "b" };
+		CHECK(0 == queue.pushBatch(vals));
+		CHECK_FALSE(queue.push(copied));
+		CHECK_FALSE(queue.pop(val));
+	}
+}
+
+TEST_CASE("RingBufferQueue passes every value exactly once between several producers and consumers", "[RingBufferQueue]") {
+	njh::concurrent::RingBufferQueue<uint64_t> queue(16);
+	const uint32_t numProducers = 4;
+	const uint32_t numConsumers = 4;
+	const uint64_t perProducer = 20000;
+	std::vector<uint64_t> sums(numConsumers, 0);
+	std::vector<uint64_t> counts(numConsumers, 0);
+	std::vector<std::thread> threads;
+	for (uint32_t consumer = 0; consumer < numConsumers; ++consumer) {
+		threads.emplace_back([&, consumer]() {
+			uint64_t val = 0;
+			while (queue.pop(val)) {
+				sums[consumer] += val;
+				++counts[consumer];
+			}
+		});
+	}
+	std::vector<std::thread> producers;
+	for (uint32_t producer = 0; producer < numProducers; ++producer) {
+		producers.emplace_back([&, producer]() {
+			for (uint64_t num = 0; num < perProducer; ++num) {
+				queue.push(producer * perProducer + num + 1);
+			}
+		});
+	}
+	for (auto & producer : producers) {
+		producer.join();
+	}
+	queue.close();
+	for (auto & thread : threads) {
+		thread.join();
+	}
+	const uint64_t total = numProducers * perProducer;
+	CHECK(total == std::accumulate(counts.begin(), counts.end(), uint64_t { 0 }));
+	CHECK(total * (total + 1) / 2 == std::accumulate(sums.begin(), sums.end(), uint64_t { 0 }));
+}
+
+TEST_CASE("RingBufferQueue against BoundedQueue benchmark", "[.benchmark][RingBufferQueue]") {
+	//move-only elements, the way the queues are used to hand off work
+	const uint64_t perProducer = 400000;
+	const size_t capacity = 1024;
+	njh::stopWatch watch;
+	for (const uint32_t numThreads : { 1u, 4u }) {
+		const uint64_t expected = numThreads * perProducer * (perProducer + 1) / 2;
+		const std::string name = std::to_string(numThreads) + " producers/" + std::to_string(numThreads) + " consumers";
+		watch.setLapName("BoundedQueue " + name);
+		njh::concurrent::BoundedQueue<std::unique_ptr<uint64_t>> bounded(capacity);
+		const uint64_t boundedSum = passValues(bounded, numThreads, numThreads, perProducer);
+		const double boundedTime = watch.timeLap();
+		watch.startNewLap("RingBufferQueue " + name);
+		njh::concurrent::RingBufferQueue<std::unique_ptr<uint64_t>> ring(capacity);
+		const uint64_t ringSum = passValues(ring, numThreads, numThreads, perProducer);
+		const double ringTime = watch.timeLap();
+		watch.startNewLap();
+		std::cout << name << ": BoundedQueue " << numThreads * perProducer / boundedTime / 1e6 << " Mops/s, RingBufferQueue "
+				<< numThreads * perProducer / ringTime / 1e6 << " Mops/s" << std::endl;
+		CHECK(expected == boundedSum);
+		CHECK(expected == ringSum);
+	}
+}
@@ -0,0 +1,61 @@
+/*
+ * ThreadPoolTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "njhcpp/concurrency/concurrencyUtils.hpp"
+#include "njhcpp/concurrency/parallelAlgorithms.hpp"
+
+TEST_CASE("runVoidFunctionThreaded runs every copy at the same time", "[runVoidFunctionThreaded]") {
+	const uint32_t numThreads = 2 * std::max<uint32_t>(2, std::thread::hardware_concurrency());
+	for (uint32_t round = 0; round < 3; ++round) {
+		std::atomic<uint32_t> arrived { 0 };
+		std::atomic<uint32_t> sawEveryone { 0 };
+		std::function<void()> func = [&]() {
+			//a barrier, only passes quickly if all the copies are running at once
+			++arrived;
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+			while (arrived < numThreads && std::chrono::steady_clock::now() < deadline) {
+				std::this_thread::yield();
+			}
+			if (arrived == numThreads) {
+				++sawEveryone;
+			}
+		};
+		njh::concurrent::runVoidFunctionThreaded(func, numThreads);
+		CHECK(numThreads == sawEveryone);
+	}
+	//finished threads wait to be reused rather than exiting
+	CHECK(njh::concurrent::ThreadCache::global().idle() > 0);
+}
+
+TEST_CASE("runVoidFunctionThreaded rethrows an exception from a copy", "[runVoidFunctionThreaded]") {
+	std::atomic<uint32_t> calls { 0 };
+	std::function<void()> func = [&calls]() {
+		if (2 == ++calls) {
+			throw std::runtime_error("copy failed");
+		}
+	};
+	CHECK_THROWS_AS(njh::concurrent::runVoidFunctionThreaded(func, 4), std::runtime_error);
+	CHECK(4 == calls);
+}
+
+TEST_CASE("runVoidFunctionPooled claims all the work", "[runVoidFunctionPooled]") {
+	std::vector<uint32_t> counts(10000, 0);
+	std::atomic<size_t> next { 0 };
+	std::function<void()> func = [&]() {
+		size_t pos = next.fetch_add(1);
+		while (pos < counts.size()) {
+			++counts[pos];
+			pos = next.fetch_add(1);
+		}
+	};
+	njh::concurrent::runVoidFunctionPooled(func, 64);
+	CHECK(std::all_of(counts.begin(), counts.end(), [](uint32_t count) {return 1 == count;}));
+}
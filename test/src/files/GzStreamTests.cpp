@@ -0,0 +1,116 @@
+/*
+ * GzStreamTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <random>
+#include "njhcpp/files/fileObjects/gzstream.hpp"
+#include "njhcpp/files/fileStreamUtils.hpp" //crossPlatGetline()
+#include "njhcpp/utils/time/stopWatch.hpp"
+
+namespace {
+
+njh::bfs::path tempPath(const std::string & name) {
+	return njh::bfs::temp_directory_path() / njh::bfs::unique_path(name + "-%%%%-%%%%.txt.gz");
+}
+
+std::vector<std::string> randomLines(uint32_t numLines, uint32_t maxLen) {
+	std::mt19937 gen(1776);
+	std::uniform_int_distribution<uint32_t> lenDist(0, maxLen);
+	std::uniform_int_distribution<uint32_t> letters('A', 'Z');
+	std::vector<std::string> ret(numLines);
+	for (auto & line : ret) {
+		line.resize(lenDist(gen));
+		for (auto & c : line) {
+			c = static_cast<char>(letters(gen));
+		}
+	}
+	return ret;
+}
+
+}  // namespace
+
+TEST_CASE("gzstream round trips at any buffer size", "[gzstream]") {
+	const auto lines = randomLines(5000, 700);
+	const auto fnp = tempPath("gzstream");
+	//smaller and larger than the lines, the smallest gets raised to the minimum
+	for (const uint32_t bufferSize : { 1u, 303u, 4096u, 128u * 1024u }) {
+		for (const uint32_t readAhead : { 0u, 3u }) {
+			INFO("buffer size " << bufferSize << ", read ahead " << readAhead);
+			{
+				njh::GZSTREAM::ogzstream out(fnp, std::ios::out, bufferSize);
+				REQUIRE(out.good());
+				for (const auto & line : lines) {
+					out << line << "\n";
+				}
+			}
+			njh::GZSTREAM::igzstream in;
+			in.rdbuf()->setBufferSize(bufferSize);
+			in.rdbuf()->setReadAhead(readAhead);
+			in.open(fnp);
+			REQUIRE(in.good());
+			std::string line;
+			uint32_t lineNum = 0;
+			bool allMatch = true;
+			while (njh::files::crossPlatGetline(in, line)) {
+				allMatch = allMatch && lineNum < lines.size() && lines[lineNum] == line;
+				++lineNum;
+			}
+			CHECK(allMatch);
+			CHECK(lines.size() == lineNum);
+		}
+	}
+	njh::bfs::remove(fnp);
+}
+
+TEST_CASE("gzstream buffer size benchmark", "[.benchmark][gzstream]") {
+	//1M lines averaging 60 chars, 303 was the old fixed buffer size
+	const auto lines = randomLines(1000000, 120);
+	const auto fnp = tempPath("gzstreamBench");
+	const std::vector<uint32_t> bufferSizes { 303, 4 * 1024, 32 * 1024, njh::GZSTREAM::gzstreambuf::defaultBufferSize, 1024 * 1024 };
+	njh::stopWatch watch;
+	for (const auto bufferSize : bufferSizes) {
+		watch.setLapName("write " + std::to_string(bufferSize));
+		{
+			njh::GZSTREAM::ogzstream out(fnp, std::ios::out, bufferSize);
+			for (const auto & line : lines) {
+				out << line << "\n";
+			}
+		}
+		watch.startNewLap();
+	}
+	std::vector<char> block(1024 * 1024);
+	for (const auto bufferSize : bufferSizes) {
+		for (const uint32_t readAhead : { 0u, 2u }) {
+			const std::string name = std::to_string(bufferSize) + (readAhead > 0 ? " read ahead" : "");
+			uint64_t lineCount = 0;
+			watch.setLapName("getline " + name);
+			{
+				njh::GZSTREAM::igzstream in;
+				in.rdbuf()->setBufferSize(bufferSize);
+				in.rdbuf()->setReadAhead(readAhead);
+				in.open(fnp);
+				std::string line;
+				while (njh::files::crossPlatGetline(in, line)) {
+					++lineCount;
+				}
+			}
+			watch.startNewLap("read " + name);
+			CHECK(lines.size() == lineCount);
+			{
+				njh::GZSTREAM::igzstream in;
+				in.rdbuf()->setBufferSize(bufferSize);
+				in.rdbuf()->setReadAhead(readAhead);
+				in.open(fnp);
+				while (in.read(block.data(), block.size()) || in.gcount() > 0) {
+				}
+			}
+			watch.startNewLap();
+		}
+	}
+	watch.logLapTimes(std::cout, false, 6, false);
+	njh::bfs::remove(fnp);
+}
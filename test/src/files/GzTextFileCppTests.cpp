@@ -0,0 +1,149 @@
+/*
+ * GzTextFileCppTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <random>
+#include "njhcpp/files/fileObjects/gzTextFileCpp.hpp"
+#include "njhcpp/files/fileObjects/gzstream.hpp"
+#include "njhcpp/files/fileStreamUtils.hpp" //crossPlatGetline()
+#include "njhcpp/utils/time/stopWatch.hpp"
+
+namespace {
+
+njh::bfs::path tempPath(const std::string & name) {
+	return njh::bfs::temp_directory_path() / njh::bfs::unique_path(name + "-%%%%-%%%%.txt.gz");
+}
+
+void writeGz(const njh::bfs::path & fnp, const std::string & text) {
+	njh::GZSTREAM::ogzstream out(fnp);
+	out << text;
+}
+
+/**@brief Split the simple way, a terminator at the very end doesn't start another line
+ *
+ */
+std::vector<std::string> splitLines(const std::string & text, const std::string & terminator) {
+	std::vector<std::string> ret;
+	size_t pos = 0;
+	while (pos < text.size()) {
+		size_t termPos = text.find(terminator, pos);
+		if (std::string::npos == termPos) {
+			termPos = text.size();
+		}
+		ret.emplace_back(text.substr(pos, termPos - pos));
+		pos = std::min(text.size(), termPos + terminator.size());
+	}
+	return ret;
+}
+
+}  // namespace
+
+TEST_CASE("gzTextFileCpp splits on its terminator across chunk boundaries", "[gzTextFileCpp]") {
+	const auto fnp = tempPath("gzTextFileCpp");
+	std::mt19937 gen(1776);
+	std::uniform_int_distribution<size_t> lenDist(0, 200);
+	//heavy on the terminators' characters so they land on every boundary of the 7 byte buffer
+	static const std::string alphabet = "ab\r\nc";
+	std::uniform_int_distribution<uint32_t> pick(0, alphabet.size() - 1);
+	for (const std::string terminator : { "\n", "\r\n", "ab" }) {
+		for (uint32_t round = 0; round < 100; ++round) {
+			std::string text(lenDist(gen), 'c');
+			for (auto & c : text) {
+				c = alphabet[pick(gen)];
+			}
+			writeGz(fnp, text);
+			INFO("terminator length " << terminator.size() << ", round " << round);
+			const auto expected = splitLines(text, terminator);
+
+			std::vector<std::string> lines;
+			{
+				njh::files::gzTextFileCpp<7> in(fnp.string(), terminator);
+				std::string line;
+				while (in.getline(line)) {
+					lines.emplace_back(line);
+				}
+				CHECK(in.done());
+			}
+			CHECK(expected == lines);
+
+			std::vector<std::string> viewLines;
+			{
+				njh::files::gzTextFileCpp<7> in(fnp.string(), terminator);
+				std::string_view line;
+				//peek and done shouldn't lose anything
+				while (!in.done() && in.peek() != std::ifstream::eofbit && in.getline(line)) {
+					viewLines.emplace_back(line);
+				}
+			}
+			CHECK(expected == viewLines);
+		}
+	}
+	njh::bfs::remove(fnp);
+}
+
+TEST_CASE("gzTextFileCpp benchmark", "[.benchmark][gzTextFileCpp]") {
+	//2M lines averaging 60 chars
+	const auto fnp = tempPath("gzTextFileCppBench");
+	const uint32_t numLines = 2000000;
+	{
+		std::mt19937 gen(1776);
+		std::uniform_int_distribution<uint32_t> lenDist(0, 120);
+		std::uniform_int_distribution<uint32_t> letters('A', 'Z');
+		njh::GZSTREAM::ogzstream out(fnp);
+		std::string line;
+		for (uint32_t lineNum = 0; lineNum < numLines; ++lineNum) {
+			line.resize(lenDist(gen));
+			for (auto & c : line) {
+				c = static_cast<char>(letters(gen));
+			}
+			out << line << "\n";
+		}
+	}
+	njh::stopWatch watch;
+	uint64_t stringCount = 0;
+	watch.setLapName("gzTextFileCpp getline(std::string)");
+	{
+		njh::files::gzTextFileCpp<> in(fnp.string());
+		std::string line;
+		while (in.getline(line)) {
+			++stringCount;
+		}
+	}
+	uint64_t viewCount = 0;
+	watch.startNewLap("gzTextFileCpp getline(std::string_view)");
+	{
+		njh::files::gzTextFileCpp<> in(fnp.string());
+		std::string_view line;
+		while (in.getline(line)) {
+			++viewCount;
+		}
+	}
+	uint64_t largeBufferCount = 0;
+	watch.startNewLap("gzTextFileCpp<128 KiB> getline(std::string_view)");
+	{
+		njh::files::gzTextFileCpp<128 * 1024> in(fnp.string());
+		std::string_view line;
+		while (in.getline(line)) {
+			++largeBufferCount;
+		}
+	}
+	uint64_t getlineCount = 0;
+	watch.startNewLap("igzstream crossPlatGetline");
+	{
+		njh::GZSTREAM::igzstream in(fnp);
+		std::string line;
+		while (njh::files::crossPlatGetline(in, line)) {
+			++getlineCount;
+		}
+	}
+	watch.logLapTimes(std::cout, false, 6, true);
+	CHECK(numLines == stringCount);
+	CHECK(numLines == viewCount);
+	CHECK(numLines == largeBufferCount);
+	CHECK(numLines == getlineCount);
+	njh::bfs::remove(fnp);
+}
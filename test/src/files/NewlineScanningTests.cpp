@@ -0,0 +1,139 @@
+/*
+ * NewlineScanningTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+// The scanners are picked at compile time, so to cover every one of them
+// these tests need to be built and run three times, once with the default
+// flags (SSE2 on x86-64), once with -mavx2 and once with -mno-sse2 (scalar)
+
+#include <catch.hpp>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include "njhcpp/files/fileStreamUtils.hpp" //crossPlatGetline()
+#include "njhcpp/files/newlineScanning.hpp"
+#include "njhcpp/utils/time/stopWatch.hpp"
+
+namespace {
+
+/**@brief Random text that's heavy on line endings so \r\n pairs land on every vector and chunk boundary
+ *
+ */
+std::string randomText(std::mt19937 & gen, size_t len) {
+	static const std::string alphabet = "ab\n\r";
+	std::uniform_int_distribution<uint32_t> pick(0, alphabet.size() - 1);
+	std::string ret(len, 'a');
+	for (auto & c : ret) {
+		c = alphabet[pick(gen)];
+	}
+	return ret;
+}
+
+/**@brief The lines the way reading with crossPlatGetline sees them
+ *
+ */
+std::vector<std::string> getlineLines(const std::string & text) {
+	std::vector<std::string> ret;
+	std::istringstream in(text);
+	std::string line;
+	while (njh::files::crossPlatGetline(in, line)) {
+		ret.emplace_back(line);
+	}
+	return ret;
+}
+
+/**@brief The lines by walking the text with findLineEnding, the way MappedLineReader does
+ *
+ */
+std::vector<std::string> scannedLines(const std::string & text) {
+	std::vector<std::string> ret;
+	const char * pos = text.data();
+	const char * end = pos + text.size();
+	while (pos < end) {
+		const char * lineEnd = njh::files::findLineEnding(pos, end);
+		ret.emplace_back(pos, lineEnd);
+		pos = lineEnd;
+		if (pos < end && '\r' == *pos) {
+			++pos;
+		}
+		if (pos < end && '\n' == *pos) {
+			++pos;
+		}
+	}
+	return ret;
+}
+
+}  // namespace
+
+TEST_CASE("newline scanning agrees with crossPlatGetline", "[newlineScanning]") {
+	INFO("vector width " << njh::files::scanning::vectorWidth);
+	std::mt19937 gen(1776);
+	std::uniform_int_distribution<size_t> lenDist(0, 300);
+	for (uint32_t round = 0; round < 2000; ++round) {
+		const std::string text = randomText(gen, lenDist(gen));
+		INFO("text length " << text.size() << ", round " << round);
+		const auto expected = getlineLines(text);
+		CHECK(expected.size() == njh::files::countLines(text.data(), text.size()));
+		CHECK(expected == scannedLines(text));
+
+		//positions of the line endings the simple way
+		std::vector<size_t> expectedPositions;
+		for (size_t pos = 0; pos < text.size(); ++pos) {
+			if ('\r' == text[pos] || ('\n' == text[pos] && (0 == pos || '\r' != text[pos - 1]))) {
+				expectedPositions.emplace_back(pos);
+			}
+		}
+		std::vector<size_t> positions;
+		njh::files::lineEndingPositions(text.data(), text.size(), positions);
+		CHECK(expectedPositions == positions);
+
+		//the same text fed as random chunks
+		njh::files::LineCounter counter;
+		size_t pos = 0;
+		while (pos < text.size()) {
+			std::uniform_int_distribution<size_t> chunkDist(0, std::min<size_t>(70, text.size() - pos));
+			const size_t chunk = chunkDist(gen);
+			counter.add(text.data() + pos, chunk);
+			pos += chunk;
+		}
+		CHECK(expected.size() == counter.count());
+	}
+}
+
+TEST_CASE("newline scanning benchmark", "[.benchmark][newlineScanning]") {
+	//about the shape of the file countLines was timed on, 60 byte lines
+	std::mt19937 gen(1776);
+	std::uniform_int_distribution<uint32_t> letters('A', 'Z');
+	std::string text;
+	const uint32_t numLines = 2000000;
+	text.reserve(numLines * 61);
+	for (uint32_t line = 0; line < numLines; ++line) {
+		for (uint32_t pos = 0; pos < 60; ++pos) {
+			text.push_back(static_cast<char>(letters(gen)));
+		}
+		text.push_back('\n');
+	}
+	njh::stopWatch watch;
+	watch.setLapName("crossPlatGetline");
+	uint64_t getlineCount = 0;
+	{
+		std::istringstream in(text);
+		std::string line;
+		while (njh::files::crossPlatGetline(in, line)) {
+			++getlineCount;
+		}
+	}
+	watch.startNewLap("countLines, vector width " + std::to_string(njh::files::scanning::vectorWidth));
+	const uint64_t scanCount = njh::files::countLines(text.data(), text.size());
+	watch.startNewLap("lineEndingPositions");
+	std::vector<size_t> positions;
+	positions.reserve(numLines);
+	njh::files::lineEndingPositions(text.data(), text.size(), positions);
+	watch.logLapTimes(std::cout, false, 6, true);
+	CHECK(numLines == getlineCount);
+	CHECK(numLines == scanCount);
+	CHECK(numLines == positions.size());
+}
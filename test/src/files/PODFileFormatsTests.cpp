@@ -0,0 +1,227 @@
+/*
+ * PODFileFormatsTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <numeric>
+#include "njhcpp/files.h"
+
+namespace {
+
+njh::files::bfs::path tempPath(const std::string & name) {
+	return njh::files::bfs::temp_directory_path() / njh::files::bfs::unique_path(name + "-%%%%-%%%%.bin");
+}
+
+std::vector<double> testValues(size_t num) {
+	std::vector<double> ret(num);
+	for (size_t pos = 0; pos < num; ++pos) {
+		ret[pos] = pos * 1.5 - 7;
+	}
+	return ret;
+}
+
+/**@brief Append vals in pieces of varying size, none of them lining up with the buffer or the blocks
+ *
+ */
+void appendUnevenly(njh::files::PODVectorWriter<double> & writer, const std::vector<double> & vals) {
+	size_t pos = 0;
+	size_t piece = 1;
+	while (pos < vals.size()) {
+		const size_t num = std::min(piece, vals.size() - pos);
+		if (1 == num) {
+			writer.append(vals[pos]);
+		} else {
+			writer.append(vals.data() + pos, num);
+		}
+		pos += num;
+		piece = (piece * 7 + 3) % 97;
+	}
+}
+
+void flipByte(const njh::files::bfs::path & fnp, uint64_t pos) {
+	std::fstream file(fnp.string(), std::ios::binary | std::ios::in | std::ios::out);
+	file.seekg(pos);
+	char c = 0;
+	file.get(c);
+	file.seekp(pos);
+	file.put(static_cast<char>(c ^ 0x40));
+}
+
+njh::files::PODWriterOptions smallBufferOptions() {
+	njh::files::PODWriterOptions options;
+	//smaller than some of the appends so both the buffered and the direct paths are used
+	options.bufferBytes_ = 50 * sizeof(double);
+	return options;
+}
+
+}  // namespace
+
+TEST_CASE("PODVectorWriter round trips every format", "[PODVectorWriter]") {
+	const auto vals = testValues(1000);
+	const auto fnp = tempPath("podWriter");
+	SECTION("raw") {
+		njh::files::PODVectorWriter<double> writer(fnp, smallBufferOptions(), vals.size());
+		appendUnevenly(writer, vals);
+		CHECK(vals.size() == writer.size());
+		writer.close();
+		CHECK(vals.size() * sizeof(double) == njh::files::bfs::file_size(fnp));
+		CHECK_FALSE(njh::files::PODFileHeader::fileHasHeader(fnp));
+		CHECK(vals == njh::files::readPODvector<double>(fnp));
+	}
+	SECTION("raw without knowing the size up front") {
+		njh::files::PODVectorWriter<double> writer(fnp, smallBufferOptions());
+		appendUnevenly(writer, vals);
+		writer.close();
+		CHECK(vals == njh::files::readPODvector<double>(fnp));
+	}
+	SECTION("raw with more elements expected than appended") {
+		njh::files::PODVectorWriter<double> writer(fnp, smallBufferOptions(), 5000);
+		appendUnevenly(writer, vals);
+		writer.close();
+		//the preallocation is cut back
+		CHECK(vals.size() * sizeof(double) == njh::files::bfs::file_size(fnp));
+		CHECK(vals == njh::files::readPODvector<double>(fnp));
+	}
+	SECTION("container") {
+		auto options = smallBufferOptions();
+		options.container_ = true;
+		njh::files::PODVectorWriter<double> writer(fnp, options, vals.size());
+		appendUnevenly(writer, vals);
+		writer.close();
+		auto header = njh::files::PODFileHeader::read(fnp);
+		CHECK(header.hasChecksum());
+		CHECK_FALSE(header.isChunked());
+		CHECK(vals.size() == header.numElements_);
+		CHECK(njh::files::PODFileHeader::headerSize_ == header.dataOffset_);
+		CHECK(vals == njh::files::readPODvectorContainer<double>(fnp));
+		//the plain reader finds the header too
+		CHECK(vals == njh::files::readPODvector<double>(fnp));
+	}
+	SECTION("compressed") {
+		auto options = smallBufferOptions();
+		options.compress_ = true;
+		options.elementsPerBlock_ = 64;
+		options.numThreads_ = 3;
+		njh::files::PODVectorWriter<double> writer(fnp, options, vals.size());
+		appendUnevenly(writer, vals);
+		writer.close();
+		njh::files::PODChunkedReader<double> reader(fnp);
+		CHECK(vals.size() == reader.size());
+		CHECK(16 == reader.numBlocks());
+		CHECK(1000 - 15 * 64 == reader.blockSize(15));
+		CHECK(vals == reader.readAll(2));
+		CHECK(vals == njh::files::readPODvectorContainer<double>(fnp));
+	}
+	SECTION("compressed and closed short of the expected number of elements") {
+		auto options = smallBufferOptions();
+		options.compress_ = true;
+		options.elementsPerBlock_ = 64;
+		njh::files::PODVectorWriter<double> writer(fnp, options, 5000);
+		appendUnevenly(writer, vals);
+		writer.close();
+		njh::files::PODChunkedReader<double> reader(fnp);
+		CHECK(vals.size() == reader.size());
+		CHECK(16 == reader.numBlocks());
+		CHECK(vals == reader.readAll());
+	}
+	SECTION("compressed refuses more than expected") {
+		auto options = smallBufferOptions();
+		options.compress_ = true;
+		njh::files::PODVectorWriter<double> writer(fnp, options, 10);
+		writer.append(vals.data(), 10);
+		CHECK_THROWS_AS(writer.append(vals[10]), std::runtime_error);
+		CHECK_THROWS_AS(njh::files::PODVectorWriter<double>(tempPath("podWriterNoSize"), options), std::runtime_error);
+	}
+	njh::files::bfs::remove(fnp);
+}
+
+TEST_CASE("PODMatrixWriter round trips dense matrices", "[PODMatrixWriter]") {
+	std::vector<std::vector<double>> mat;
+	for (uint32_t row = 0; row < 37; ++row) {
+		mat.emplace_back(testValues(11));
+		mat.back()[0] = row;
+	}
+	const auto fnp = tempPath("podMatrixWriter");
+	for (bool compress : { false, true }) {
+		auto options = smallBufferOptions();
+		options.container_ = true;
+		options.compress_ = compress;
+		options.elementsPerBlock_ = 30;
+		{
+			njh::files::PODMatrixWriter<double> writer(fnp, 11, options, mat.size());
+			for (const auto & row : mat) {
+				writer.addRow(row);
+			}
+			CHECK_THROWS_AS(writer.addRow(std::vector<double>(3)), std::runtime_error);
+		}
+		INFO("compressed " << compress);
+		auto header = njh::files::PODFileHeader::read(fnp);
+		CHECK(37 == header.nRow_);
+		CHECK(11 == header.nCol_);
+		CHECK(mat == njh::files::readPODmatrixContainer<double>(fnp));
+	}
+	njh::files::bfs::remove(fnp);
+}
+
+TEST_CASE("PODChunkedReader::getRange reads across block boundaries", "[PODChunkedReader]") {
+	const auto vals = testValues(1000);
+	const auto fnp = tempPath("podChunkedRange");
+	njh::files::writePODvectorChunked(fnp, vals, 64, 2);
+	njh::files::PODChunkedReader<double> reader(fnp);
+	auto expected = [&vals](size_t start, size_t num) {
+		return std::vector<double>(vals.begin() + start, vals.begin() + std::min(vals.size(), start + num));
+	};
+	for (const auto & range : std::vector<std::pair<size_t, size_t>> {
+			{ 0, 1000 }, { 0, 1 }, { 60, 10 }, { 63, 2 }, { 64, 64 }, { 64, 65 }, { 100, 500 }, { 959, 41 }, { 990, 100 } }) {
+		INFO("start " << range.first << " num " << range.second);
+		CHECK(expected(range.first, range.second) == reader.getRange(range.first, range.second));
+	}
+	CHECK(reader.getRange(1000, 5).empty());
+	CHECK(vals[640] == reader.at(640));
+	CHECK_THROWS_AS(reader.at(1000), std::out_of_range);
+	njh::files::bfs::remove(fnp);
+}
+
+TEST_CASE("POD files that have been damaged are rejected", "[PODFileHeader]") {
+	const auto vals = testValues(1000);
+	const auto fnp = tempPath("podDamaged");
+	SECTION("container cut short") {
+		njh::files::writePODvectorContainer(fnp, vals);
+		njh::files::bfs::resize_file(fnp, njh::files::bfs::file_size(fnp) - sizeof(double));
+		CHECK_THROWS_AS(njh::files::readPODvectorContainer<double>(fnp), std::runtime_error);
+	}
+	SECTION("container data changed") {
+		njh::files::writePODvectorContainer(fnp, vals);
+		flipByte(fnp, njh::files::PODFileHeader::headerSize_ + 500);
+		CHECK_THROWS_AS(njh::files::readPODvectorContainer<double>(fnp), std::runtime_error);
+		CHECK_THROWS_AS(njh::files::PODVectorView<double>::openContainer(fnp, false, true), std::runtime_error);
+	}
+	SECTION("container header changed") {
+		njh::files::writePODvectorContainer(fnp, vals);
+		flipByte(fnp, 40);
+		CHECK_THROWS_AS(njh::files::PODFileHeader::read(fnp), std::runtime_error);
+	}
+	SECTION("chunked cut short") {
+		njh::files::writePODvectorChunked(fnp, vals, 64);
+		njh::files::bfs::resize_file(fnp, njh::files::bfs::file_size(fnp) - 10);
+		CHECK_THROWS_AS(njh::files::PODChunkedReader<double>(fnp), std::runtime_error);
+	}
+	SECTION("chunked data changed") {
+		njh::files::writePODvectorChunked(fnp, vals, 64);
+		flipByte(fnp, njh::files::bfs::file_size(fnp) - 20);
+		njh::files::PODChunkedReader<double> reader(fnp);
+		//only the damaged last block fails
+		CHECK(std::vector<double>(vals.begin(), vals.begin() + 64) == reader.getRange(0, 64));
+		CHECK_THROWS_AS(reader.readAll(), std::runtime_error);
+		CHECK_THROWS_AS(reader.at(999), std::runtime_error);
+	}
+	SECTION("raw cut short mid element") {
+		njh::files::writePODvector(fnp, vals);
+		njh::files::bfs::resize_file(fnp, njh::files::bfs::file_size(fnp) - 3);
+		CHECK_THROWS(njh::files::readPODvector<double>(fnp));
+	}
+	njh::files::bfs::remove(fnp);
+}
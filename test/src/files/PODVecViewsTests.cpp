@@ -0,0 +1,43 @@
+/*
+ * PODVecViewsTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <numeric>
+#include "njhcpp/files.h"
+
+namespace {
+
+njh::files::bfs::path tempPath(const std::string & name) {
+	return njh::files::bfs::temp_directory_path() / njh::files::bfs::unique_path(name + "-%%%%-%%%%.bin");
+}
+
+}  // namespace
+
+TEST_CASE("PODVectorView maps raw and container files", "[PODVectorView]") {
+	std::vector<float> vals(1000);
+	std::iota(vals.begin(), vals.end(), 0.5f);
+	SECTION("raw") {
+		auto fnp = tempPath("podViewRaw");
+		njh::files::writePODvector(fnp, vals);
+		njh::files::PODVectorView<float> view(fnp);
+		REQUIRE(vals.size() == view.size());
+		CHECK(vals == std::vector<float>(view.begin(), view.end()));
+		njh::files::bfs::remove(fnp);
+	}
+	SECTION("container") {
+		auto fnp = tempPath("podViewContainer");
+		njh::files::writePODvectorContainer(fnp, vals);
+		auto view = njh::files::PODVectorView<float>::openContainer(fnp, false, true);
+		REQUIRE(vals.size() == view.size());
+		CHECK(vals == std::vector<float>(view.begin(), view.end()));
+		//the raw constructors would read the header as data
+		CHECK_THROWS_AS(njh::files::PODVectorView<float>(fnp), std::runtime_error);
+		CHECK_THROWS_AS(njh::files::PODMatrixView<float>(fnp, 10), std::runtime_error);
+		CHECK_THROWS_AS(njh::files::PODDistMatrixView<float>(fnp, 10), std::runtime_error);
+		njh::files::bfs::remove(fnp);
+	}
+}
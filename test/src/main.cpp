@@ -0,0 +1,9 @@
+/*
+ * main.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
@@ -0,0 +1,173 @@
+/*
+ * ChecksumEngineTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <ctime>
+#include "njhcpp/md5/ChecksumEngine.hpp"
+
+namespace {
+
+njh::files::bfs::path tempPath(const std::string & name, const std::string & ext) {
+	return njh::files::bfs::temp_directory_path() / njh::files::bfs::unique_path(name + "-%%%%-%%%%" + ext);
+}
+
+std::string testBytes(size_t len) {
+	std::string ret(len, '\0');
+	for (size_t pos = 0; pos < len; ++pos) {
+		ret[pos] = static_cast<char>((pos * 31 + 7) % 251);
+	}
+	return ret;
+}
+
+/**@brief Write a file and date it far enough back that the engine will cache it
+ *
+ */
+void writeOldFile(const njh::files::bfs::path & fnp, const std::string & content, std::time_t age) {
+	{
+		std::ofstream out(fnp.string(), std::ios::binary);
+		out << content;
+	}
+	njh::files::bfs::last_write_time(fnp, std::time(nullptr) - age);
+}
+
+}  // namespace
+
+TEST_CASE("XXHash64 matches the reference digests", "[XXHash64]") {
+	auto hash = [](const std::string & input, uint64_t seed) {
+		njh::XXHash64 xxh(seed);
+		xxh.update(input.data(), input.size());
+		return xxh.hexdigest();
+	};
+	CHECK("ef46db3751d8e999" == hash("", 0));
+	CHECK("d24ec4f1a98c6e5b" == hash("a", 0));
+	CHECK("44bc2cf5ad770999" == hash("abc", 0));
+	//longer than a 32 byte stripe
+	CHECK("fbcea83c8a378bf1" == hash("Nobody inspects the spammish repetition", 0));
+	//the reference implementation's sanity checks, which cover a seed and inputs past several stripes
+	const uint32_t prime = 2654435761U;
+	CHECK("ac75fda2929b17ef" == hash("", prime));
+	std::string sanity(101, '\0');
+	uint64_t byteGen = prime;
+	for (auto & c : sanity) {
+		c = static_cast<char>(byteGen >> 24);
+		byteGen *= byteGen;
+	}
+	CHECK("4fce394cc88952d8" == hash(sanity.substr(0, 1), 0));
+	CHECK("739840cb819fa723" == hash(sanity.substr(0, 1), prime));
+	CHECK("cffa8db881bc3a3d" == hash(sanity.substr(0, 14), 0));
+	CHECK("5b9611585efcc9cb" == hash(sanity.substr(0, 14), prime));
+	CHECK("0eab543384f878ad" == hash(sanity, 0));
+	CHECK("caa65939306f1e21" == hash(sanity, prime));
+}
+
+TEST_CASE("XXHash64 gives the same digest however the input is split", "[XXHash64]") {
+	const auto input = testBytes(10000);
+	njh::XXHash64 whole;
+	whole.update(input.data(), input.size());
+	for (size_t pieceSize : { 1, 7, 13, 31, 32, 33, 4096 }) {
+		njh::XXHash64 pieces;
+		for (size_t pos = 0; pos < input.size(); pos += pieceSize) {
+			pieces.update(input.data() + pos, std::min(pieceSize, input.size() - pos));
+		}
+		INFO("piece size " << pieceSize);
+		CHECK(whole.digest() == pieces.digest());
+	}
+	//the digest can be taken part way through and more added after
+	njh::XXHash64 partial;
+	partial.update(input.data(), 100);
+	partial.digest();
+	partial.update(input.data() + 100, input.size() - 100);
+	CHECK(whole.digest() == partial.digest());
+}
+
+TEST_CASE("ChecksumEngine hashes files with either algorithm", "[ChecksumEngine]") {
+	const auto content = testBytes(100000);
+	std::vector<njh::files::bfs::path> fnps;
+	for (uint32_t num = 0; num < 5; ++num) {
+		fnps.emplace_back(tempPath("checksumEngine", ".bin"));
+		writeOldFile(fnps.back(), content.substr(0, 20000 * num), 0);
+	}
+	njh::XXHash64 xxh;
+	xxh.update(content.data(), 80000);
+	njh::ChecksumEngine xxhEngine(njh::ChecksumEngine::Algorithm::XXH64, 3);
+	auto results = xxhEngine.hashFiles(fnps);
+	REQUIRE(fnps.size() == results.size());
+	CHECK(fnps[4] == results[4].file_);
+	CHECK(80000 == results[4].size_);
+	CHECK(xxh.hexdigest() == results[4].digest_);
+	CHECK("ef46db3751d8e999" == results[0].digest_);
+
+	njh::ChecksumEngine md5Engine(njh::ChecksumEngine::Algorithm::MD5, 3);
+	auto md5Results = md5Engine.hashFiles(fnps);
+	CHECK(njh::md5(content.substr(0, 80000)) == md5Results[4].digest_);
+	CHECK("d41d8cd98f00b204e9800998ecf8427e" == md5Results[0].digest_);
+	for (const auto & fnp : fnps) {
+		njh::files::bfs::remove(fnp);
+	}
+}
+
+TEST_CASE("ChecksumEngine only trusts its cache while a file is unchanged", "[ChecksumEngine]") {
+	const auto fnp = tempPath("checksumCached", ".bin");
+	const auto cacheFnp = tempPath("checksumCache", ".tsv");
+	const auto content = testBytes(5000);
+	writeOldFile(fnp, content, 3600);
+	std::string digest;
+	{
+		njh::ChecksumEngine engine(njh::ChecksumEngine::Algorithm::XXH64, 1, cacheFnp);
+		auto result = engine.hashFile(fnp);
+		CHECK_FALSE(result.fromCache_);
+		digest = result.digest_;
+	}
+	SECTION("hit") {
+		njh::ChecksumEngine engine(njh::ChecksumEngine::Algorithm::XXH64, 1, cacheFnp);
+		CHECK(1 == engine.cacheSize());
+		auto result = engine.hashFile(fnp);
+		CHECK(result.fromCache_);
+		CHECK(digest == result.digest_);
+	}
+	SECTION("the other algorithm isn't a hit") {
+		njh::ChecksumEngine engine(njh::ChecksumEngine::Algorithm::MD5, 1, cacheFnp);
+		auto result = engine.hashFile(fnp);
+		CHECK_FALSE(result.fromCache_);
+		CHECK(njh::md5(content) == result.digest_);
+	}
+	SECTION("miss after the modification time changes") {
+		//same size and contents, only the time differs
+		njh::files::bfs::last_write_time(fnp, std::time(nullptr) - 7200);
+		njh::ChecksumEngine engine(njh::ChecksumEngine::Algorithm::XXH64, 1, cacheFnp);
+		auto result = engine.hashFile(fnp);
+		CHECK_FALSE(result.fromCache_);
+		CHECK(digest == result.digest_);
+	}
+	SECTION("miss after the size changes") {
+		const auto modTime = njh::files::bfs::last_write_time(fnp);
+		{
+			std::ofstream out(fnp.string(), std::ios::binary | std::ios::app);
+			out << "more";
+		}
+		//put the time back so only the size gives the change away
+		njh::files::bfs::last_write_time(fnp, modTime);
+		njh::ChecksumEngine engine(njh::ChecksumEngine::Algorithm::XXH64, 1, cacheFnp);
+		auto result = engine.hashFile(fnp);
+		CHECK_FALSE(result.fromCache_);
+		njh::XXHash64 xxh;
+		const auto changed = content + "more";
+		xxh.update(changed.data(), changed.size());
+		CHECK(xxh.hexdigest() == result.digest_);
+	}
+	SECTION("a recently modified file isn't cached") {
+		writeOldFile(fnp, content, 0);
+		{
+			njh::ChecksumEngine engine(njh::ChecksumEngine::Algorithm::XXH64, 1, cacheFnp);
+			CHECK_FALSE(engine.hashFile(fnp).fromCache_);
+		}
+		njh::ChecksumEngine engine(njh::ChecksumEngine::Algorithm::XXH64, 1, cacheFnp);
+		CHECK_FALSE(engine.hashFile(fnp).fromCache_);
+	}
+	njh::files::bfs::remove(fnp);
+	njh::files::bfs::remove(cacheFnp);
+}
@@ -0,0 +1,110 @@
+/*
+ * BatchJournalTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include <ctime>
+#include "njhcpp/progutils/BatchJournal.hpp"
+
+namespace {
+
+njh::files::bfs::path tempPath(const std::string & name, const std::string & ext) {
+	return njh::files::bfs::temp_directory_path() / njh::files::bfs::unique_path(name + "-%%%%-%%%%" + ext);
+}
+
+void writeFile(const njh::files::bfs::path & fnp, const std::string & content, std::time_t age = 0) {
+	{
+		std::ofstream out(fnp.string(), std::ios::binary);
+		out << content;
+	}
+	njh::files::bfs::last_write_time(fnp, std::time(nullptr) - age);
+}
+
+njh::progutils::BatchJournal::Entry makeEntry(const std::string & cmd, bool success,
+		const std::vector<njh::files::bfs::path> & outputs = std::vector<njh::files::bfs::path>{}) {
+	njh::progutils::BatchJournal::Entry entry;
+	entry.cmd_ = cmd;
+	entry.success_ = success;
+	entry.returnCode_ = success ? 0 : 1;
+	entry.startTime_ = njh::progutils::BatchJournal::now();
+	entry.time_ = 0.5;
+	entry.outputChecksums_ = njh::progutils::BatchJournal::checksumOutputs(outputs);
+	return entry;
+}
+
+}  // namespace
+
+TEST_CASE("BatchJournal resumes from what was recorded", "[BatchJournal]") {
+	using njh::progutils::BatchJournal;
+	const auto journalFnp = tempPath("batchJournal", ".tsv");
+	const auto input = tempPath("batchInput", ".txt");
+	const auto output = tempPath("batchOutput", ".txt");
+	//written well before the commands start
+	writeFile(input, "input", 3600);
+	writeFile(output, "output");
+	{
+		BatchJournal journal(journalFnp);
+		journal.record(makeEntry("run a", true, { output }));
+		journal.record(makeEntry("run b", false));
+		journal.record(makeEntry("run c", false));
+		//the last entry for a command wins
+		journal.record(makeEntry("run c", true));
+	}
+	SECTION("reloaded entries") {
+		BatchJournal journal(journalFnp);
+		CHECK(journal.isDone("run a", { input }, { output }));
+		CHECK_FALSE(journal.isDone("run b", { input }));
+		CHECK(journal.isDone("run c", { input }));
+		CHECK_FALSE(journal.isDone("never run", { input }));
+	}
+	SECTION("a changed input") {
+		writeFile(input, "changed");
+		BatchJournal journal(journalFnp);
+		CHECK_FALSE(journal.isDone("run a", { input }, { output }));
+		CHECK_FALSE(journal.isDone("run c", { input }));
+	}
+	SECTION("a missing input") {
+		njh::files::bfs::remove(input);
+		BatchJournal journal(journalFnp);
+		CHECK_FALSE(journal.isDone("run c", { input }));
+	}
+	SECTION("a changed output") {
+		//same size, only the md5 gives it away
+		writeFile(output, "OUTPUT");
+		BatchJournal journal(journalFnp);
+		CHECK_FALSE(journal.isDone("run a", { input }, { output }));
+	}
+	SECTION("a deleted output") {
+		njh::files::bfs::remove(output);
+		BatchJournal journal(journalFnp);
+		CHECK_FALSE(journal.isDone("run a", { input }, { output }));
+	}
+	SECTION("different outputs declared than were recorded") {
+		BatchJournal journal(journalFnp);
+		CHECK_FALSE(journal.isDone("run a", { input }));
+		CHECK_FALSE(journal.isDone("run c", { input }, { output }));
+	}
+	SECTION("a record cut off by a crash") {
+		{
+			std::ofstream out(journalFnp.string(), std::ios::app);
+			out << BatchJournal::hashCmd("run d") << "\tdone\t0";
+		}
+		{
+			BatchJournal journal(journalFnp);
+			CHECK_FALSE(journal.isDone("run d", { input }));
+			journal.record(makeEntry("run e", true));
+		}
+		BatchJournal journal(journalFnp);
+		CHECK_FALSE(journal.isDone("run d", { input }));
+		CHECK(journal.isDone("run e", { input }));
+		CHECK(journal.isDone("run a", { input }, { output }));
+	}
+	for (const auto & fnp : { journalFnp, input, output }) {
+		if (njh::files::bfs::exists(fnp)) {
+			njh::files::bfs::remove(fnp);
+		}
+	}
+}
@@ -0,0 +1,95 @@
+/*
+ * ProcessSchedulerTests.cpp
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: nick
+ */
+
+#include <catch.hpp>
+#include "njhcpp/system/ProcessScheduler.hpp"
+
+TEST_CASE("ProcessScheduler returns results in input order with output and exit codes", "[ProcessScheduler]") {
+	njh::sys::ProcessSchedulerPars pars;
+	pars.maxConcurrent_ = 3;
+	njh::sys::ProcessScheduler scheduler(pars);
+	std::vector<size_t> finishOrder;
+	//the first command finishes last
+	auto results = scheduler.run( { "sleep 0.3; echo first", "echo second", "echo err >&2; exit 3", "false", "true" },
+			[&finishOrder](size_t index, const njh::sys::RunOutput &) {
+				finishOrder.emplace_back(index);
+			});
+	REQUIRE(5 == results.size());
+	CHECK(results[0].success_);
+	CHECK("first" == results[0].stdOut_);
+	CHECK("echo second" == results[1].cmd_);
+	CHECK("second" == results[1].stdOut_);
+	CHECK_FALSE(results[2].success_);
+	CHECK(3 == WEXITSTATUS(results[2].returnCode_));
+	CHECK("err" == results[2].stdErr_);
+	CHECK_FALSE(results[3].success_);
+	CHECK(1 == WEXITSTATUS(results[3].returnCode_));
+	CHECK(results[4].success_);
+	CHECK(0 == results[4].returnCode_);
+	REQUIRE(5 == finishOrder.size());
+	CHECK(0 == finishOrder.back());
+}
+
+TEST_CASE("ProcessScheduler runs at most maxConcurrent_ at once", "[ProcessScheduler]") {
+	njh::sys::ProcessSchedulerPars pars;
+	pars.maxConcurrent_ = 2;
+	njh::sys::ProcessScheduler scheduler(pars);
+	auto start = std::chrono::steady_clock::now();
+	auto results = scheduler.run(std::vector<std::string>(4, "sleep 0.3"));
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	for (const auto & result : results) {
+		CHECK(result.success_);
+	}
+	//two rounds of two
+	CHECK(elapsed >= 0.55);
+	CHECK(elapsed < 3);
+}
+
+TEST_CASE("ProcessScheduler kills commands over the timeout", "[ProcessScheduler]") {
+	njh::sys::ProcessSchedulerPars pars;
+	pars.maxConcurrent_ = 2;
+	pars.timeout_ = 0.3;
+	njh::sys::ProcessScheduler scheduler(pars);
+	auto start = std::chrono::steady_clock::now();
+	//the sleep is a child of the shell so this also checks the whole process group is killed, otherwise the pipe stays open
+	auto results = scheduler.run( { "sleep 30; echo never", "echo quick" });
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	CHECK(elapsed < 5);
+	CHECK_FALSE(results[0].success_);
+	CHECK(results[0].stdOut_.empty());
+	CHECK(std::string::npos != results[0].stdErr_.find("timeout"));
+	CHECK(results[1].success_);
+	CHECK("quick" == results[1].stdOut_);
+}
+
+TEST_CASE("ProcessScheduler fail fast stops the rest", "[ProcessScheduler]") {
+	njh::sys::ProcessSchedulerPars pars;
+	pars.maxConcurrent_ = 2;
+	pars.failFast_ = true;
+	njh::sys::ProcessScheduler scheduler(pars);
+	auto start = std::chrono::steady_clock::now();
+	auto results = scheduler.run( { "sleep 30", "sleep 0.1; false", "echo not started" });
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	CHECK(elapsed < 5);
+	CHECK_FALSE(results[0].success_);
+	CHECK(std::string::npos != results[0].stdErr_.find("another command failed"));
+	CHECK_FALSE(results[1].success_);
+	CHECK_FALSE(results[2].success_);
+	CHECK(-1 == results[2].returnCode_);
+	CHECK(results[2].stdOut_.empty());
+	CHECK(std::string::npos != results[2].stdErr_.find("not run"));
+}
+
+TEST_CASE("ProcessScheduler without fail fast runs everything", "[ProcessScheduler]") {
+	njh::sys::ProcessSchedulerPars pars;
+	pars.maxConcurrent_ = 1;
+	njh::sys::ProcessScheduler scheduler(pars);
+	auto results = scheduler.run( { "false", "echo after" });
+	CHECK_FALSE(results[0].success_);
+	CHECK(results[1].success_);
+	CHECK("after" == results[1].stdOut_);
+}